@@ -59,7 +59,41 @@ enum type_rmcios
 
     /// Variable type parameters
     /// Parameters are combo_rmcios structures
-    combo_rmcios = 6
+    combo_rmcios = 6,
+
+    /// Parameters as 64-bit signed integers (long long).
+    int64_rmcios = 7,
+
+    /// Parameters as double precision floats.
+    double_rmcios = 8,
+
+    /// Strided views to numeric arrays.
+    /// Parameters are array_rmcios structures.
+    /// num_params is the total number of elements in the views.
+    array_rmcios = 9,
+
+    /// Scatter-gather binary parameters.
+    /// Parameters are gather_rmcios structures. Each parameter is one
+    /// binary payload made of a chain of buffer_rmcios segments.
+    gather_rmcios = 10,
+
+    /// Short strings stored inline.
+    /// Parameters are inline_rmcios structures.
+    inline_rmcios = 11,
+
+    /// Binary parameters with data ownership offered to the channel.
+    /// Parameters are buffer_rmcios structures with data allocated from
+    /// the context mem channel. Channel may keep the data with take_buffer.
+    /// Otherwise handled as binary_rmcios.
+    moved_rmcios = 12,
+
+    /// Return buffer accepting borrowed data.
+    /// Return value is buffer_rmcios structure. Used only as returnv type.
+    /// Returning channel may point data to its own storage instead of
+    /// copying (see lend_buffer). Borrowed data is read only and stays 
+    /// valid until the next write or setup call to the returning channel.
+    /// Channels that do not lend data copy it as to buffer_rmcios return.
+    borrowed_rmcios = 13
 };
 
 /// @brief channel functions 
@@ -95,6 +129,66 @@ struct buffer_rmcios
     /// Number of accessible metabytes after the buffer
     /// eg. NULL -terminated string buffer contain 1 trailing metabyte (0)
     unsigned short int trailing_size;
+
+    /// Buffer flags. Combination of buffer_flags_rmcios values.
+    unsigned short int flags;
+};
+
+/// @brief Flags of buffer_rmcios structure
+enum buffer_flags_rmcios
+{
+    /// Data is allocated with allocate_storage from the context mem channel.
+    /// Ownership is offered only with moved_rmcios parameters. On other 
+    /// parameter types the flag is ignored.
+    /// Receiving channel may keep the data by clearing the flag.
+    /// Data that is still flagged after the call is freed by the caller
+    /// with free_storage.
+    buffer_owned_rmcios = 1,
+
+    /// Return buffer is read in chunks.
+    /// returnv->next is int64_rmcios combo holding the continuation cursor.
+    /// Cursor is 0 on first read. Channel fills at most size bytes from the
+    /// cursor position, sets the cursor for the next chunk and clears 
+    /// the flag. Cursor is set to 0 after the last chunk.
+    buffer_chunked_rmcios = 4
+};
+
+/// @brief Structure for strided array views
+/// Describes eg. single column of interleaved sample frame without copy.
+struct array_rmcios
+{
+    /// Type of array elements (int, float, int64 or double)
+    enum type_rmcios type;
+    /// Pointer to first element
+    void *data;
+    /// Number of elements in the view
+    int count;
+    /// Distance between consecutive elements in bytes.
+    /// 0 for contiguous elements.
+    int stride;
+};
+
+/// @brief Structure for scatter-gather buffer chains
+/// Payload is the concatenation of the segments.
+struct gather_rmcios
+{
+    /// Array of segments
+    struct buffer_rmcios *segments;
+    /// Number of segments
+    int count;
+};
+
+/// Maximum length of data in inline_rmcios structure
+#define INLINE_BUFFER_SIZE 23
+
+/// @brief Structure for short strings stored inline
+/// Data is NULL-terminated when length < INLINE_BUFFER_SIZE.
+struct inline_rmcios
+{
+    /// Length of data
+    unsigned char length;
+    /// Inline data
+    char data[INLINE_BUFFER_SIZE];
 };
 
 struct combo_rmcios;
@@ -110,8 +204,18 @@ union param_rmcios
     int *iv;
     /// paramtype==float_rmcios
     float *fv;
+    /// paramtype==int64_rmcios
+    long long *lv;
+    /// paramtype==double_rmcios
+    double *dv;
     /// paramtype==buffer_rmcios
     struct buffer_rmcios *bv;
+    /// paramtype==array_rmcios
+    struct array_rmcios *av;
+    /// paramtype==gather_rmcios
+    struct gather_rmcios *gv;
+    /// paramtype==inline_rmcios
+    struct inline_rmcios *inv;
     /// paramtype==combo_rmcios
     struct combo_rmcios *cv;
     /// paramtype==channel_rmcios
@@ -154,6 +258,10 @@ typedef void (*class_rmcios) (void *data,
                               struct combo_rmcios * returnv,
                               int num_params, union param_rmcios param);
 
+/// Context version with the clock channel.
+/// Contexts of older versions end at the convert channel.
+#define CONTEXT_VERSION_CLOCK_RMCIOS 2
+
 /// @brief context structure for delivering api interface to modules
 /// @param version
 struct context_rmcios
@@ -191,6 +299,11 @@ struct context_rmcios
     int create;
     /// Channel For converting parameters
     int convert;
+    /// Channel for reading current time. 0 when context has no clock.
+    /// Read with binary_rmcios return gives time in nanoseconds
+    /// as long long. Exists from CONTEXT_VERSION_CLOCK_RMCIOS. 
+    /// Read with context_clock.
+    int clock;
 };
 
 #endif
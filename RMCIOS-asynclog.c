@@ -0,0 +1,766 @@
+/*
+RMCIOS - Reactive Multipurpose Control Input Output System
+Copyright (c) 2018 Frans Korhonen
+
+RMCIOS was originally developed at Institute for Atmospheric 
+and Earth System Research / Physics, Faculty of Science, 
+University of Helsinki, Finland
+
+Assistance, experience and feedback from following persons have been 
+critical for development of RMCIOS: Erkki Siivola, Juha Kangasluoma, 
+Lauri Ahonen, Ella Häkkinen, Pasi Aalto, Joonas Enroth, Runlong Cai, 
+Markku Kulmala and Tuukka Petäjä.
+
+This file is part of RMCIOS. This notice was encoded using utf-8.
+
+RMCIOS is free software: you can redistribute this file and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RMCIOS is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public Licenses
+along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RMCIOS-asynclog.h"
+#include "RMCIOS-functions.h"
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L \
+    && !defined(__STDC_NO_ATOMICS__)
+#define CLAIM_RING(ring) \
+    atomic_compare_exchange_strong (&(ring)->claimed, &(unsigned int){0}, 1)
+#define THREAD_LOCAL _Thread_local
+#else
+#define CLAIM_RING(ring) \
+    __sync_bool_compare_and_swap (&(ring)->claimed, 0, 1)
+#define THREAD_LOCAL __thread
+#endif
+
+enum ring_state
+{
+    ring_free = 0,
+    ring_claiming,
+    ring_ready,
+    // Freed by the drainer when empty
+    ring_released
+};
+
+// Argument types in message payload
+enum argument_type
+{
+    argument_none = 0,
+    argument_int,
+    argument_double,
+    argument_string,
+    argument_pointer
+};
+
+#ifndef ASYNCLOG_NO_THREAD
+// Ring of the calling thread in the last used log
+static THREAD_LOCAL struct asynclog_rmcios *cached_log;
+static THREAD_LOCAL struct asynclog_ring_rmcios *cached_ring;
+#endif
+
+// Ring of the calling thread. Rings are claimed on first write.
+static struct asynclog_ring_rmcios *writer_ring (struct asynclog_rmcios *log)
+{
+#ifdef ASYNCLOG_NO_THREAD
+    return log->rings;
+#else
+    pthread_t self;
+    int i;
+
+    if (cached_log == log)
+    {
+        return cached_ring;
+    }
+    self = pthread_self ();
+    for (i = 0; i < ASYNCLOG_THREADS; i++)
+    {
+        struct asynclog_ring_rmcios *ring = log->rings + i;
+        if (ring->claimed == ring_ready
+            && pthread_equal (ring->owner, self))
+        {
+            cached_log = log;
+            cached_ring = ring;
+            return ring;
+        }
+    }
+    for (i = 0; i < ASYNCLOG_THREADS; i++)
+    {
+        struct asynclog_ring_rmcios *ring = log->rings + i;
+        if (ring->claimed == ring_free && CLAIM_RING (ring))
+        {
+            ring->owner = self;
+            ring->claimed = ring_ready;
+            cached_log = log;
+            cached_ring = ring;
+            return ring;
+        }
+    }
+    return 0;
+#endif
+}
+
+// Reserve next messages of the calling thread. 0 when they do not fit.
+static struct asynclog_ring_rmcios *reserve_messages (struct
+                                                      asynclog_rmcios *log,
+                                                      unsigned int count)
+{
+    struct asynclog_ring_rmcios *ring = writer_ring (log);
+    if (ring == 0)
+    {
+        log->ring_drops++;
+        log->drops++;
+        return 0;
+    }
+    if (ASYNCLOG_RING_SIZE - (ring->head - ring->tail) < count)
+    {
+        log->drops++;
+        return 0;
+    }
+    return ring;
+}
+
+// Message at offset from the ring head
+static struct asynclog_message_rmcios *ring_message (struct
+                                                     asynclog_ring_rmcios
+                                                     *ring,
+                                                     unsigned int offset)
+{
+    return ring->messages + ((ring->head + offset) & (ASYNCLOG_RING_SIZE - 1));
+}
+
+// Skip flags, width and precision of conversion specification.
+// Width and precision given as '*' are stored as int arguments.
+static const char *skip_flags (const char *f)
+{
+    while (*f == '-' || *f == '+' || *f == ' ' || *f == '#' || *f == '.'
+           || *f == '*' || (*f >= '0' && *f <= '9'))
+    {
+        f++;
+    }
+    return f;
+}
+
+// Type of argument for conversion character
+static enum argument_type conversion_type (char conversion)
+{
+    switch (conversion)
+    {
+    case 'd':
+    case 'i':
+    case 'u':
+    case 'x':
+    case 'X':
+    case 'o':
+    case 'c':
+        return argument_int;
+    case 'f':
+    case 'e':
+    case 'g':
+    case 'E':
+    case 'G':
+        return argument_double;
+    case 's':
+        return argument_string;
+    case 'p':
+        return argument_pointer;
+    default:
+        return argument_none;
+    }
+}
+
+int asynclog_printf (struct asynclog_rmcios *log, const char *format, ...)
+{
+    struct asynclog_ring_rmcios *ring = reserve_messages (log, 1);
+    struct asynclog_message_rmcios *message;
+    const char *f = format;
+    unsigned int length = 0;
+    va_list args;
+
+    if (ring == 0)
+    {
+        return -1;
+    }
+    message = ring_message (ring, 0);
+
+    va_start (args, format);
+    while (*f != 0)
+    {
+        int longs = 0;
+        int size_t_arg = 0;
+        const char *flags;
+        char conversion;
+        if (*f++ != '%')
+        {
+            continue;
+        }
+        if (*f == '%')
+        {
+            f++;
+            continue;
+        }
+        for (flags = f, f = skip_flags (f); flags < f; flags++)
+        {
+            int value;
+            if (*flags != '*')
+                continue;
+            // Width or precision argument
+            value = va_arg (args, int);
+            if (length + sizeof (value) > ASYNCLOG_PAYLOAD_SIZE)
+                continue;
+            memcpy (message->payload + length, &value, sizeof (value));
+            length += sizeof (value);
+        }
+        for (; *f == 'h' || *f == 'l' || *f == 'z'; f++)
+        {
+            if (*f == 'l')
+                longs++;
+            else if (*f == 'z')
+                size_t_arg = 1;
+        }
+        conversion = *f;
+        if (conversion == 'L')
+        {
+            // long double arguments are not supported
+            va_end (args);
+            return -1;
+        }
+        if (conversion == 0)
+        {
+            break;
+        }
+        f++;
+
+        switch (conversion_type (conversion))
+        {
+        case argument_int:
+            {
+                long long value;
+                if (longs >= 2)
+                    value = va_arg (args, long long);
+                else if (longs == 1)
+                    value = va_arg (args, long);
+                else if (size_t_arg)
+                    value = (long long) va_arg (args, size_t);
+                else
+                    value = va_arg (args, int);
+                if (length + sizeof (value) > ASYNCLOG_PAYLOAD_SIZE)
+                    break;
+                memcpy (message->payload + length, &value, sizeof (value));
+                length += sizeof (value);
+                break;
+            }
+        case argument_double:
+            {
+                double value = va_arg (args, double);
+                if (length + sizeof (value) > ASYNCLOG_PAYLOAD_SIZE)
+                    break;
+                memcpy (message->payload + length, &value, sizeof (value));
+                length += sizeof (value);
+                break;
+            }
+        case argument_pointer:
+            {
+                uintptr_t value = (uintptr_t) va_arg (args, void *);
+                if (length + sizeof (value) > ASYNCLOG_PAYLOAD_SIZE)
+                    break;
+                memcpy (message->payload + length, &value, sizeof (value));
+                length += sizeof (value);
+                break;
+            }
+        case argument_string:
+            {
+                // Copy with NULL-termination. Truncated to free space.
+                const char *value = va_arg (args, const char *);
+                if (value == 0)
+                    value = "(null)";
+                while (length < ASYNCLOG_PAYLOAD_SIZE - 1 && *value != 0)
+                {
+                    message->payload[length++] = *value++;
+                }
+                if (length < ASYNCLOG_PAYLOAD_SIZE)
+                    message->payload[length++] = 0;
+                break;
+            }
+        default:
+            break;
+        }
+    }
+    va_end (args);
+
+    message->format = format;
+    message->length = length;
+    message->more = 0;
+    // Publish to the drainer
+    ring->head++;
+    return 0;
+}
+
+int asynclog_write (struct asynclog_rmcios *log, const char *text,
+                    int length)
+{
+    struct asynclog_ring_rmcios *ring;
+    unsigned int count;
+    unsigned int i;
+    int truncated = (length > ASYNCLOG_LINE_SIZE - 1);
+
+    if (length < 0)
+    {
+        length = 0;
+    }
+    if (truncated)
+    {
+        // Drainer joins parts up to one line
+        length = ASYNCLOG_LINE_SIZE - 1;
+    }
+    count = (length + ASYNCLOG_PAYLOAD_SIZE - 1) / ASYNCLOG_PAYLOAD_SIZE;
+    if (count == 0)
+    {
+        count = 1;
+    }
+    ring = reserve_messages (log, count);
+    if (ring == 0)
+    {
+        return -1;
+    }
+    for (i = 0; i < count; i++)
+    {
+        struct asynclog_message_rmcios *message = ring_message (ring, i);
+        int part = length - i * ASYNCLOG_PAYLOAD_SIZE;
+        if (part > ASYNCLOG_PAYLOAD_SIZE)
+        {
+            part = ASYNCLOG_PAYLOAD_SIZE;
+        }
+        memcpy (message->payload, text + i * ASYNCLOG_PAYLOAD_SIZE, part);
+        message->format = 0;
+        message->length = part;
+        message->more = (i + 1 < count);
+    }
+    for (i = length - 3; truncated && i < (unsigned int) length; i++)
+    {
+        // Mark truncated text
+        ring_message (ring, i / ASYNCLOG_PAYLOAD_SIZE)->
+            payload[i % ASYNCLOG_PAYLOAD_SIZE] = '.';
+    }
+    // Publish all parts at once
+    ring->head += count;
+    return 0;
+}
+
+// Format message with arguments from payload. Returns length of line.
+static int format_message (const struct asynclog_message_rmcios *message,
+                           char *line, int size)
+{
+    const char *f = message->format;
+    unsigned int read = 0;
+    int length = 0;
+
+    if (f == 0)
+    {
+        length = (message->length < size - 1) ? message->length : size - 1;
+        memcpy (line, message->payload, length);
+        line[length] = 0;
+        return length;
+    }
+
+    while (*f != 0 && length < size - 1)
+    {
+        char spec[32];
+        int spec_length = 0;
+        const char *flags;
+        char conversion;
+        int n = 0;
+
+        if (*f != '%')
+        {
+            line[length++] = *f++;
+            continue;
+        }
+        if (f[1] == '%')
+        {
+            line[length++] = '%';
+            f += 2;
+            continue;
+        }
+
+        // Rebuild specification with fixed argument sizes and 
+        // stored width and precision:
+        spec[spec_length++] = *f++;
+        for (flags = f, f = skip_flags (f); flags < f; flags++)
+        {
+            int value;
+            if (spec_length > (int) sizeof (spec) - 16)
+            {
+                goto truncated;
+            }
+            if (*flags != '*')
+            {
+                spec[spec_length++] = *flags;
+                continue;
+            }
+            if (read + sizeof (value) > message->length)
+                goto truncated;
+            memcpy (&value, message->payload + read, sizeof (value));
+            read += sizeof (value);
+            spec_length += sprintf (spec + spec_length, "%d", value);
+        }
+        while (*f == 'h' || *f == 'l' || *f == 'z')
+        {
+            f++;
+        }
+        conversion = *f;
+        if (conversion == 0)
+        {
+            break;
+        }
+        f++;
+
+        switch (conversion_type (conversion))
+        {
+        case argument_int:
+            {
+                long long value;
+                if (read + sizeof (value) > message->length)
+                    goto truncated;
+                memcpy (&value, message->payload + read, sizeof (value));
+                read += sizeof (value);
+                if (conversion != 'c')
+                {
+                    spec[spec_length++] = 'l';
+                    spec[spec_length++] = 'l';
+                }
+                spec[spec_length++] = conversion;
+                spec[spec_length] = 0;
+                if (conversion == 'c')
+                    n = snprintf (line + length, size - length, spec,
+                                  (int) value);
+                else
+                    n = snprintf (line + length, size - length, spec, value);
+                break;
+            }
+        case argument_double:
+            {
+                double value;
+                if (read + sizeof (value) > message->length)
+                    goto truncated;
+                memcpy (&value, message->payload + read, sizeof (value));
+                read += sizeof (value);
+                spec[spec_length++] = conversion;
+                spec[spec_length] = 0;
+                n = snprintf (line + length, size - length, spec, value);
+                break;
+            }
+        case argument_pointer:
+            {
+                uintptr_t value;
+                if (read + sizeof (value) > message->length)
+                    goto truncated;
+                memcpy (&value, message->payload + read, sizeof (value));
+                read += sizeof (value);
+                spec[spec_length++] = conversion;
+                spec[spec_length] = 0;
+                n = snprintf (line + length, size - length, spec,
+                              (void *) value);
+                break;
+            }
+        case argument_string:
+            {
+                const char *value = message->payload + read;
+                if (read >= message->length)
+                    goto truncated;
+                read += strnlen (value, message->length - read) + 1;
+                spec[spec_length++] = conversion;
+                spec[spec_length] = 0;
+                n = snprintf (line + length, size - length, spec, value);
+                break;
+            }
+        default:
+            break;
+        }
+        if (n > 0)
+        {
+            length += n;
+        }
+    }
+    if (length > size - 1)
+    {
+        length = size - 1;
+    }
+    line[length] = 0;
+    return length;
+
+  truncated:
+    // Arguments did not fit to payload
+    if (length > size - 4)
+    {
+        length = size - 4;
+    }
+    memcpy (line + length, "...", 4);
+    return length + 3;
+}
+
+int asynclog_drain (struct asynclog_rmcios *log)
+{
+    char line[ASYNCLOG_LINE_SIZE];
+    unsigned int drops = log->drops;
+    unsigned int ring_drops = log->ring_drops;
+    int drained = 0;
+    int i;
+
+    for (i = 0; i < ASYNCLOG_THREADS; i++)
+    {
+        struct asynclog_ring_rmcios *ring = log->rings + i;
+        unsigned int claimed = ring->claimed;
+        int length = 0;
+        while (ring->tail != ring->head)
+        {
+            const struct asynclog_message_rmcios *message =
+                ring->messages + (ring->tail & (ASYNCLOG_RING_SIZE - 1));
+            int more = message->more;
+            length += format_message (message, line + length,
+                                      sizeof (line) - length);
+            ring->tail++;
+            if (more)
+            {
+                continue;
+            }
+            if (log->sink != 0)
+            {
+                write_buffer (log->context, log->sink, line, length, 0);
+            }
+            length = 0;
+            drained++;
+        }
+        if (claimed == ring_released && ring->tail == ring->head)
+        {
+            ring->claimed = ring_free;
+        }
+    }
+
+    if (drops != log->reported_drops && log->sink != 0)
+    {
+        int length = snprintf (line, sizeof (line),
+                               "asynclog: %u messages dropped"
+                               " (%u without ring)\r\n",
+                               drops - log->reported_drops,
+                               ring_drops - log->reported_ring_drops);
+        log->reported_drops = drops;
+        log->reported_ring_drops = ring_drops;
+        write_buffer (log->context, log->sink, line, length, 0);
+    }
+    return drained;
+}
+
+void asynclog_flush (struct asynclog_rmcios *log)
+{
+#ifndef ASYNCLOG_NO_THREAD
+    if (log->thread_started)
+    {
+        unsigned int heads[ASYNCLOG_THREADS];
+        struct timespec idle = {
+            .tv_sec = 0,
+            .tv_nsec = ASYNCLOG_IDLE_US * 1000L
+        };
+        int i;
+        for (i = 0; i < ASYNCLOG_THREADS; i++)
+        {
+            heads[i] = log->rings[i].head;
+        }
+        // Wait for the drainer. It is the only consumer of the rings.
+        for (i = 0; i < ASYNCLOG_THREADS; i++)
+        {
+            while ((int) (log->rings[i].tail - heads[i]) < 0)
+            {
+                nanosleep (&idle, 0);
+            }
+        }
+        return;
+    }
+#endif
+    asynclog_drain (log);
+}
+
+void asynclog_release (struct asynclog_rmcios *log)
+{
+#ifndef ASYNCLOG_NO_THREAD
+    struct asynclog_ring_rmcios *ring = writer_ring (log);
+    if (ring != 0)
+    {
+        ring->claimed = ring_released;
+    }
+    cached_log = 0;
+    cached_ring = 0;
+#endif
+}
+
+unsigned int asynclog_drops (struct asynclog_rmcios *log)
+{
+    return log->drops;
+}
+
+void asynclog_init (struct asynclog_rmcios *log,
+                    const struct context_rmcios *context, int sink)
+{
+    int i;
+    log->context = context;
+    log->id = 0;
+    log->sink = sink;
+    log->drops = 0;
+    log->ring_drops = 0;
+    log->reported_drops = 0;
+    log->reported_ring_drops = 0;
+    log->running = 0;
+#ifndef ASYNCLOG_NO_THREAD
+    log->thread_started = 0;
+#endif
+    for (i = 0; i < ASYNCLOG_THREADS; i++)
+    {
+        log->rings[i].claimed = ring_free;
+        log->rings[i].head = 0;
+        log->rings[i].tail = 0;
+    }
+}
+
+#ifndef ASYNCLOG_NO_THREAD
+static void *drainer_thread (void *data)
+{
+    struct asynclog_rmcios *log = (struct asynclog_rmcios *) data;
+    struct timespec idle = {
+        .tv_sec = 0,
+        .tv_nsec = ASYNCLOG_IDLE_US * 1000L
+    };
+    while (log->running)
+    {
+        if (asynclog_drain (log) == 0)
+        {
+            nanosleep (&idle, 0);
+        }
+    }
+    asynclog_drain (log);
+    return 0;
+}
+#endif
+
+int asynclog_start (struct asynclog_rmcios *log)
+{
+#ifndef ASYNCLOG_NO_THREAD
+    if (log->thread_started)
+    {
+        return 0;
+    }
+    log->running = 1;
+    if (pthread_create (&log->thread, 0, drainer_thread, log) != 0)
+    {
+        log->running = 0;
+        return -1;
+    }
+    log->thread_started = 1;
+    return 0;
+#else
+    return -1;
+#endif
+}
+
+void asynclog_stop (struct asynclog_rmcios *log)
+{
+#ifndef ASYNCLOG_NO_THREAD
+    if (log->thread_started)
+    {
+        log->running = 0;
+        pthread_join (log->thread, 0);
+        log->thread_started = 0;
+        return;
+    }
+#endif
+    asynclog_drain (log);
+}
+
+void asynclog_class_func (struct asynclog_rmcios *this,
+                          const struct context_rmcios *context,
+                          int id,
+                          enum function_rmcios function,
+                          enum type_rmcios paramtype,
+                          struct combo_rmcios *returnv,
+                          int num_params, const union param_rmcios param)
+{
+    switch (function)
+    {
+    case help_rmcios:
+        return_string (context, returnv,
+                       "asynclog channel"
+                       " - asynchronous log with background writer\r\n"
+                       "create asynclog newname\r\n"
+                       "setup newname sink #set channel for messages\r\n"
+                       "write newname text"
+                       " #queue message. Returns without waiting sink\r\n"
+                       "write newname #write queued messages now\r\n"
+                       "read newname #number of dropped messages\r\n");
+        break;
+
+    case create_rmcios:
+        if (num_params < 1)
+            break;
+        this = (struct asynclog_rmcios *)
+            allocate_storage (context, sizeof (struct asynclog_rmcios), 0);
+        if (this == 0)
+            break;
+        asynclog_init (this, context, 0);
+        this->id = create_channel_param (context, paramtype, param, 0,
+                                         (class_rmcios) asynclog_class_func,
+                                         this);
+        asynclog_start (this);
+        break;
+
+    case setup_rmcios:
+        if (this == 0 || num_params < 1)
+            break;
+        this->sink = param_to_channel (context, paramtype, param, 0);
+        break;
+
+    case write_rmcios:
+        if (this == 0)
+            break;
+        if (num_params == 0)
+        {
+            asynclog_flush (this);
+        }
+        else
+        {
+            char text[ASYNCLOG_LINE_SIZE];
+            struct buffer_rmcios b = param_to_buffer (context, paramtype,
+                                                      param, 0,
+                                                      sizeof (text), text);
+            // Text longer than a line is truncated and marked
+            asynclog_write (this, b.data, b.length);
+        }
+        break;
+
+    case read_rmcios:
+        if (this == 0)
+            break;
+        return_int (context, returnv, asynclog_drops (this));
+        break;
+
+    default:
+        break;
+    }
+}
+
+void init_asynclog_channels (const struct context_rmcios *context)
+{
+    create_channel_str (context, "asynclog",
+                        (class_rmcios) asynclog_class_func, 0);
+}
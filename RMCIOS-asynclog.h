@@ -0,0 +1,201 @@
+/*
+RMCIOS - Reactive Multipurpose Control Input Output System
+Copyright (c) 2018 Frans Korhonen
+
+RMCIOS was originally developed at Institute for Atmospheric 
+and Earth System Research / Physics, Faculty of Science, 
+University of Helsinki, Finland
+
+Assistance, experience and feedback from following persons have been 
+critical for development of RMCIOS: Erkki Siivola, Juha Kangasluoma, 
+Lauri Ahonen, Ella Häkkinen, Pasi Aalto, Joonas Enroth, Runlong Cai, 
+Markku Kulmala and Tuukka Petäjä.
+
+This file is part of RMCIOS. This notice was encoded using utf-8.
+
+RMCIOS is free software: you can redistribute this file and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RMCIOS is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public Licenses
+along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file RMCIOS-asynclog.h
+ * @author Frans Korhonen
+ * @brief Asynchronous logging channel.
+ *
+ * Log messages are queued to lock-free rings and written to the sink 
+ * channel by a background drainer thread. Callers do not wait for the
+ * sink. Each writing thread gets its own single producer ring.
+ *
+ * asynclog_printf() stores the format string pointer and the arguments
+ * in binary form. Formatting is made by the drainer. Format strings must
+ * stay valid until drained (string literals). String arguments are
+ * copied to the message.
+ *
+ * Messages that do not fit to the ring are dropped and counted. Text
+ * longer than one message payload is split to consecutive messages and
+ * joined by the drainer, up to ASYNCLOG_LINE_SIZE.
+ *
+ * Rings stay claimed until the writer thread calls asynclog_release().
+ * Writes of threads that get no ring are dropped and counted separately.
+ *
+ * Changelog: (date,who,description)
+ *
+ * */
+#ifndef rmcios_asynclog_h
+#define rmcios_asynclog_h
+
+#include "RMCIOS-API.h"
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L \
+    && !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+#define ASYNCLOG_ATOMIC_TYPE atomic_uint
+#else
+#define ASYNCLOG_ATOMIC_TYPE volatile unsigned int
+#endif
+
+#ifndef ASYNCLOG_NO_THREAD
+#include <pthread.h>
+#endif
+
+/// Number of writer threads with own ring
+#ifndef ASYNCLOG_THREADS
+#define ASYNCLOG_THREADS 8
+#endif
+
+/// Number of messages in one ring. Power of 2.
+#ifndef ASYNCLOG_RING_SIZE
+#define ASYNCLOG_RING_SIZE 64
+#endif
+
+/// Bytes of binary arguments or text in one message
+#ifndef ASYNCLOG_PAYLOAD_SIZE
+#define ASYNCLOG_PAYLOAD_SIZE 112
+#endif
+
+/// Maximum length of formatted message
+#ifndef ASYNCLOG_LINE_SIZE
+#define ASYNCLOG_LINE_SIZE 256
+#endif
+
+/// Drainer sleep time when rings are empty
+#ifndef ASYNCLOG_IDLE_US
+#define ASYNCLOG_IDLE_US 1000
+#endif
+
+/// @brief Queued log message
+struct asynclog_message_rmcios
+{
+    /// Format string. 0 on preformatted text in payload.
+    const char *format;
+    /// Used bytes in payload
+    unsigned short length;
+    /// Set when text continues in the next message
+    unsigned short more;
+    char payload[ASYNCLOG_PAYLOAD_SIZE];
+};
+
+/// @brief Single producer single consumer message ring
+struct asynclog_ring_rmcios
+{
+    /// Set when claimed by a writer thread
+    ASYNCLOG_ATOMIC_TYPE claimed;
+#ifndef ASYNCLOG_NO_THREAD
+    pthread_t owner;
+#endif
+    /// Next message written by the owner
+    ASYNCLOG_ATOMIC_TYPE head;
+    /// Next message read by the drainer
+    ASYNCLOG_ATOMIC_TYPE tail;
+    struct asynclog_message_rmcios messages[ASYNCLOG_RING_SIZE];
+};
+
+/// @brief Asynchronous log channel data
+struct asynclog_rmcios
+{
+    const struct context_rmcios *context;
+    int id;
+    /// Channel that receives formatted messages
+    int sink;
+    /// Number of dropped messages
+    ASYNCLOG_ATOMIC_TYPE drops;
+    /// Dropped messages of threads without free ring. Included in drops.
+    ASYNCLOG_ATOMIC_TYPE ring_drops;
+    /// Drops already reported to the sink
+    unsigned int reported_drops;
+    unsigned int reported_ring_drops;
+    ASYNCLOG_ATOMIC_TYPE running;
+#ifndef ASYNCLOG_NO_THREAD
+    pthread_t thread;
+    int thread_started;
+#endif
+    struct asynclog_ring_rmcios rings[ASYNCLOG_THREADS];
+};
+
+/// @brief Register asynclog channel class to the context.
+void init_asynclog_channels (const struct context_rmcios *context);
+
+/// @brief Initialize asynchronous log
+/// @param log log to be initialized
+/// @param context pointer to target system context
+/// @param sink channel that receives formatted messages
+void asynclog_init (struct asynclog_rmcios *log,
+                    const struct context_rmcios *context, int sink);
+
+/// @brief Start background drainer thread.
+/// @return 0 on success. -1 on failure or without thread support.
+int asynclog_start (struct asynclog_rmcios *log);
+
+/// @brief Stop drainer thread. Remaining messages are drained.
+void asynclog_stop (struct asynclog_rmcios *log);
+
+/// @brief Queue formatted message.
+///
+/// Supported conversions: d i u x X o c s p f e g E G and %%
+/// with flags, width, precision and h, l, ll, z length modifiers.
+/// Width and precision can be given as '*' arguments.
+/// L length modifier (long double) is not supported: the message
+/// is not queued and -1 is returned.
+/// @param log asynchronous log
+/// @param format format string. Must stay valid until drained.
+/// @return 0 on success. -1 when the message was dropped.
+int asynclog_printf (struct asynclog_rmcios *log, const char *format, ...);
+
+/// @brief Queue preformatted text. Text is copied.
+/// @return 0 on success. -1 when the message was dropped.
+int asynclog_write (struct asynclog_rmcios *log,
+                    const char *text, int length);
+
+/// @brief Format and write queued messages to the sink.
+///
+/// Called by the drainer thread. Can be called directly only when the
+/// drainer thread is not used: rings have a single consumer.
+/// @return number of written messages
+int asynclog_drain (struct asynclog_rmcios *log);
+
+/// @brief Wait until messages queued before the call are written.
+///
+/// Waits for the drainer thread when it runs. Otherwise drains on the
+/// calling thread.
+void asynclog_flush (struct asynclog_rmcios *log);
+
+/// @brief Release ring of the calling thread.
+///
+/// Called by writer threads before they exit. The ring is freed for other
+/// threads after its messages are drained.
+void asynclog_release (struct asynclog_rmcios *log);
+
+/// @brief Get number of dropped messages.
+unsigned int asynclog_drops (struct asynclog_rmcios *log);
+
+#endif
@@ -0,0 +1,446 @@
+/*
+RMCIOS - Reactive Multipurpose Control Input Output System
+Copyright (c) 2018 Frans Korhonen
+
+RMCIOS was originally developed at Institute for Atmospheric 
+and Earth System Research / Physics, Faculty of Science, 
+University of Helsinki, Finland
+
+Assistance, experience and feedback from following persons have been 
+critical for development of RMCIOS: Erkki Siivola, Juha Kangasluoma, 
+Lauri Ahonen, Ella Häkkinen, Pasi Aalto, Joonas Enroth, Runlong Cai, 
+Markku Kulmala and Tuukka Petäjä.
+
+This file is part of RMCIOS. This notice was encoded using utf-8.
+
+RMCIOS is free software: you can redistribute this file and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RMCIOS is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public Licenses
+along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RMCIOS-cache.h"
+#include "RMCIOS-functions.h"
+
+#include <string.h>
+#include <time.h>
+
+#ifdef CACHE_NO_THREAD
+#define CACHE_LOCK(cache)
+#define CACHE_UNLOCK(cache)
+#define CACHE_WAIT(cache)
+#define CACHE_BROADCAST(cache)
+#define CACHE_OWNER_IS_SELF(entry) 1
+#define CACHE_SET_OWNER(entry)
+#else
+#define CACHE_LOCK(cache) pthread_mutex_lock (&(cache)->lock)
+#define CACHE_UNLOCK(cache) pthread_mutex_unlock (&(cache)->lock)
+#define CACHE_WAIT(cache) pthread_cond_wait (&(cache)->filled, &(cache)->lock)
+#define CACHE_BROADCAST(cache) pthread_cond_broadcast (&(cache)->filled)
+#define CACHE_OWNER_IS_SELF(entry) \
+    pthread_equal ((entry)->owner, pthread_self ())
+#define CACHE_SET_OWNER(entry) (entry)->owner = pthread_self ()
+#endif
+
+// Current time in nanoseconds. Context clock is preferred.
+static long long cache_time (const struct context_rmcios *context)
+{
+    if (context_clock (context) != 0)
+    {
+        return read_time (context);
+    }
+    else
+    {
+        struct timespec now;
+        clock_gettime (CLOCK_MONOTONIC, &now);
+        return now.tv_sec * 1000000000LL + now.tv_nsec;
+    }
+}
+
+// Type the value is stored as for the return type.
+static enum type_rmcios stored_type (enum type_rmcios type)
+{
+    switch (type)
+    {
+    case int_rmcios:
+    case float_rmcios:
+    case int64_rmcios:
+    case double_rmcios:
+    case binary_rmcios:
+        return type;
+    default:
+        return buffer_rmcios;
+    }
+}
+
+// Entry key from read parameters. Returns key length. -1 when too long.
+static int make_key (const struct context_rmcios *context,
+                     enum type_rmcios paramtype,
+                     const union param_rmcios param, int num_params,
+                     char *key)
+{
+    int length = 0;
+    int i;
+    for (i = 0; i < num_params; i++)
+    {
+        char part[CACHE_KEY_SIZE];
+        struct buffer_rmcios b = param_to_buffer (context, paramtype, param,
+                                                  i, sizeof (part), part);
+        unsigned int size = (b.required_size > b.length) ?
+            b.required_size : b.length;
+        if (length + size + 1 > CACHE_KEY_SIZE)
+        {
+            return -1;
+        }
+        memcpy (key + length, b.data, b.length);
+        length += b.length;
+        key[length++] = 0;
+    }
+    return length;
+}
+
+static struct cache_entry_rmcios *find_entry (struct cache_rmcios *cache,
+                                              enum type_rmcios type,
+                                              const char *key, int length)
+{
+    int i;
+    for (i = 0; i < CACHE_ENTRIES; i++)
+    {
+        struct cache_entry_rmcios *entry = cache->entries + i;
+        if (entry->type == type && entry->key_length == length
+            && memcmp (entry->key, key, length) == 0)
+        {
+            return entry;
+        }
+    }
+    return 0;
+}
+
+// Entry to be replaced. Unused or earliest expiring. 0 when all in flight.
+static struct cache_entry_rmcios *replace_entry (struct cache_rmcios *cache)
+{
+    struct cache_entry_rmcios *victim = 0;
+    int i;
+    for (i = 0; i < CACHE_ENTRIES; i++)
+    {
+        struct cache_entry_rmcios *entry = cache->entries + i;
+        if (entry->in_flight)
+        {
+            continue;
+        }
+        if (entry->type == 0 || !entry->valid)
+        {
+            return entry;
+        }
+        if (victim == 0 || entry->expires < victim->expires)
+        {
+            victim = entry;
+        }
+    }
+    return victim;
+}
+
+static void return_value (const struct context_rmcios *context,
+                          struct combo_rmcios *returnv,
+                          const struct cache_entry_rmcios *entry)
+{
+    switch (entry->type)
+    {
+    case int_rmcios:
+        return_int (context, returnv, entry->value.i);
+        break;
+    case float_rmcios:
+        return_float (context, returnv, entry->value.f);
+        break;
+    case int64_rmcios:
+        return_int64 (context, returnv, entry->value.l);
+        break;
+    case double_rmcios:
+        return_double (context, returnv, entry->value.d);
+        break;
+    case binary_rmcios:
+        return_binary (context, returnv, entry->data, entry->length);
+        break;
+    default:
+        return_buffer (context, returnv, entry->data, entry->length);
+        break;
+    }
+}
+
+// Read value from the target to entry. Returns 0 when value did not fit.
+static int fetch_value (struct cache_rmcios *cache,
+                        const struct context_rmcios *context,
+                        enum type_rmcios paramtype,
+                        int num_params, const union param_rmcios param,
+                        struct cache_entry_rmcios *fetched)
+{
+    struct buffer_rmcios b = {
+        .data = fetched->data,
+        .length = 0,
+        .size = sizeof (fetched->data),
+        .required_size = 0,
+        .trailing_size = 0,
+        .flags = 0
+    };
+    struct combo_rmcios returnv = {
+        .paramtype = fetched->type,
+        .num_params = 1,
+        .param.bv = &b
+    };
+
+    switch (fetched->type)
+    {
+    case int_rmcios:
+        returnv.param.iv = &fetched->value.i;
+        break;
+    case float_rmcios:
+        returnv.param.fv = &fetched->value.f;
+        break;
+    case int64_rmcios:
+        returnv.param.lv = &fetched->value.l;
+        break;
+    case double_rmcios:
+        returnv.param.dv = &fetched->value.d;
+        break;
+    default:
+        break;
+    }
+    run_channel (context, cache->target, read_rmcios, paramtype,
+                 &returnv, num_params, param);
+    fetched->length = b.length;
+    return b.required_size <= b.size;
+}
+
+static void cache_read (struct cache_rmcios *cache,
+                        const struct context_rmcios *context,
+                        enum type_rmcios paramtype,
+                        struct combo_rmcios *returnv,
+                        int num_params, const union param_rmcios param)
+{
+    struct cache_entry_rmcios fetched;
+    struct cache_entry_rmcios *entry;
+    unsigned int generation;
+    int length;
+
+    if (returnv == 0 || chunk_cursor (returnv) != 0)
+    {
+        run_channel (context, cache->target, read_rmcios, paramtype,
+                     returnv, num_params, param);
+        return;
+    }
+    memset (&fetched, 0, sizeof (fetched));
+    fetched.type = stored_type (returnv->paramtype);
+    length = make_key (context, paramtype, param, num_params, fetched.key);
+    if (length < 0)
+    {
+        run_channel (context, cache->target, read_rmcios, paramtype,
+                     returnv, num_params, param);
+        return;
+    }
+    fetched.key_length = length;
+
+    CACHE_LOCK (cache);
+    for (;;)
+    {
+        entry = find_entry (cache, fetched.type, fetched.key, length);
+        if (entry == 0)
+        {
+            break;
+        }
+        if (entry->valid && cache_time (context) < entry->expires)
+        {
+            fetched = *entry;
+            cache->hits++;
+            CACHE_UNLOCK (cache);
+            return_value (context, returnv, &fetched);
+            return;
+        }
+        if (!entry->in_flight)
+        {
+            break;
+        }
+        if (CACHE_OWNER_IS_SELF (entry))
+        {
+            // Target reads itself through the cache
+            CACHE_UNLOCK (cache);
+            run_channel (context, cache->target, read_rmcios, paramtype,
+                         returnv, num_params, param);
+            return;
+        }
+        // Wait for the read in flight
+        CACHE_WAIT (cache);
+    }
+
+    if (entry == 0)
+    {
+        entry = replace_entry (cache);
+    }
+    if (entry == 0)
+    {
+        CACHE_UNLOCK (cache);
+        run_channel (context, cache->target, read_rmcios, paramtype,
+                     returnv, num_params, param);
+        return;
+    }
+    entry->type = fetched.type;
+    entry->key_length = fetched.key_length;
+    memcpy (entry->key, fetched.key, length);
+    entry->valid = 0;
+    entry->in_flight = 1;
+    CACHE_SET_OWNER (entry);
+    generation = cache->generation;
+    cache->misses++;
+    CACHE_UNLOCK (cache);
+
+    if (!fetch_value (cache, context, paramtype, num_params, param, &fetched))
+    {
+        // Too long value to be cached. Read again to the caller.
+        CACHE_LOCK (cache);
+        entry->in_flight = 0;
+        CACHE_BROADCAST (cache);
+        CACHE_UNLOCK (cache);
+        run_channel (context, cache->target, read_rmcios, paramtype,
+                     returnv, num_params, param);
+        return;
+    }
+
+    CACHE_LOCK (cache);
+    if (generation == cache->generation)
+    {
+        entry->value = fetched.value;
+        entry->length = fetched.length;
+        memcpy (entry->data, fetched.data, fetched.length);
+        entry->expires = cache_time (context) + cache->ttl;
+        entry->valid = 1;
+    }
+    entry->in_flight = 0;
+    CACHE_BROADCAST (cache);
+    CACHE_UNLOCK (cache);
+    return_value (context, returnv, &fetched);
+}
+
+void cache_invalidate (struct cache_rmcios *cache)
+{
+    int i;
+    CACHE_LOCK (cache);
+    cache->generation++;
+    for (i = 0; i < CACHE_ENTRIES; i++)
+    {
+        cache->entries[i].valid = 0;
+    }
+    CACHE_UNLOCK (cache);
+}
+
+void cache_init (struct cache_rmcios *cache,
+                 const struct context_rmcios *context,
+                 int target, int ttl_ms)
+{
+    memset (cache->entries, 0, sizeof (cache->entries));
+    cache->context = context;
+    cache->id = 0;
+    cache->target = target;
+    cache->ttl = ttl_ms * 1000000LL;
+    cache->generation = 0;
+    cache->hits = 0;
+    cache->misses = 0;
+#ifndef CACHE_NO_THREAD
+    pthread_mutex_init (&cache->lock, 0);
+    pthread_cond_init (&cache->filled, 0);
+#endif
+}
+
+void cache_class_func (struct cache_rmcios *this,
+                       const struct context_rmcios *context,
+                       int id,
+                       enum function_rmcios function,
+                       enum type_rmcios paramtype,
+                       struct combo_rmcios *returnv,
+                       int num_params, const union param_rmcios param)
+{
+    switch (function)
+    {
+    case help_rmcios:
+        return_string (context, returnv,
+                       "cache channel - read-through cache of slow channel\r\n"
+                       "create cache newname\r\n"
+                       "setup newname target ttl_ms"
+                       " #set cached channel and time to live\r\n"
+                       "read newname params"
+                       " #read from cache or from target\r\n"
+                       "write newname params"
+                       " #write to target and drop cached values\r\n");
+        break;
+
+    case create_rmcios:
+        if (num_params < 1)
+            break;
+        this = (struct cache_rmcios *)
+            allocate_storage (context, sizeof (struct cache_rmcios), 0);
+        if (this == 0)
+            break;
+        cache_init (this, context, 0, CACHE_TTL_MS);
+        this->id = create_channel_param (context, paramtype, param, 0,
+                                         (class_rmcios) cache_class_func,
+                                         this);
+        break;
+
+    case setup_rmcios:
+        if (this == 0 || num_params < 1)
+            break;
+        this->target = param_to_channel (context, paramtype, param, 0);
+        if (num_params >= 2)
+        {
+            this->ttl = param_to_integer (context, paramtype, param, 1)
+                * 1000000LL;
+        }
+        cache_invalidate (this);
+        break;
+
+    case write_rmcios:
+        if (this == 0)
+            break;
+        // Reads in flight during the write are not stored. Values
+        // read during the write are dropped after it.
+        cache_invalidate (this);
+        run_channel (context, this->target, write_rmcios, paramtype,
+                     returnv, num_params, param);
+        cache_invalidate (this);
+        break;
+
+    case read_rmcios:
+        if (this == 0)
+            break;
+        cache_read (this, context, paramtype, returnv, num_params, param);
+        break;
+
+    default:
+        break;
+    }
+}
+
+int create_cache_channel (const struct context_rmcios *context,
+                          const char *name, int target, int ttl_ms)
+{
+    struct cache_rmcios *cache = (struct cache_rmcios *)
+        allocate_storage (context, sizeof (struct cache_rmcios), 0);
+    if (cache == 0)
+        return 0;
+    cache_init (cache, context, target, ttl_ms);
+    cache->id = create_channel_str (context, name,
+                                    (class_rmcios) cache_class_func, cache);
+    return cache->id;
+}
+
+void init_cache_channels (const struct context_rmcios *context)
+{
+    create_channel_str (context, "cache",
+                        (class_rmcios) cache_class_func, 0);
+}
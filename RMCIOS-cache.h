@@ -0,0 +1,159 @@
+/*
+RMCIOS - Reactive Multipurpose Control Input Output System
+Copyright (c) 2018 Frans Korhonen
+
+RMCIOS was originally developed at Institute for Atmospheric 
+and Earth System Research / Physics, Faculty of Science, 
+University of Helsinki, Finland
+
+Assistance, experience and feedback from following persons have been 
+critical for development of RMCIOS: Erkki Siivola, Juha Kangasluoma, 
+Lauri Ahonen, Ella Häkkinen, Pasi Aalto, Joonas Enroth, Runlong Cai, 
+Markku Kulmala and Tuukka Petäjä.
+
+This file is part of RMCIOS. This notice was encoded using utf-8.
+
+RMCIOS is free software: you can redistribute this file and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RMCIOS is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public Licenses
+along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file RMCIOS-cache.h
+ * @author Frans Korhonen
+ * @brief Read-through caching channel for slow channels.
+ *
+ * Cache channel is placed in front of a slow target channel (e.g. 
+ * instrument behind serial line). Reads are returned from the cache 
+ * while the entry is younger than its time to live. Expired and missing
+ * entries are read from the target. Readers of an entry that is being
+ * read from the target wait for that read instead of starting own read.
+ * Writes are passed to the target and invalidate all entries before 
+ * and after the write.
+ *
+ * Entries are keyed by the return type class (int, float, int64, 
+ * double, binary or text) and the read parameters. Reads with longer 
+ * parameters than CACHE_KEY_SIZE are passed to the target. Values longer
+ * than CACHE_VALUE_SIZE are not cached and are read again to the caller.
+ *
+ * Cache is created with single call:
+ *   create_cache_channel (context, "meter_cached", meter, 500);
+ * or with channel commands:
+ *   create cache newname
+ *   setup newname target ttl_ms
+ *
+ * Define CACHE_NO_THREAD for single threaded systems.
+ *
+ * Changelog: (date,who,description)
+ *
+ * */
+#ifndef rmcios_cache_h
+#define rmcios_cache_h
+
+#include "RMCIOS-API.h"
+
+#ifndef CACHE_NO_THREAD
+#include <pthread.h>
+#endif
+
+/// Number of cached entries
+#ifndef CACHE_ENTRIES
+#define CACHE_ENTRIES 8
+#endif
+
+/// Maximum size of read parameters in entry key
+#ifndef CACHE_KEY_SIZE
+#define CACHE_KEY_SIZE 32
+#endif
+
+/// Maximum size of cached binary or text value
+#ifndef CACHE_VALUE_SIZE
+#define CACHE_VALUE_SIZE 128
+#endif
+
+/// Default time to live in milliseconds
+#ifndef CACHE_TTL_MS
+#define CACHE_TTL_MS 1000
+#endif
+
+/// @brief Cached read result
+struct cache_entry_rmcios
+{
+    /// Type of the stored value. 0 on unused entry.
+    enum type_rmcios type;
+    unsigned short key_length;
+    char key[CACHE_KEY_SIZE];
+    /// Set when value is valid
+    int valid;
+    /// Set while value is read from the target
+    int in_flight;
+#ifndef CACHE_NO_THREAD
+    pthread_t owner;
+#endif
+    /// Expiration time (ns)
+    long long expires;
+    union
+    {
+        int i;
+        float f;
+        long long l;
+        double d;
+    } value;
+    unsigned int length;
+    char data[CACHE_VALUE_SIZE];
+};
+
+/// @brief Caching channel data
+struct cache_rmcios
+{
+    const struct context_rmcios *context;
+    int id;
+    /// Channel behind the cache
+    int target;
+    /// Time to live of new entries in nanoseconds
+    long long ttl;
+    /// Incremented on invalidation
+    unsigned int generation;
+    unsigned int hits;
+    unsigned int misses;
+#ifndef CACHE_NO_THREAD
+    pthread_mutex_t lock;
+    pthread_cond_t filled;
+#endif
+    struct cache_entry_rmcios entries[CACHE_ENTRIES];
+};
+
+/// @brief Register cache channel class to the context.
+void init_cache_channels (const struct context_rmcios *context);
+
+/// @brief Initialize cache
+/// @param cache cache to be initialized
+/// @param context pointer to target system context
+/// @param target channel behind the cache
+/// @param ttl_ms time to live of entries in milliseconds
+void cache_init (struct cache_rmcios *cache,
+                 const struct context_rmcios *context,
+                 int target, int ttl_ms);
+
+/// @brief Drop all cached entries
+void cache_invalidate (struct cache_rmcios *cache);
+
+/// @brief Create caching channel in front of target channel
+/// @param context pointer to target system context
+/// @param name name of the new channel
+/// @param target channel behind the cache
+/// @param ttl_ms time to live of entries in milliseconds
+/// @return id of the new channel. 0 on failure.
+int create_cache_channel (const struct context_rmcios *context,
+                          const char *name, int target, int ttl_ms);
+
+#endif
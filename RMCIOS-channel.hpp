@@ -0,0 +1,363 @@
+/*
+RMCIOS - Reactive Multipurpose Control Input Output System
+Copyright (c) 2018 Frans Korhonen
+
+RMCIOS was originally developed at Institute for Atmospheric 
+and Earth System Research / Physics, Faculty of Science, 
+University of Helsinki, Finland
+
+Assistance, experience and feedback from following persons have been 
+critical for development of RMCIOS: Erkki Siivola, Juha Kangasluoma, 
+Lauri Ahonen, Ella Häkkinen, Pasi Aalto, Joonas Enroth, Runlong Cai, 
+Markku Kulmala and Tuukka Petäjä.
+
+This file is part of RMCIOS. This notice was encoded using utf-8.
+
+RMCIOS is free software: you can redistribute this file and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RMCIOS is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public Licenses
+along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file RMCIOS-channel.hpp
+ * @author Frans Korhonen
+ * @brief CRTP base for implementing channel classes in C++.
+ *
+ * channel_base generates the class_rmcios function of the channel.
+ * Calls are routed to typed handlers of the derived class:
+ *
+ *   struct filter : rmcios::channel_base<filter>
+ *   {
+ *       void on_write (rmcios::call_info &c, rmcios::span<const float> v);
+ *       void on_read (rmcios::call_info &c, rmcios::raw_params p);
+ *   };
+ *
+ * Handlers are on_write, on_read, on_setup, on_create and on_link. 
+ * Calls without handler are ignored. Parameter types:
+ * span<const float>, span<const double>, span<const int>,
+ * span<const buffer> and raw_params.
+ * Parameters given in handler type are passed directly without 
+ * conversion. Other parameter types are converted to the handler type.
+ * Calls with more than CHANNEL_MAX_CONVERTED parameters to convert are
+ * reported to the errors channel and not passed to the handler.
+ * Handler selection is resolved at compile time.
+ *
+ * Requires C++17. std::span is used on C++20.
+ *
+ * Changelog: (date,who,description)
+ *
+ * */
+#ifndef rmcios_channel_hpp
+#define rmcios_channel_hpp
+
+#include "RMCIOS.hpp"
+
+#include <type_traits>
+
+#if __cplusplus >= 202002L && __has_include(<span>)
+#include <span>
+#endif
+
+namespace rmcios
+{
+#if __cplusplus >= 202002L && __has_include(<span>)
+    template <typename T>
+    using span = std::span<T>;
+#else
+    /// @brief Minimal span for C++17.
+    template <typename T>
+    class span
+    {
+    public:
+        span (T *data, std::size_t size) : data_ (data), size_ (size)
+        {
+        }
+        T *data () const
+        {
+            return data_;
+        }
+        std::size_t size () const
+        {
+            return size_;
+        }
+        bool empty () const
+        {
+            return size_ == 0;
+        }
+        T &operator[] (std::size_t i) const
+        {
+            return data_[i];
+        }
+        T *begin () const
+        {
+            return data_;
+        }
+        T *end () const
+        {
+            return data_ + size_;
+        }
+    private:
+        T *data_;
+        std::size_t size_;
+    };
+#endif
+
+    /// Maximum number of parameters converted to handler type
+#ifndef CHANNEL_MAX_CONVERTED
+#define CHANNEL_MAX_CONVERTED 32
+#endif
+
+    /// @brief Parameters as given to class_rmcios
+    struct raw_params
+    {
+        enum type_rmcios paramtype;
+        int num_params;
+        param p;
+    };
+
+    /// @brief Information of the channel call
+    struct call_info
+    {
+        const context *ctx;
+        int id;
+        combo *returnv;
+
+        void return_int (int value)
+        {
+            ::return_int (ctx, returnv, value);
+        }
+        void return_float (float value)
+        {
+            ::return_float (ctx, returnv, value);
+        }
+        void return_double (double value)
+        {
+            ::return_double (ctx, returnv, value);
+        }
+        void return_string (const char *value)
+        {
+            ::return_string (ctx, returnv, value);
+        }
+        void return_buffer (const char *data, unsigned int length)
+        {
+            ::return_buffer (ctx, returnv, data, length);
+        }
+    };
+
+    /// @brief Base class for channel classes.
+    template <typename Derived>
+    class channel_base
+    {
+    public:
+        /// @brief class_rmcios function of the channel.
+        static void class_func (void *data, const context *ctx, int id,
+                                enum function_rmcios function,
+                                enum type_rmcios paramtype,
+                                combo *returnv,
+                                int num_params, param p)
+        {
+            call_info c = { ctx, id, returnv };
+            Derived *self = static_cast<Derived *> (
+                static_cast<channel_base *> (data));
+            if (self == nullptr)
+            {
+                return;
+            }
+
+            switch (function)
+            {
+            case help_rmcios:
+                if constexpr (has_help<Derived>::value)
+                {
+                    c.return_string (Derived::help_text);
+                }
+                break;
+
+            case write_rmcios:
+                dispatch (*self, c, paramtype, num_params, p,
+                          [](auto &d, call_info &ci, auto args)
+                          -> decltype (d.on_write (ci, args))
+                          {
+                              return d.on_write (ci, args);
+                          });
+                break;
+
+            case read_rmcios:
+                dispatch (*self, c, paramtype, num_params, p,
+                          [](auto &d, call_info &ci, auto args)
+                          -> decltype (d.on_read (ci, args))
+                          {
+                              return d.on_read (ci, args);
+                          });
+                break;
+
+            case setup_rmcios:
+                dispatch (*self, c, paramtype, num_params, p,
+                          [](auto &d, call_info &ci, auto args)
+                          -> decltype (d.on_setup (ci, args))
+                          {
+                              return d.on_setup (ci, args);
+                          });
+                break;
+
+            case create_rmcios:
+                dispatch (*self, c, paramtype, num_params, p,
+                          [](auto &d, call_info &ci, auto args)
+                          -> decltype (d.on_create (ci, args))
+                          {
+                              return d.on_create (ci, args);
+                          });
+                break;
+
+            case link_rmcios:
+                dispatch (*self, c, paramtype, num_params, p,
+                          [](auto &d, call_info &ci, auto args)
+                          -> decltype (d.on_link (ci, args))
+                          {
+                              return d.on_link (ci, args);
+                          });
+                break;
+
+            default:
+                break;
+            }
+        }
+
+        /// @brief Create channel for this object.
+        /// @return Handle to the created channel. 0 on failure.
+        int create (const context *ctx, const char *name)
+        {
+            id_ = create_channel_str (ctx, name, class_func,
+                                      static_cast<channel_base *> (this));
+            return id_;
+        }
+
+        /// @brief Handle of the created channel
+        int id () const
+        {
+            return id_;
+        }
+
+    private:
+        int id_ = 0;
+
+        template <typename D, typename = void>
+        struct has_help : std::false_type
+        {
+        };
+
+        template <typename D>
+        struct has_help<D, std::void_t<decltype (D::help_text)>>
+            : std::true_type
+        {
+        };
+
+        template <typename F, typename Arg>
+        static constexpr bool accepts =
+            std::is_invocable_v<F, Derived &, call_info &, Arg>;
+
+        // Route call to the handler overload matching parameter type.
+        template <typename F>
+        static void dispatch (Derived &self, call_info &c,
+                              enum type_rmcios paramtype,
+                              int num_params, param p, F handler)
+        {
+            constexpr bool takes_float = accepts<F, span<const float>>;
+            constexpr bool takes_double = accepts<F, span<const double>>;
+            constexpr bool takes_int = accepts<F, span<const int>>;
+            constexpr bool takes_buffer = accepts<F, span<const buffer>>;
+            constexpr bool takes_raw = accepts<F, raw_params>;
+            std::size_t n = (num_params > 0) ? num_params : 0;
+
+            switch (paramtype)
+            {
+            case float_rmcios:
+                if constexpr (takes_float)
+                {
+                    handler (self, c, span<const float> (p.fv, n));
+                    return;
+                }
+                break;
+            case double_rmcios:
+                if constexpr (takes_double)
+                {
+                    handler (self, c, span<const double> (p.dv, n));
+                    return;
+                }
+                break;
+            case int_rmcios:
+                if constexpr (takes_int)
+                {
+                    handler (self, c, span<const int> (p.iv, n));
+                    return;
+                }
+                break;
+            case buffer_rmcios:
+            case binary_rmcios:
+                if constexpr (takes_buffer)
+                {
+                    handler (self, c, span<const buffer> (p.bv, n));
+                    return;
+                }
+                break;
+            default:
+                break;
+            }
+
+            // Parameters not in handler type:
+            if constexpr (takes_raw)
+            {
+                handler (self, c, raw_params { paramtype, num_params, p });
+            }
+            else if constexpr (takes_float || takes_double || takes_int)
+            {
+                if (n > CHANNEL_MAX_CONVERTED)
+                {
+                    // Call is refused rather than passing part of the
+                    // parameters. Handler for raw_params takes any count.
+                    info (c.ctx, c.ctx->errors,
+                          "channel: too many parameters to convert\r\n");
+                    return;
+                }
+                if constexpr (takes_float)
+                {
+                    float values[CHANNEL_MAX_CONVERTED];
+                    for (std::size_t i = 0; i < n; i++)
+                    {
+                        values[i] = param_to_float (c.ctx, paramtype, p, i);
+                    }
+                    handler (self, c, span<const float> (values, n));
+                }
+                else if constexpr (takes_double)
+                {
+                    double values[CHANNEL_MAX_CONVERTED];
+                    for (std::size_t i = 0; i < n; i++)
+                    {
+                        values[i] = param_to_double (c.ctx, paramtype, p, i);
+                    }
+                    handler (self, c, span<const double> (values, n));
+                }
+                else
+                {
+                    int values[CHANNEL_MAX_CONVERTED];
+                    for (std::size_t i = 0; i < n; i++)
+                    {
+                        values[i] = param_to_integer (c.ctx, paramtype, p, i);
+                    }
+                    handler (self, c, span<const int> (values, n));
+                }
+            }
+        }
+    };
+}
+
+#endif
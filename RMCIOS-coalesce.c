@@ -0,0 +1,363 @@
+/*
+RMCIOS - Reactive Multipurpose Control Input Output System
+Copyright (c) 2018 Frans Korhonen
+
+RMCIOS was originally developed at Institute for Atmospheric 
+and Earth System Research / Physics, Faculty of Science, 
+University of Helsinki, Finland
+
+Assistance, experience and feedback from following persons have been 
+critical for development of RMCIOS: Erkki Siivola, Juha Kangasluoma, 
+Lauri Ahonen, Ella Häkkinen, Pasi Aalto, Joonas Enroth, Runlong Cai, 
+Markku Kulmala and Tuukka Petäjä.
+
+This file is part of RMCIOS. This notice was encoded using utf-8.
+
+RMCIOS is free software: you can redistribute this file and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RMCIOS is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public Licenses
+along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RMCIOS-coalesce.h"
+#include "RMCIOS-functions.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// Current time in nanoseconds. Context clock is preferred.
+static long long coalesce_time (const struct context_rmcios *context)
+{
+    if (context_clock (context) != 0)
+    {
+        return read_time (context);
+    }
+    else
+    {
+        struct timespec now;
+        clock_gettime (CLOCK_MONOTONIC, &now);
+        return now.tv_sec * 1000000000LL + now.tv_nsec;
+    }
+}
+
+// FNV-1a hash of message template.
+// Numbers are skipped from text so changing values share the key.
+static unsigned int template_hash (const char *template,
+                                   const char *text, int length, int source)
+{
+    unsigned int hash = 2166136261u ^ (unsigned int) source;
+    int number = 0;
+    int i;
+
+    if (template != 0)
+    {
+        for (i = 0; template[i] != 0; i++)
+        {
+            hash = (hash ^ (unsigned char) template[i]) * 16777619u;
+        }
+    }
+    else
+    {
+        for (i = 0; i < length; i++)
+        {
+            char c = text[i];
+            if ((c >= '0' && c <= '9') || (number && c == '.'))
+            {
+                number = 1;
+                continue;
+            }
+            number = 0;
+            hash = (hash ^ (unsigned char) c) * 16777619u;
+        }
+    }
+    // 0 marks unused entry
+    return (hash != 0) ? hash : 1;
+}
+
+// Skip number that starts from text[i]. Returns index after the number.
+static int skip_number (const char *text, int length, int i)
+{
+    if (i < length && text[i] >= '0' && text[i] <= '9')
+    {
+        while (i < length && ((text[i] >= '0' && text[i] <= '9')
+                              || text[i] == '.'))
+        {
+            i++;
+        }
+    }
+    return i;
+}
+
+// Compare message to the key of entry. Hash match is not enough:
+// Different templates may share the hash.
+static int same_template (const struct coalesce_entry_rmcios *entry,
+                          const char *template, const char *text, int length)
+{
+    const char *sample = entry->sample;
+    int truncated = (entry->sample_length == COALESCE_SAMPLE_SIZE);
+    int i = 0;
+    int j = 0;
+
+    if (template != 0 || entry->template != 0)
+    {
+        return template != 0 && entry->template != 0
+            && strcmp (template, entry->template) == 0;
+    }
+    for (;;)
+    {
+        i = skip_number (sample, entry->sample_length, i);
+        j = skip_number (text, length, j);
+        if (i >= entry->sample_length)
+        {
+            // Only stored part of long message is compared
+            return truncated || j >= length;
+        }
+        if (j >= length || sample[i] != text[j])
+        {
+            return 0;
+        }
+        i++;
+        j++;
+    }
+}
+
+// Write summary of suppressed repeats.
+static int write_summary (struct coalesce_rmcios *filter,
+                          struct coalesce_entry_rmcios *entry)
+{
+    char line[COALESCE_SAMPLE_SIZE + 40];
+    int length = entry->sample_length;
+    int i;
+
+    if (entry->repeats == 0)
+    {
+        return 0;
+    }
+    // Trailing line feed is moved after the count:
+    while (length > 0 && (entry->sample[length - 1] == '\n'
+                          || entry->sample[length - 1] == '\r'))
+    {
+        length--;
+    }
+    for (i = 0; i < length; i++)
+    {
+        line[i] = entry->sample[i];
+    }
+    length += snprintf (line + length, sizeof (line) - length,
+                        " (repeated %u times)\r\n", entry->repeats);
+    entry->repeats = 0;
+    if (filter->sink != 0)
+    {
+        write_buffer (filter->context, filter->sink, line, length, 0);
+    }
+    return 1;
+}
+
+int coalesce_write (struct coalesce_rmcios *filter, int source,
+                    const char *template, const char *text, int length)
+{
+    unsigned int key = template_hash (template, text, length, source);
+    long long now = coalesce_time (filter->context);
+    struct coalesce_entry_rmcios *entry = 0;
+    struct coalesce_entry_rmcios *oldest = 0;
+    int i;
+
+    for (i = 0; i < COALESCE_PROBES; i++)
+    {
+        struct coalesce_entry_rmcios *probe =
+            filter->entries + ((key + i) & (COALESCE_SLOTS - 1));
+        if (probe->key == key && probe->source == source
+            && same_template (probe, template, text, length))
+        {
+            entry = probe;
+            break;
+        }
+        if (oldest == 0 || probe->key == 0
+            || (oldest->key != 0 && probe->window_end < oldest->window_end))
+        {
+            oldest = probe;
+        }
+    }
+
+    if (entry != 0 && now < entry->window_end)
+    {
+        entry->repeats++;
+        filter->suppressed++;
+        return 0;
+    }
+
+    if (entry == 0)
+    {
+        // Replace unused or oldest key of the probe sequence
+        entry = oldest;
+        if (entry->key != 0)
+        {
+            write_summary (filter, entry);
+        }
+        entry->key = key;
+        entry->source = source;
+        entry->template = template;
+        entry->repeats = 0;
+    }
+    else
+    {
+        write_summary (filter, entry);
+    }
+
+    entry->window_end = now + filter->window;
+    entry->sample_length = (length < COALESCE_SAMPLE_SIZE) ?
+        length : COALESCE_SAMPLE_SIZE;
+    for (i = 0; i < entry->sample_length; i++)
+    {
+        entry->sample[i] = text[i];
+    }
+    if (filter->sink != 0)
+    {
+        write_buffer (filter->context, filter->sink, text, length, 0);
+    }
+    return 1;
+}
+
+int coalesce_flush (struct coalesce_rmcios *filter)
+{
+    long long now = coalesce_time (filter->context);
+    int written = 0;
+    int i;
+    for (i = 0; i < COALESCE_SLOTS; i++)
+    {
+        struct coalesce_entry_rmcios *entry = filter->entries + i;
+        if (entry->key != 0 && entry->repeats > 0 && now >= entry->window_end)
+        {
+            written += write_summary (filter, entry);
+        }
+    }
+    return written;
+}
+
+void coalesce_init (struct coalesce_rmcios *filter,
+                    const struct context_rmcios *context,
+                    int sink, int window_ms)
+{
+    int i;
+    filter->context = context;
+    filter->id = 0;
+    filter->sink = sink;
+    filter->window = window_ms * 1000000LL;
+    filter->suppressed = 0;
+    for (i = 0; i < COALESCE_SLOTS; i++)
+    {
+        filter->entries[i].key = 0;
+        filter->entries[i].repeats = 0;
+    }
+}
+
+void coalesce_class_func (struct coalesce_rmcios *this,
+                          const struct context_rmcios *context,
+                          int id,
+                          enum function_rmcios function,
+                          enum type_rmcios paramtype,
+                          struct combo_rmcios *returnv,
+                          int num_params, const union param_rmcios param)
+{
+    switch (function)
+    {
+    case help_rmcios:
+        return_string (context, returnv,
+                       "coalesce channel"
+                       " - rate limiting filter for repeated messages\r\n"
+                       "create coalesce newname\r\n"
+                       "setup newname sink | window_ms"
+                       " #set sink and suppression window\r\n"
+                       "write newname text | source"
+                       " #pass or count repeated message\r\n"
+                       "  #source defaults to the return channel\r\n"
+                       "write newname #write summaries of ended windows\r\n"
+                       "read newname #number of suppressed messages\r\n");
+        break;
+
+    case create_rmcios:
+        if (num_params < 1)
+            break;
+        this = (struct coalesce_rmcios *)
+            allocate_storage (context, sizeof (struct coalesce_rmcios), 0);
+        if (this == 0)
+            break;
+        coalesce_init (this, context, 0, COALESCE_WINDOW_MS);
+        this->id = create_channel_param (context, paramtype, param, 0,
+                                         (class_rmcios) coalesce_class_func,
+                                         this);
+        break;
+
+    case setup_rmcios:
+        if (this == 0 || num_params < 1)
+            break;
+        this->sink = param_to_channel (context, paramtype, param, 0);
+        if (num_params >= 2)
+        {
+            this->window = param_to_integer (context, paramtype, param, 1)
+                * 1000000LL;
+        }
+        break;
+
+    case write_rmcios:
+        if (this == 0)
+            break;
+        if (num_params == 0)
+        {
+            coalesce_flush (this);
+        }
+        else
+        {
+            struct buffer_rmcios b;
+            int source = 0;
+
+            if (paramtype == buffer_rmcios || paramtype == binary_rmcios
+                || paramtype == moved_rmcios)
+            {
+                // Passed through whole without copy
+                b = param.bv[0];
+            }
+            else
+            {
+                b = param_to_buffer (context, paramtype, param, 0,
+                                     sizeof (this->line), this->line);
+            }
+            if (num_params >= 2)
+            {
+                source = param_to_channel (context, paramtype, param, 1);
+            }
+            else if (returnv != 0 && returnv->paramtype == channel_rmcios
+                     && returnv->num_params > 0)
+            {
+                // Reporting channel of write_str/write_buffer calls
+                source = returnv->param.channel;
+            }
+            coalesce_write (this, source, 0, b.data, b.length);
+        }
+        break;
+
+    case read_rmcios:
+        if (this == 0)
+            break;
+        return_int (context, returnv, this->suppressed);
+        break;
+
+    default:
+        break;
+    }
+}
+
+void init_coalesce_channels (const struct context_rmcios *context)
+{
+    create_channel_str (context, "coalesce",
+                        (class_rmcios) coalesce_class_func, 0);
+}
@@ -0,0 +1,147 @@
+/*
+RMCIOS - Reactive Multipurpose Control Input Output System
+Copyright (c) 2018 Frans Korhonen
+
+RMCIOS was originally developed at Institute for Atmospheric 
+and Earth System Research / Physics, Faculty of Science, 
+University of Helsinki, Finland
+
+Assistance, experience and feedback from following persons have been 
+critical for development of RMCIOS: Erkki Siivola, Juha Kangasluoma, 
+Lauri Ahonen, Ella Häkkinen, Pasi Aalto, Joonas Enroth, Runlong Cai, 
+Markku Kulmala and Tuukka Petäjä.
+
+This file is part of RMCIOS. This notice was encoded using utf-8.
+
+RMCIOS is free software: you can redistribute this file and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RMCIOS is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public Licenses
+along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file RMCIOS-coalesce.h
+ * @author Frans Korhonen
+ * @brief Rate limiting filter for repeated warnings and errors.
+ *
+ * Filter is placed in front of the warning or errors sink. Messages are 
+ * keyed on source channel and message template. The template of text 
+ * messages is the text without numbers, so repeats with changing values 
+ * are coalesced. First message of a key is passed through. Repeats 
+ * during the window are counted and reported as single summary:
+ *
+ *   <first message> (repeated N times)
+ *
+ * Keys with equal hash are told apart by comparing the stored template
+ * or first message.
+ * Summary is written when the key is seen after the window or on flush.
+ * Lookup is made from fixed open addressing table with bounded probing.
+ * No memory is allocated after creation. Buffer and binary messages are
+ * passed to the sink without copy. Other parameter types are converted to
+ * the line buffer of the filter and are truncated to COALESCE_LINE_SIZE.
+ *
+ * Filter is not thread safe. Asynchronous log channel can be used as
+ * the sink of the filter.
+ *
+ * Changelog: (date,who,description)
+ *
+ * */
+#ifndef rmcios_coalesce_h
+#define rmcios_coalesce_h
+
+#include "RMCIOS-API.h"
+
+/// Number of keys in table. Power of 2.
+#ifndef COALESCE_SLOTS
+#define COALESCE_SLOTS 256
+#endif
+
+/// Maximum number of probed slots on lookup
+#ifndef COALESCE_PROBES
+#define COALESCE_PROBES 8
+#endif
+
+/// Stored bytes of first message for the summary
+#ifndef COALESCE_SAMPLE_SIZE
+#define COALESCE_SAMPLE_SIZE 80
+#endif
+
+/// Size of line buffer for messages converted from other than buffer
+#ifndef COALESCE_LINE_SIZE
+#define COALESCE_LINE_SIZE 512
+#endif
+
+/// Default window in milliseconds
+#ifndef COALESCE_WINDOW_MS
+#define COALESCE_WINDOW_MS 10000
+#endif
+
+/// @brief Coalesced message key
+struct coalesce_entry_rmcios
+{
+    /// Hash of the template. 0 on unused entry.
+    unsigned int key;
+    int source;
+    /// Template given by the reporter. 0 when derived from the sample.
+    const char *template;
+    /// End of suppression window (ns)
+    long long window_end;
+    /// Repeats during the window
+    unsigned int repeats;
+    unsigned short sample_length;
+    char sample[COALESCE_SAMPLE_SIZE];
+};
+
+/// @brief Coalescing filter channel data
+struct coalesce_rmcios
+{
+    const struct context_rmcios *context;
+    int id;
+    /// Channel that receives passed messages and summaries
+    int sink;
+    /// Window length in nanoseconds
+    long long window;
+    /// Total number of suppressed messages
+    unsigned int suppressed;
+    /// Converted message of channel write
+    char line[COALESCE_LINE_SIZE];
+    struct coalesce_entry_rmcios entries[COALESCE_SLOTS];
+};
+
+/// @brief Register coalesce channel class to the context.
+void init_coalesce_channels (const struct context_rmcios *context);
+
+/// @brief Initialize coalescing filter
+/// @param filter filter to be initialized
+/// @param context pointer to target system context
+/// @param sink channel that receives passed messages and summaries
+/// @param window_ms suppression window in milliseconds
+void coalesce_init (struct coalesce_rmcios *filter,
+                    const struct context_rmcios *context,
+                    int sink, int window_ms);
+
+/// @brief Pass or suppress message
+///
+/// @param filter coalescing filter
+/// @param source channel that reports the message. 0 when unknown.
+/// @param template message template. 0 to derive it from the text.
+///        Given template must remain valid while the filter is used.
+/// @param text message text
+/// @param length length of @p text
+/// @return 1 when the message was passed to the sink. 0 when suppressed.
+int coalesce_write (struct coalesce_rmcios *filter, int source,
+                    const char *template, const char *text, int length);
+
+/// @brief Write summaries of keys whose window has ended.
+/// @return number of written summaries
+int coalesce_flush (struct coalesce_rmcios *filter);
+
+#endif
@@ -0,0 +1,270 @@
+/*
+RMCIOS - Reactive Multipurpose Control Input Output System
+Copyright (c) 2018 Frans Korhonen
+
+RMCIOS was originally developed at Institute for Atmospheric 
+and Earth System Research / Physics, Faculty of Science, 
+University of Helsinki, Finland
+
+Assistance, experience and feedback from following persons have been 
+critical for development of RMCIOS: Erkki Siivola, Juha Kangasluoma, 
+Lauri Ahonen, Ella Häkkinen, Pasi Aalto, Joonas Enroth, Runlong Cai, 
+Markku Kulmala and Tuukka Petäjä.
+
+This file is part of RMCIOS. This notice was encoded using utf-8.
+
+RMCIOS is free software: you can redistribute this file and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RMCIOS is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public Licenses
+along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RMCIOS-completion.h"
+#include "RMCIOS-functions.h"
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L \
+    && !defined(__STDC_NO_ATOMICS__)
+#define CHANGE_STATE(slot, from, to) \
+    atomic_compare_exchange_strong (&(slot)->state, &(int){from}, to)
+#else
+#define CHANGE_STATE(slot, from, to) \
+    __sync_bool_compare_and_swap (&(slot)->state, from, to)
+#endif
+
+// Number of slot generations that fit to a positive tag
+#define TAG_GENERATIONS (0x7FFFFFFF / COMPLETION_SLOTS)
+
+enum completion_state
+{
+    slot_free = 0,
+    slot_pending,
+    // Result is being stored by the completing thread
+    slot_completing,
+    slot_done,
+    // Released by the late completion
+    slot_cancelled
+};
+
+// Channel that receives the result of the read
+static void completion_class_func (void *data,
+                                   const struct context_rmcios *context,
+                                   int id,
+                                   enum function_rmcios function,
+                                   enum type_rmcios paramtype,
+                                   struct combo_rmcios *returnv,
+                                   int num_params,
+                                   union param_rmcios param)
+{
+    struct completion_slot_rmcios *slot =
+        (struct completion_slot_rmcios *) data;
+    struct completion_rmcios *result = &slot->result;
+
+    if (function != write_rmcios)
+    {
+        return;
+    }
+    if (!CHANGE_STATE (slot, slot_pending, slot_completing))
+    {
+        // Late completion of cancelled read frees the slot.
+        CHANGE_STATE (slot, slot_cancelled, slot_free);
+        return;
+    }
+
+    if (num_params < 1)
+    {
+        // Completion without data
+        result->type = 0;
+    }
+    else
+    {
+        switch (result->type)
+        {
+        case float_rmcios:
+            result->fvalue = param_to_float (context, paramtype, param, 0);
+            break;
+        case int_rmcios:
+            result->ivalue = param_to_integer (context, paramtype, param, 0);
+            break;
+        default:
+            {
+                int i;
+                const char *s = param_to_string (context, paramtype, param,
+                                                 0, COMPLETION_STR_SIZE,
+                                                 result->str);
+                for (i = 0; i < COMPLETION_STR_SIZE - 1 && s[i] != 0; i++)
+                {
+                    result->str[i] = s[i];
+                }
+                result->str[i] = 0;
+                result->length = i;
+                break;
+            }
+        }
+    }
+
+    if (slot->callback != 0)
+    {
+        slot->callback (slot->user_data, result);
+        slot->state = slot_free;
+    }
+    else
+    {
+        slot->state = slot_done;
+    }
+}
+
+int completion_queue_init (struct completion_queue_rmcios *queue,
+                           const struct context_rmcios *context)
+{
+    int i;
+    queue->context = context;
+    queue->num_slots = 0;
+    for (i = 0; i < COMPLETION_SLOTS; i++)
+    {
+        struct completion_slot_rmcios *slot = queue->slots + queue->num_slots;
+        slot->queue = queue;
+        slot->state = slot_free;
+        slot->generation = 0;
+        slot->callback = 0;
+        slot->user_data = 0;
+        slot->slot_channel = create_channel (context, 0, 0,
+                                             completion_class_func, slot);
+        if (slot->slot_channel == 0)
+        {
+            break;
+        }
+        queue->num_slots++;
+    }
+    return queue->num_slots;
+}
+
+// Claim free slot for a new read. Returns 0 when all slots are in use.
+static struct completion_slot_rmcios *claim_slot (struct
+                                                  completion_queue_rmcios
+                                                  *queue, int channel,
+                                                  enum type_rmcios type,
+                                                  completion_func_rmcios
+                                                  callback, void *user_data)
+{
+    int i;
+    for (i = 0; i < queue->num_slots; i++)
+    {
+        struct completion_slot_rmcios *slot = queue->slots + i;
+        if (CHANGE_STATE (slot, slot_free, slot_pending))
+        {
+            slot->callback = callback;
+            slot->user_data = user_data;
+            // Tags of earlier reads of the slot no longer match
+            slot->generation = (slot->generation + 1) % TAG_GENERATIONS;
+            slot->result.tag = slot->generation * COMPLETION_SLOTS + i;
+            slot->result.channel = channel;
+            slot->result.type = type;
+            slot->result.ivalue = 0;
+            slot->result.fvalue = 0;
+            slot->result.str[0] = 0;
+            slot->result.length = 0;
+            return slot;
+        }
+    }
+    return 0;
+}
+
+int completion_read_f (struct completion_queue_rmcios *queue, int channel,
+                       completion_func_rmcios callback, void *user_data)
+{
+    struct completion_slot_rmcios *slot =
+        claim_slot (queue, channel, float_rmcios, callback, user_data);
+    if (slot == 0)
+    {
+        return -1;
+    }
+    read_async_f (queue->context, channel, slot->slot_channel);
+    return slot->result.tag;
+}
+
+int completion_read_i (struct completion_queue_rmcios *queue, int channel,
+                       completion_func_rmcios callback, void *user_data)
+{
+    struct completion_slot_rmcios *slot =
+        claim_slot (queue, channel, int_rmcios, callback, user_data);
+    if (slot == 0)
+    {
+        return -1;
+    }
+    read_async_i (queue->context, channel, slot->slot_channel);
+    return slot->result.tag;
+}
+
+int completion_read_str (struct completion_queue_rmcios *queue, int channel,
+                         completion_func_rmcios callback, void *user_data)
+{
+    struct completion_slot_rmcios *slot =
+        claim_slot (queue, channel, buffer_rmcios, callback, user_data);
+    if (slot == 0)
+    {
+        return -1;
+    }
+    read_async_str (queue->context, channel, slot->slot_channel);
+    return slot->result.tag;
+}
+
+int completion_poll (struct completion_queue_rmcios *queue,
+                     struct completion_rmcios *result)
+{
+    int i;
+    for (i = 0; i < queue->num_slots; i++)
+    {
+        struct completion_slot_rmcios *slot = queue->slots + i;
+        if (slot->state == slot_done)
+        {
+            *result = slot->result;
+            slot->state = slot_free;
+            return result->tag;
+        }
+    }
+    return -1;
+}
+
+int completion_cancel (struct completion_queue_rmcios *queue, int tag)
+{
+    struct completion_slot_rmcios *slot;
+    if (tag < 0 || tag % COMPLETION_SLOTS >= queue->num_slots)
+    {
+        return -1;
+    }
+    slot = queue->slots + tag % COMPLETION_SLOTS;
+    if (slot->result.tag != tag)
+    {
+        // Slot has been reused for a newer read
+        return -1;
+    }
+    if (CHANGE_STATE (slot, slot_pending, slot_cancelled)
+        || CHANGE_STATE (slot, slot_done, slot_free))
+    {
+        return 0;
+    }
+    return -1;
+}
+
+int completion_pending (struct completion_queue_rmcios *queue)
+{
+    int i;
+    int pending = 0;
+    for (i = 0; i < queue->num_slots; i++)
+    {
+        int state = queue->slots[i].state;
+        if (state == slot_pending || state == slot_completing)
+        {
+            pending++;
+        }
+    }
+    return pending;
+}
@@ -0,0 +1,169 @@
+/*
+RMCIOS - Reactive Multipurpose Control Input Output System
+Copyright (c) 2018 Frans Korhonen
+
+RMCIOS was originally developed at Institute for Atmospheric 
+and Earth System Research / Physics, Faculty of Science, 
+University of Helsinki, Finland
+
+Assistance, experience and feedback from following persons have been 
+critical for development of RMCIOS: Erkki Siivola, Juha Kangasluoma, 
+Lauri Ahonen, Ella Häkkinen, Pasi Aalto, Joonas Enroth, Runlong Cai, 
+Markku Kulmala and Tuukka Petäjä.
+
+This file is part of RMCIOS. This notice was encoded using utf-8.
+
+RMCIOS is free software: you can redistribute this file and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RMCIOS is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public Licenses
+along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file RMCIOS-completion.h
+ * @author Frans Korhonen
+ * @brief Completion queue for asynchronous channel reads.
+ *
+ * Queue owns a fixed set of completion slots. Each slot is an unnamed 
+ * channel that is given as return channel for read_async_* calls. 
+ * Results are collected with completion_poll() or delivered to a 
+ * callback function.
+ *
+ * Slots are claimed and polled by a single thread. 
+ * Channels may complete the reads from any thread.
+ *
+ * Changelog: (date,who,description)
+ *
+ * */
+#ifndef rmcios_completion_h
+#define rmcios_completion_h
+
+#include "RMCIOS-API.h"
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L \
+    && !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+#define COMPLETION_STATE_TYPE atomic_int
+#else
+#define COMPLETION_STATE_TYPE volatile int
+#endif
+
+/// Number of reads that can be pending at the same time
+#ifndef COMPLETION_SLOTS
+#define COMPLETION_SLOTS 32
+#endif
+
+/// Maximum size of string result (including NULL-termination)
+#ifndef COMPLETION_STR_SIZE
+#define COMPLETION_STR_SIZE 64
+#endif
+
+/// @brief Result of completed read
+struct completion_rmcios
+{
+    /// Tag returned when the read was started. 
+    /// Slot index and generation of the slot.
+    int tag;
+    /// Channel that was read
+    int channel;
+    /// Type of returned value. 0 on completion without data.
+    enum type_rmcios type;
+    int ivalue;
+    float fvalue;
+    /// NULL-terminated string value.
+    char str[COMPLETION_STR_SIZE];
+    int length;
+};
+
+/// @brief Callback for completed reads
+/// Called from the thread that completes the read.
+typedef void (*completion_func_rmcios) (void *user_data,
+                                        const struct completion_rmcios *
+                                        result);
+
+struct completion_queue_rmcios;
+
+/// @brief Completion slot
+struct completion_slot_rmcios
+{
+    struct completion_queue_rmcios *queue;
+    /// Channel that receives the result.
+    int slot_channel;
+    COMPLETION_STATE_TYPE state;
+    /// Incremented when the slot is claimed. Part of the tag.
+    int generation;
+    completion_func_rmcios callback;
+    void *user_data;
+    struct completion_rmcios result;
+};
+
+/// @brief Completion queue
+struct completion_queue_rmcios
+{
+    const struct context_rmcios *context;
+    int num_slots;
+    struct completion_slot_rmcios slots[COMPLETION_SLOTS];
+};
+
+/// @brief Initialize completion queue. 
+///
+/// Creates channels for the completion slots.
+/// @param queue pointer to queue to be initialized
+/// @param context pointer to target system context
+/// @return Number of usable slots.
+int completion_queue_init (struct completion_queue_rmcios *queue,
+                           const struct context_rmcios *context);
+
+/// @brief Start asynchronous read of float value.
+///
+/// @param queue completion queue
+/// @param channel channel to be read
+/// @param callback function called on completion.
+///        0 to collect the result with completion_poll()
+/// @param user_data pointer given to @p callback
+/// @return tag of the read. -1 when all slots are in use.
+int completion_read_f (struct completion_queue_rmcios *queue, int channel,
+                       completion_func_rmcios callback, void *user_data);
+
+/// @brief Start asynchronous read of integer value.
+/// @see completion_read_f
+int completion_read_i (struct completion_queue_rmcios *queue, int channel,
+                       completion_func_rmcios callback, void *user_data);
+
+/// @brief Start asynchronous read of string.
+/// @see completion_read_f
+int completion_read_str (struct completion_queue_rmcios *queue, int channel,
+                         completion_func_rmcios callback, void *user_data);
+
+/// @brief Get completed read result.
+///
+/// Releases the slot of the returned read.
+/// @param queue completion queue
+/// @param result pointer to structure to be filled with the result
+/// @return tag of the completed read. -1 when no read has completed.
+int completion_poll (struct completion_queue_rmcios *queue,
+                     struct completion_rmcios *result);
+
+/// @brief Cancel read.
+///
+/// Result of the read is discarded. Slot of a pending read is 
+/// released when the channel completes the read. Until then the slot
+/// is not reused, so late result is never mistaken for a newer read.
+/// Tags of earlier reads of a reused slot do not match the new read.
+/// @param queue completion queue
+/// @param tag tag returned when the read was started
+/// @return 0 on success. -1 when @p tag is not pending or completed.
+int completion_cancel (struct completion_queue_rmcios *queue, int tag);
+
+/// @brief Get number of reads that have not completed.
+int completion_pending (struct completion_queue_rmcios *queue);
+
+#endif
@@ -29,6 +29,20 @@ along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "RMCIOS-functions.h"
 
+// Slots of element plan table are accessed from concurrent conversions
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L \
+    && !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+typedef _Atomic (convert_func_rmcios) plan_slot_rmcios;
+#define LOAD_PLAN(slot) atomic_load_explicit (&(slot), memory_order_relaxed)
+#define STORE_PLAN(slot, plan) \
+    atomic_store_explicit (&(slot), plan, memory_order_relaxed)
+#else
+typedef convert_func_rmcios volatile plan_slot_rmcios;
+#define LOAD_PLAN(slot) (slot)
+#define STORE_PLAN(slot, plan) ((slot) = (plan))
+#endif
+
 // ****************************************************************
 // Channel system implementation:
 // ****************************************************************
@@ -36,29 +50,27 @@ along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
 #define NAN 0.0/0.0
 #endif
 
+// Maximum length of function name handled by param_to_function
+#define FUNCTION_NAME_MAX 16
+
+// Number of combo parameter arrays run_param_subset slices on stack
+#define PARAM_SUBSET_COMBOS 8
+
 // Pattern for searching functions in the system
+#define FUNCTION_PATTERN(name, function) name, (const char *) function,
 const char *function_enum_pattern[] = {
-    "help", (const char *) help_rmcios,
-    "create", (const char *) create_rmcios,
-    "setup", (const char *) setup_rmcios,
-    "write", (const char *) write_rmcios,
-    "read", (const char *) read_rmcios,
-
-    // Legacy command: (reset is now triggered with empty write)
-    "reset", (const char *) write_rmcios,
-    // Legacy command: 
-    // (replaced with link -channel -> write link channel to_channel)
-    "link", (const char *) link_rmcios,
-    // Legacy name for setup: (setup is short enough by itelf)
-    "conf", (const char *) setup_rmcios
+    FUNCTION_NAMES_RMCIOS (FUNCTION_PATTERN)
 };
+#undef FUNCTION_PATTERN
 
 int function_detect (const char *name, unsigned int length)
 {
     int func_i;
     int i;
 
-    for (func_i = 0; func_i < 16; func_i += 2)
+    for (func_i = 0; func_i < (int) (sizeof (function_enum_pattern)
+                                     / sizeof (function_enum_pattern[0]));
+         func_i += 2)
     {
         const char *function = function_enum_pattern[func_i];
         for (i = 0; i < length; i++)
@@ -214,7 +226,21 @@ void run_param_subset( const struct context_rmcios *context, int channel,
         {
             int i;
             int new_combo_length = combo_length - combo_index;
-            struct combo_rmcios combo_params[new_combo_length];
+            struct combo_rmcios local_combos[PARAM_SUBSET_COMBOS];
+            struct combo_rmcios *combo_params = local_combos;
+
+            // Long combo lists are sliced on allocated memory to keep
+            // stack usage bounded.
+            if (new_combo_length > PARAM_SUBSET_COMBOS)
+            {
+                combo_params = (struct combo_rmcios *)
+                    allocate_storage (context, new_combo_length *
+                                      sizeof (struct combo_rmcios), 0);
+                if (combo_params == 0)
+                {
+                    return;
+                }
+            }
 
             // Slice down dirst parameter
             struct combo_rmcios first_param= {
@@ -237,6 +263,11 @@ void run_param_subset( const struct context_rmcios *context, int channel,
 
             // Run given channel with the sliced parameter set
             run_channel (context, channel, function, paramtype, returnv, num_params - start_index, (union param_rmcios)combo_params);
+
+            if (combo_params != local_combos)
+            {
+                free_storage (context, combo_params, 0);
+            }
         }
     }
     else
@@ -300,8 +331,9 @@ int create_subchannel_str (const struct context_rmcios *context,
     }
     // Get length of suffix part
     for (suffixlen = 0; suffix_str[suffixlen] != 0; suffixlen++);
-    // Get length of channel name
-    namelen = channel_name (context, channel, 0, 0);
+    // Get channel name. Borrowed when name channel lends it.
+    struct buffer_rmcios name = channel_name_borrow (context, channel, 0, 0);
+    namelen = name.required_size;
     {
         int i;
         char *subchannel_name =
@@ -311,7 +343,15 @@ int create_subchannel_str (const struct context_rmcios *context,
             return 0;
         }
         // Get orginal channel name
-        channel_name (context, channel, subchannel_name, namelen + 1);
+        if (name.data != 0 && name.length == (unsigned int) namelen)
+        {
+            for (i = 0; i < namelen; i++)
+                subchannel_name[i] = name.data[i];
+        }
+        else
+        {
+            channel_name (context, channel, subchannel_name, namelen + 1);
+        }
         char *pname;
         pname = subchannel_name + namelen;
         for (i = 0; i < suffixlen; i++)
@@ -325,6 +365,353 @@ int create_subchannel_str (const struct context_rmcios *context,
     }
 }
 
+// ***********************************************************************
+// Text representation of 64-bit integer and double values.
+// Made locally: convert channels of older systems do not know them.
+// ***********************************************************************
+
+// Format integer to buffer of at least 21 bytes. Returns length.
+static int format_int64 (long long value, char *text)
+{
+    char digits[20];
+    unsigned long long magnitude = (value < 0) ?
+        0ULL - (unsigned long long) value : (unsigned long long) value;
+    int count = 0;
+    int length = 0;
+    do
+    {
+        digits[count++] = '0' + (char) (magnitude % 10);
+        magnitude /= 10;
+    }
+    while (magnitude != 0);
+    if (value < 0)
+    {
+        text[length++] = '-';
+    }
+    while (count > 0)
+    {
+        text[length++] = digits[--count];
+    }
+    return length;
+}
+
+// Format double with 15 significant digits to buffer of at least 32 bytes.
+// Returns length.
+static int format_double (double value, char *text)
+{
+    const char *special = 0;
+    char digits[15];
+    long long mantissa;
+    int exponent = 0;
+    int length = 0;
+    int count;
+    int i;
+
+    if (value != value)
+    {
+        special = "nan";
+    }
+    else
+    {
+        if (value < 0)
+        {
+            text[length++] = '-';
+            value = -value;
+        }
+        if (value > 1.7976931348623157e308)
+        {
+            special = "inf";
+        }
+    }
+    if (special != 0)
+    {
+        for (i = 0; special[i] != 0; i++)
+        {
+            text[length++] = special[i];
+        }
+        return length;
+    }
+    if (value < 1e18 && value == (double) (long long) value)
+    {
+        return length + format_int64 ((long long) value, text + length);
+    }
+
+    // Scale to 1 <= value < 10
+    while (value >= 1e16)
+    {
+        value /= 1e16;
+        exponent += 16;
+    }
+    while (value >= 10)
+    {
+        value /= 10;
+        exponent++;
+    }
+    while (value < 1e-16)
+    {
+        value *= 1e16;
+        exponent -= 16;
+    }
+    while (value < 1)
+    {
+        value *= 10;
+        exponent--;
+    }
+    mantissa = (long long) (value * 1e14 + 0.5);
+    if (mantissa >= 1000000000000000LL)
+    {
+        mantissa /= 10;
+        exponent++;
+    }
+    // Significant digits without trailing zeros
+    for (count = 15; count > 1 && mantissa % 10 == 0; count--)
+    {
+        mantissa /= 10;
+    }
+    for (i = count - 1; i >= 0; i--)
+    {
+        digits[i] = '0' + (char) (mantissa % 10);
+        mantissa /= 10;
+    }
+
+    if (exponent < -5 || exponent >= 15)
+    {
+        text[length++] = digits[0];
+        if (count > 1)
+        {
+            text[length++] = '.';
+        }
+        for (i = 1; i < count; i++)
+        {
+            text[length++] = digits[i];
+        }
+        text[length++] = 'e';
+        length += format_int64 (exponent, text + length);
+    }
+    else if (exponent < 0)
+    {
+        text[length++] = '0';
+        text[length++] = '.';
+        for (i = -1; i > exponent; i--)
+        {
+            text[length++] = '0';
+        }
+        for (i = 0; i < count; i++)
+        {
+            text[length++] = digits[i];
+        }
+    }
+    else
+    {
+        for (i = 0; i < count || i <= exponent; i++)
+        {
+            if (i == exponent + 1)
+            {
+                text[length++] = '.';
+            }
+            text[length++] = (i < count) ? digits[i] : '0';
+        }
+    }
+    return length;
+}
+
+// Parse decimal number from text.
+// @p integer is exact for integer text. Otherwise it is truncated @p real.
+// Returns 0 when text does not start with a number.
+static int parse_number (const char *text, int length,
+                         long long *integer, double *real)
+{
+    unsigned long long mantissa = 0;
+    int exponent = 0;
+    int negative = 0;
+    int digits = 0;
+    int exact = 1;
+    int i = 0;
+    double scale;
+
+    while (i < length && (text[i] == ' ' || text[i] == '\t'))
+    {
+        i++;
+    }
+    if (i < length && (text[i] == '-' || text[i] == '+'))
+    {
+        negative = (text[i++] == '-');
+    }
+    for (; i < length && text[i] >= '0' && text[i] <= '9'; i++, digits++)
+    {
+        if (mantissa < 100000000000000000ULL)
+        {
+            mantissa = mantissa * 10 + (text[i] - '0');
+        }
+        else
+        {
+            exponent++;
+            exact = 0;
+        }
+    }
+    if (i < length && text[i] == '.')
+    {
+        exact = 0;
+        for (i++; i < length && text[i] >= '0' && text[i] <= '9';
+             i++, digits++)
+        {
+            if (mantissa < 100000000000000000ULL)
+            {
+                mantissa = mantissa * 10 + (text[i] - '0');
+                exponent--;
+            }
+        }
+    }
+    if (digits == 0)
+    {
+        return 0;
+    }
+    if (i < length && (text[i] == 'e' || text[i] == 'E'))
+    {
+        int exponent_negative = 0;
+        int value = 0;
+        i++;
+        if (i < length && (text[i] == '-' || text[i] == '+'))
+        {
+            exponent_negative = (text[i++] == '-');
+        }
+        for (; i < length && text[i] >= '0' && text[i] <= '9'; i++)
+        {
+            if (value < 10000)
+            {
+                value = value * 10 + (text[i] - '0');
+            }
+        }
+        exponent += exponent_negative ? -value : value;
+        exact = 0;
+    }
+
+    // Power of ten is exact up to 1e22
+    scale = 1;
+    for (i = (exponent < 0) ? -exponent : exponent; i > 0; i--)
+    {
+        scale *= 10;
+    }
+    *real = (exponent < 0) ? mantissa / scale : mantissa * scale;
+    if (negative)
+    {
+        *real = -*real;
+    }
+    if (exact)
+    {
+        *integer = negative ? -(long long) mantissa : (long long) mantissa;
+    }
+    else
+    {
+        *integer = (long long) *real;
+    }
+    return 1;
+}
+
+// Store text to return buffer. NULL-terminated when there is room.
+static void store_text (struct buffer_rmcios *dst,
+                        const char *text, unsigned int length)
+{
+    unsigned int i;
+    dst->required_size = length;
+    if (dst->size == 0 || dst->data == 0)
+    {
+        // No room for the text: only the required size is known.
+        dst->length = 0;
+        dst->trailing_size = 0;
+        return;
+    }
+    dst->length = (length < dst->size) ? length : dst->size;
+    for (i = 0; i < dst->length; i++)
+    {
+        dst->data[i] = text[i];
+    }
+    if (dst->length < dst->size)
+    {
+        dst->data[dst->length] = 0;
+        dst->trailing_size = 1;
+    }
+    else
+    {
+        dst->trailing_size = 0;
+    }
+}
+
+static int convert_local (const struct context_rmcios *context,
+                          enum type_rmcios from, union param_rmcios param,
+                          int index, struct combo_rmcios *returnv);
+
+// Write value to return parameter through the convert channel.
+// 64-bit integer, double and inline returns are filled without the convert
+// channel when possible.
+static void convert_return (const struct context_rmcios *context,
+                            enum type_rmcios paramtype,
+                            struct combo_rmcios *returnv,
+                            union param_rmcios value)
+{
+    struct combo_rmcios copy_return;
+    if (returnv->paramtype == borrowed_rmcios)
+    {
+        // Value is copied to the borrowing return buffer
+        copy_return = *returnv;
+        copy_return.paramtype = buffer_rmcios;
+        returnv = &copy_return;
+    }
+    if (convert_local (context, paramtype, value, 0, returnv))
+    {
+        return;
+    }
+    if (returnv->paramtype == inline_rmcios)
+    {
+        struct inline_rmcios *sreturn = returnv->param.inv;
+        struct buffer_rmcios breturn = {
+            .data = sreturn->data,
+            .length = 0,
+            .size = INLINE_BUFFER_SIZE,
+            .required_size = 0,
+            .trailing_size = 0
+        };
+        struct combo_rmcios buffer_return = {
+            .paramtype = buffer_rmcios,
+            .num_params = 1,
+            .param.bv = &breturn,
+            .next = 0
+        };
+        if (paramtype == buffer_rmcios || paramtype == binary_rmcios)
+        {
+            unsigned int i;
+            breturn.length = value.bv->length;
+            if (breturn.length > INLINE_BUFFER_SIZE)
+            {
+                breturn.length = INLINE_BUFFER_SIZE;
+            }
+            for (i = 0; i < breturn.length; i++)
+            {
+                sreturn->data[i] = value.bv->data[i];
+            }
+        }
+        else
+        {
+            // Leave room for the terminator written by the convert channel
+            breturn.size = INLINE_BUFFER_SIZE - 1;
+            run_channel (context, context->convert, write_rmcios, paramtype,
+                         &buffer_return, 1, value);
+            if (breturn.length > breturn.size)
+            {
+                breturn.length = breturn.size;
+            }
+        }
+        sreturn->length = breturn.length;
+        if (sreturn->length < INLINE_BUFFER_SIZE)
+        {
+            sreturn->data[sreturn->length] = 0;
+        }
+        return;
+    }
+    run_channel (context, context->convert, write_rmcios, paramtype,
+                 returnv, 1, value);
+}
+
 void return_int (const struct context_rmcios *context,
                  struct combo_rmcios *returnv, int value)
 {
@@ -332,8 +719,8 @@ void return_int (const struct context_rmcios *context,
     {
         return;
     }
-    run_channel (context, context->convert, write_rmcios, int_rmcios, returnv,
-                 1, (union param_rmcios) (&value));
+    convert_return (context, int_rmcios, returnv,
+                    (union param_rmcios) (&value));
 }
 
 void return_float (const struct context_rmcios *context,
@@ -343,8 +730,30 @@ void return_float (const struct context_rmcios *context,
     {
         return;
     }
-    run_channel (context, context->convert, write_rmcios, float_rmcios,
-                 returnv, 1, (union param_rmcios) (&value));
+    convert_return (context, float_rmcios, returnv,
+                    (union param_rmcios) (&value));
+}
+
+void return_int64 (const struct context_rmcios *context,
+                   struct combo_rmcios *returnv, long long value)
+{
+    if (returnv == 0 || returnv->num_params == 0)
+    {
+        return;
+    }
+    convert_return (context, int64_rmcios, returnv,
+                    (union param_rmcios) (&value));
+}
+
+void return_double (const struct context_rmcios *context,
+                    struct combo_rmcios *returnv, double value)
+{
+    if (returnv == 0 || returnv->num_params == 0)
+    {
+        return;
+    }
+    convert_return (context, double_rmcios, returnv,
+                    (union param_rmcios) (&value));
 }
 
 void return_string (const struct context_rmcios *context,
@@ -364,8 +773,8 @@ void return_string (const struct context_rmcios *context,
     {
         return;
     }
-    run_channel (context, context->convert, write_rmcios, buffer_rmcios,
-                 returnv, 1, (union param_rmcios) (&value));
+    convert_return (context, buffer_rmcios, returnv,
+                    (union param_rmcios) (&value));
 }
 
 void return_buffer (const struct context_rmcios *context,
@@ -384,8 +793,123 @@ void return_buffer (const struct context_rmcios *context,
     {
         return;
     }
-    run_channel (context, context->convert, write_rmcios, buffer_rmcios,
-                 returnv, 1, (union param_rmcios) (&value));
+    convert_return (context, buffer_rmcios, returnv,
+                    (union param_rmcios) (&value));
+}
+
+void lend_buffer (const struct context_rmcios *context,
+                  struct combo_rmcios *returnv,
+                  const char *buffer, unsigned int length)
+{
+    struct buffer_rmcios *breturn;
+    if (returnv == 0 || returnv->num_params == 0)
+    {
+        return;
+    }
+    if (returnv->paramtype != borrowed_rmcios)
+    {
+        return_buffer (context, returnv, buffer, length);
+        return;
+    }
+    breturn = returnv->param.bv;
+    breturn->data = (char *) buffer;
+    breturn->length = length;
+    breturn->size = 0;
+    breturn->required_size = length;
+    breturn->trailing_size = 0;
+}
+
+void lend_string (const struct context_rmcios *context,
+                  struct combo_rmcios *returnv, const char *string)
+{
+    int length;
+    for (length = 0; string[length] != 0; length++);
+
+    if (returnv != 0 && returnv->num_params > 0
+        && returnv->paramtype == borrowed_rmcios)
+    {
+        lend_buffer (context, returnv, string, length);
+        returnv->param.bv->trailing_size = 1;
+    }
+    else
+    {
+        return_string (context, returnv, string);
+    }
+}
+
+long long *chunk_cursor (struct combo_rmcios *returnv)
+{
+    struct combo_rmcios *cursor;
+    if (returnv == 0 || returnv->num_params == 0
+        || (returnv->paramtype != buffer_rmcios
+            && returnv->paramtype != binary_rmcios)
+        || (returnv->param.bv->flags & buffer_chunked_rmcios) == 0)
+    {
+        return 0;
+    }
+    cursor = returnv->next;
+    if (cursor == 0 || cursor->paramtype != int64_rmcios
+        || cursor->num_params == 0)
+    {
+        return 0;
+    }
+    return cursor->param.lv;
+}
+
+void return_chunk (const struct context_rmcios *context,
+                   struct combo_rmcios *returnv,
+                   const char *buffer, unsigned int length,
+                   long long cursor)
+{
+    long long *pcursor = chunk_cursor (returnv);
+    struct buffer_rmcios *breturn;
+    unsigned int i;
+
+    if (pcursor == 0)
+    {
+        return_buffer (context, returnv, buffer, length);
+        return;
+    }
+    breturn = returnv->param.bv;
+    if (length > breturn->size)
+    {
+        length = breturn->size;
+    }
+    for (i = 0; i < length; i++)
+    {
+        breturn->data[i] = buffer[i];
+    }
+    breturn->length = length;
+    breturn->required_size = length;
+    breturn->flags &= ~buffer_chunked_rmcios;
+    *pcursor = cursor;
+}
+
+void return_buffer_chunked (const struct context_rmcios *context,
+                            struct combo_rmcios *returnv,
+                            const char *buffer, unsigned int length)
+{
+    long long *pcursor = chunk_cursor (returnv);
+    long long offset;
+    unsigned int chunk;
+
+    if (pcursor == 0)
+    {
+        return_buffer (context, returnv, buffer, length);
+        return;
+    }
+    offset = *pcursor;
+    if (offset < 0 || offset > length)
+    {
+        offset = length;
+    }
+    chunk = length - (unsigned int) offset;
+    if (chunk > returnv->param.bv->size)
+    {
+        chunk = returnv->param.bv->size;
+    }
+    return_chunk (context, returnv, buffer + offset, chunk,
+                  (offset + chunk < length) ? offset + chunk : 0);
 }
 
 void return_binary (const struct context_rmcios *context,
@@ -404,8 +928,8 @@ void return_binary (const struct context_rmcios *context,
     {
         return;
     }
-    run_channel (context, context->convert, write_rmcios, binary_rmcios,
-                 returnv, 1, (union param_rmcios) (&value));
+    convert_return (context, binary_rmcios, returnv,
+                    (union param_rmcios) (&value));
 }
 
 void return_void (const struct context_rmcios *context,
@@ -428,11 +952,77 @@ void return_void (const struct context_rmcios *context,
     }
 }
 
+// View inline parameter as read only buffer
+static struct buffer_rmcios inline_view (const struct inline_rmcios *param)
+{
+    struct buffer_rmcios view = {
+        .data = (char *) param->data,
+        .length = param->length,
+        .size = 0,
+        .required_size = param->length,
+        .trailing_size = (param->length < INLINE_BUFFER_SIZE) ? 1 : 0
+    };
+    return view;
+}
+
+// Resolve combo parameters and array elements to the referred parameter.
+static void resolve_element (enum type_rmcios *paramtype,
+                             union param_rmcios *params, int *index)
+{
+    while (params->p != 0)
+    {
+        if (*paramtype == array_rmcios)
+        {
+            // Convert the referred element
+            *params = array_element (*params, *index, paramtype);
+            *index = 0;
+        }
+        else if (*paramtype == combo_rmcios)
+        {
+            const struct combo_rmcios *combo = params->cv;
+            while (*index >= combo->num_params)
+            {
+                *index -= combo->num_params;
+                combo++;
+            }
+            *paramtype = combo->paramtype;
+            *params = combo->param;
+        }
+        else
+        {
+            if (*paramtype == moved_rmcios)
+            {
+                // Moved buffer is binary to receivers that do not take it
+                *paramtype = binary_rmcios;
+            }
+            return;
+        }
+    }
+}
+
+// Resolve combo parameters, array elements and inline strings to types
+// known by the convert channel. Inline strings are viewed through @p view.
+static void resolve_param (enum type_rmcios *paramtype,
+                           union param_rmcios *params, int *index,
+                           struct buffer_rmcios *view)
+{
+    resolve_element (paramtype, params, index);
+    if (*paramtype == inline_rmcios && params->p != 0)
+    {
+        *view = inline_view (params->inv + *index);
+        *paramtype = buffer_rmcios;
+        params->bv = view;
+        *index = 0;
+    }
+}
+
 float param_to_float (const struct context_rmcios *context,
                       enum type_rmcios paramtype,
                       union param_rmcios params, int index)
 {
     float retfloat = 0.0 / 0.0; // NAN
+    struct buffer_rmcios view;
+    resolve_param (&paramtype, &params, &index, &view);
     if (params.p == 0)
     {
         return retfloat;
@@ -444,8 +1034,11 @@ float param_to_float (const struct context_rmcios *context,
         .next = 0
     };
 
-    run_channel (context, context->convert, read_rmcios, paramtype, &returnv,
-                 index + 1, params);
+    if (!convert_local (context, paramtype, params, index, &returnv))
+    {
+        run_channel (context, context->convert, read_rmcios, paramtype,
+                     &returnv, index + 1, params);
+    }
     return retfloat;
 }
 
@@ -454,6 +1047,8 @@ int param_to_integer (const struct context_rmcios *context,
                       union param_rmcios params, int index)
 {
     int retint = 0;
+    struct buffer_rmcios view;
+    resolve_param (&paramtype, &params, &index, &view);
     if (params.cp == 0)
     {
         return retint;
@@ -464,16 +1059,71 @@ int param_to_integer (const struct context_rmcios *context,
         .param = {&retint},
         .next = 0
     };
-    run_channel (context, context->convert, read_rmcios, paramtype, &returnv,
-                 index + 1, params);
+    if (!convert_local (context, paramtype, params, index, &returnv))
+    {
+        run_channel (context, context->convert, read_rmcios, paramtype,
+                     &returnv, index + 1, params);
+    }
+    return retint;
+}
+
+long long param_to_int64 (const struct context_rmcios *context,
+                          enum type_rmcios paramtype,
+                          union param_rmcios params, int index)
+{
+    long long retint = 0;
+    struct buffer_rmcios view;
+    resolve_param (&paramtype, &params, &index, &view);
+    if (params.cp == 0)
+    {
+        return retint;
+    }
+    struct combo_rmcios returnv = {
+        .paramtype = int64_rmcios,
+        .num_params = 1,
+        .param.lv = &retint,
+        .next = 0
+    };
+    if (!convert_local (context, paramtype, params, index, &returnv))
+    {
+        run_channel (context, context->convert, read_rmcios, paramtype,
+                     &returnv, index + 1, params);
+    }
     return retint;
 }
 
+double param_to_double (const struct context_rmcios *context,
+                        enum type_rmcios paramtype,
+                        union param_rmcios params, int index)
+{
+    double retdouble = 0.0 / 0.0;       // NAN
+    struct buffer_rmcios view;
+    resolve_param (&paramtype, &params, &index, &view);
+    if (params.p == 0)
+    {
+        return retdouble;
+    }
+    struct combo_rmcios returnv = {
+        .paramtype = double_rmcios,
+        .num_params = 1,
+        .param.dv = &retdouble,
+        .next = 0
+    };
+    if (!convert_local (context, paramtype, params, index, &returnv))
+    {
+        run_channel (context, context->convert, read_rmcios, paramtype,
+                     &returnv, index + 1, params);
+    }
+    return retdouble;
+}
+
 int param_to_channel (const struct context_rmcios *context,
                       enum type_rmcios paramtype,
                       union param_rmcios params, int index)
 {
     int ireturn = 0;
+    struct buffer_rmcios view;
+    resolve_param (&paramtype, &params, &index, &view);
     struct combo_rmcios returnv = {
         .paramtype = int_rmcios,
         .num_params = 1,
@@ -490,6 +1140,8 @@ int param_to_int (const struct context_rmcios *context,
                   union param_rmcios params, int index)
 {
     int ireturn = 0;
+    struct buffer_rmcios view;
+    resolve_param (&paramtype, &params, &index, &view);
     struct combo_rmcios returnv = {
         .paramtype = int_rmcios,
         .num_params = 1,
@@ -501,8 +1153,11 @@ int param_to_int (const struct context_rmcios *context,
 
     if (ireturn == 0)
     {
-        run_channel (context, context->convert, read_rmcios, paramtype,
-                     &returnv, index + 1, params);
+        if (!convert_local (context, paramtype, params, index, &returnv))
+        {
+            run_channel (context, context->convert, read_rmcios, paramtype,
+                         &returnv, index + 1, params);
+        }
     }
     return ireturn;
 }
@@ -530,6 +1185,118 @@ int copy_mem_safe (char *src, int src_len, char *dst, int dst_len)
     }
 }
 
+// Inline short strings:
+struct inline_rmcios make_inline (const char *data, int length)
+{
+    struct inline_rmcios str;
+    int i;
+    if (length < 0)
+    {
+        // NULL-terminated string
+        for (length = 0; data[length] != 0; length++);
+    }
+    if (length > INLINE_BUFFER_SIZE)
+    {
+        length = INLINE_BUFFER_SIZE;
+    }
+    for (i = 0; i < length; i++)
+    {
+        str.data[i] = data[i];
+    }
+    if (length < INLINE_BUFFER_SIZE)
+    {
+        str.data[length] = 0;
+    }
+    str.length = length;
+    return str;
+}
+
+int read_inline (const struct context_rmcios *context, int channel,
+                 struct inline_rmcios *str)
+{
+    struct combo_rmcios returnv = {
+        .paramtype = inline_rmcios,
+        .num_params = 1,
+        .param.inv = str,
+        .next = 0
+    };
+    str->length = 0;
+    str->data[0] = 0;
+    run_channel (context, channel,
+                 read_rmcios, inline_rmcios,
+                 &returnv, 0, (union param_rmcios) 0);
+    return str->length;
+}
+
+// Scatter-gather buffer chains:
+int gather_length (const struct gather_rmcios *gather)
+{
+    int length = 0;
+    int i;
+    for (i = 0; i < gather->count; i++)
+    {
+        length += gather->segments[i].length;
+    }
+    return length;
+}
+
+int linearize_gather (const struct gather_rmcios *gather,
+                      char *buffer, int size)
+{
+    int length = 0;
+    int i;
+    unsigned int j;
+    for (i = 0; i < gather->count; i++)
+    {
+        const struct buffer_rmcios *segment = gather->segments + i;
+        for (j = 0; j < segment->length; j++, length++)
+        {
+            if (length < size)
+            {
+                buffer[length] = segment->data[j];
+            }
+        }
+    }
+    return length;
+}
+
+void write_gather (const struct context_rmcios *context, int channel,
+                   struct buffer_rmcios *segments, int count)
+{
+    struct gather_rmcios gather = {
+        .segments = segments,
+        .count = count
+    };
+    run_channel (context, channel, write_rmcios, gather_rmcios, 0, 1,
+                 (union param_rmcios) &gather);
+}
+
+// Linearize gather parameter to buffer.
+// Chain of single segment is returned without copy.
+static struct buffer_rmcios gather_to_buffer (const struct gather_rmcios
+                                              *gather, int maxlen,
+                                              char *buffer)
+{
+    struct buffer_rmcios breturn = {
+        .data = buffer,
+        .length = 0,
+        .size = maxlen,
+        .required_size = 0,
+        .trailing_size = 0
+    };
+    if (gather->count == 1)
+    {
+        breturn = gather->segments[0];
+        breturn.size = 0;
+        breturn.flags = 0;
+        return breturn;
+    }
+    breturn.required_size = linearize_gather (gather, buffer, maxlen);
+    breturn.length = (breturn.required_size < (unsigned int) maxlen) ?
+        breturn.required_size : (unsigned int) maxlen;
+    return breturn;
+}
+
 const char *param_to_string (const struct context_rmcios *context,
                              enum type_rmcios paramtype,
                              union param_rmcios params,
@@ -557,11 +1324,52 @@ const char *param_to_string (const struct context_rmcios *context,
         .param = {&existing_buffer}
     };
 
+    resolve_element (&paramtype, &params, &index);
+    if (paramtype == inline_rmcios)
+    {
+        const struct inline_rmcios *str = params.inv + index;
+        int i;
+        if (str->length < INLINE_BUFFER_SIZE)
+        {
+            // NULL-terminated inline data
+            return str->data;
+        }
+        if (maxlen <= 0)
+        {
+            return sreturn;
+        }
+        for (i = 0; i < str->length && i < maxlen - 1; i++)
+        {
+            to_str[i] = str->data[i];
+        }
+        to_str[i] = 0;
+        return to_str;
+    }
+
+    if (paramtype == gather_rmcios)
+    {
+        if (maxlen <= 0)
+        {
+            return sreturn;
+        }
+        breturn.length = linearize_gather (params.gv + index, to_str,
+                                           maxlen - 1);
+        if (breturn.length > (unsigned int) maxlen - 1)
+        {
+            breturn.length = maxlen - 1;
+        }
+        to_str[breturn.length] = 0;
+        return to_str;
+    }
+
     if (maxlen > 0)
     {
         // Copy data to user buffer:
-        run_channel (context, context->convert, write_rmcios, paramtype,
-                     &copy_to, index + 1, params);
+        if (!convert_local (context, paramtype, params, index, &copy_to))
+        {
+            run_channel (context, context->convert, write_rmcios, paramtype,
+                         &copy_to, index + 1, params);
+        }
 
         // Ensure trailing null:
         if (breturn.length >= breturn.size)
@@ -578,8 +1386,11 @@ const char *param_to_string (const struct context_rmcios *context,
 
     // Check if parameter is already string compatible buffer.
     // context.convert read command fills the given structure with original buffer data (if exists)
-    run_channel (context, context->convert, read_rmcios, paramtype, &fetch_to,
-                 index + 1, params);
+    if (!convert_local (context, paramtype, params, index, &fetch_to))
+    {
+        run_channel (context, context->convert, read_rmcios, paramtype,
+                     &fetch_to, index + 1, params);
+    }
     if (fetch_to.param.bv->data != 0 && fetch_to.param.bv->trailing_size > 0
         && fetch_to.param.bv->data[fetch_to.param.bv->length] == 0)
     {
@@ -613,17 +1424,33 @@ struct buffer_rmcios param_to_buffer (const struct context_rmcios *context,
         .param = {&existing_buffer}
     };
 
+    resolve_element (&paramtype, &params, &index);
+    if (paramtype == gather_rmcios)
+    {
+        return gather_to_buffer (params.gv + index, maxlen, buffer);
+    }
+    if (paramtype == inline_rmcios)
+    {
+        return inline_view (params.inv + index);
+    }
+
     if (maxlen > 0)
     {
         // Copy data to user buffer:
-        run_channel (context, context->convert, write_rmcios, paramtype,
-                     &copy_to, index + 1, params);
+        if (!convert_local (context, paramtype, params, index, &copy_to))
+        {
+            run_channel (context, context->convert, write_rmcios, paramtype,
+                         &copy_to, index + 1, params);
+        }
     }
 
     // Check if parameter is already buffer.
     // context.convert read command fills the given structure with original buffer data (if exists)
-    run_channel (context, context->convert, read_rmcios, paramtype, &fetch_to,
-                 index + 1, params);
+    if (!convert_local (context, paramtype, params, index, &fetch_to))
+    {
+        run_channel (context, context->convert, read_rmcios, paramtype,
+                     &fetch_to, index + 1, params);
+    }
 
     if (fetch_to.param.bv->data != 0)
     {
@@ -660,17 +1487,33 @@ struct buffer_rmcios param_to_binary (const struct context_rmcios *context,
         .param = {&existing_buffer}
     };
 
+    resolve_element (&paramtype, &params, &index);
+    if (paramtype == gather_rmcios)
+    {
+        return gather_to_buffer (params.gv + index, maxlen, buffer);
+    }
+    if (paramtype == inline_rmcios)
+    {
+        return inline_view (params.inv + index);
+    }
+
     if (maxlen > 0)
     {
         // Copy data to user buffer:
-        run_channel (context, context->convert, write_rmcios, paramtype,
-                     &copy_to, index + 1, params);
+        if (!convert_local (context, paramtype, params, index, &copy_to))
+        {
+            run_channel (context, context->convert, write_rmcios, paramtype,
+                         &copy_to, index + 1, params);
+        }
     }
 
     // Check if parameter is already buffer.
     // context.convert read command fills the given structure with original buffer data (if exists)
-    run_channel (context, context->convert, read_rmcios, paramtype, &fetch_to,
-                 index + 1, params);
+    if (!convert_local (context, paramtype, params, index, &fetch_to))
+    {
+        run_channel (context, context->convert, read_rmcios, paramtype,
+                     &fetch_to, index + 1, params);
+    }
 
     if (fetch_to.param.bv->data != 0)
     {
@@ -693,15 +1536,14 @@ int param_to_function (const struct context_rmcios *context,
     // Convert text to function indentifier
     if (function == 0)
     {
-        int blen = param_buffer_alloc_size (context, paramtype, param, index);
-        {
-            char buffer[blen];
-            struct buffer_rmcios fname = { 0 };
-            fname = param_to_buffer (context, paramtype,
-                                     param, index, blen, buffer);
-
-            function = function_detect (fname.data, fname.length);
-        }
+        // Function names are short. Longer names can never match,
+        // so fixed size buffer is enough.
+        char buffer[FUNCTION_NAME_MAX];
+        struct buffer_rmcios fname = { 0 };
+        fname = param_to_buffer (context, paramtype,
+                                 param, index, sizeof (buffer), buffer);
+
+        function = function_detect (fname.data, fname.length);
     }
     return function;
 }
@@ -716,10 +1558,22 @@ int param_string_length (const struct context_rmcios *context,
         .num_params = 1,
         .param = &rbuff
     };
+    resolve_element (&paramtype, &param, &index);
+    if (paramtype == gather_rmcios)
+    {
+        return gather_length (param.gv + index);
+    }
+    if (paramtype == inline_rmcios)
+    {
+        return param.inv[index].length;
+    }
     // Get required length for the parameter
     // context.convert read command fills the given structure with required size parameter
-    run_channel (context, context->convert, read_rmcios, paramtype, &returnv,
-                 index + 1, param);
+    if (!convert_local (context, paramtype, param, index, &returnv))
+    {
+        run_channel (context, context->convert, read_rmcios, paramtype,
+                     &returnv, index + 1, param);
+    }
     return returnv.param.bv->required_size;
 }
 
@@ -733,10 +1587,22 @@ int param_buffer_length (const struct context_rmcios *context,
         .num_params = 1,
         .param = &rbuff
     };
+    resolve_element (&paramtype, &param, &index);
+    if (paramtype == gather_rmcios)
+    {
+        return gather_length (param.gv + index);
+    }
+    if (paramtype == inline_rmcios)
+    {
+        return param.inv[index].length;
+    }
     // Get required length for the parameter
     // context.convert read command fills the given structure with required size parameter
-    run_channel (context, context->convert, read_rmcios, paramtype, &returnv,
-                 index + 1, param);
+    if (!convert_local (context, paramtype, param, index, &returnv))
+    {
+        run_channel (context, context->convert, read_rmcios, paramtype,
+                     &returnv, index + 1, param);
+    }
     return returnv.param.bv->required_size;
 }
 
@@ -750,10 +1616,22 @@ int param_binary_length (const struct context_rmcios *context,
         .num_params = 1,
         .param = &rbuff
     };
+    resolve_element (&paramtype, &param, &index);
+    if (paramtype == gather_rmcios)
+    {
+        return gather_length (param.gv + index);
+    }
+    if (paramtype == inline_rmcios)
+    {
+        return param.inv[index].length;
+    }
     // Get required length for the parameter
     // context.convert read command fills the given structure with required size parameter
-    run_channel (context, context->convert, read_rmcios, paramtype, &returnv,
-                 index + 1, param);
+    if (!convert_local (context, paramtype, param, index, &returnv))
+    {
+        run_channel (context, context->convert, read_rmcios, paramtype,
+                     &returnv, index + 1, param);
+    }
 
     return returnv.param.bv->required_size;
 }
@@ -769,10 +1647,25 @@ int param_string_alloc_size (const struct context_rmcios *context,
         .num_params = 1,
         .param = &rbuff
     };
+    resolve_element (&paramtype, &param, &index);
+    if (paramtype == gather_rmcios)
+    {
+        // Linearized with NULL-termination
+        return gather_length (param.gv + index) + 1;
+    }
+    if (paramtype == inline_rmcios)
+    {
+        // Inline data is NULL-terminated when it has room
+        return (param.inv[index].length < INLINE_BUFFER_SIZE) ?
+            0 : param.inv[index].length + 1;
+    }
     // Get required length for the parameter
     // context.convert read command fills the given structure with required size parameter
-    run_channel (context, context->convert, read_rmcios, paramtype, &returnv,
-                 index + 1, param);
+    if (!convert_local (context, paramtype, param, index, &returnv))
+    {
+        run_channel (context, context->convert, read_rmcios, paramtype,
+                     &returnv, index + 1, param);
+    }
     if (returnv.param.bv->data != 0 && returnv.param.bv->trailing_size > 0
         && returnv.param.bv->data[returnv.param.bv->length] == 0)
     {
@@ -796,10 +1689,24 @@ int param_buffer_alloc_size (const struct context_rmcios *context,
         .num_params = 1,
         .param = &rbuff
     };
+    resolve_element (&paramtype, &param, &index);
+    if (paramtype == gather_rmcios)
+    {
+        // Single segment is used without copy
+        return (param.gv[index].count == 1) ?
+            0 : gather_length (param.gv + index);
+    }
+    if (paramtype == inline_rmcios)
+    {
+        return 0;
+    }
     // Get required length for the parameter
     // context.convert read command fills the given structure with required size parameter
-    run_channel (context, context->convert, read_rmcios, paramtype, &returnv,
-                 index + 1, param);
+    if (!convert_local (context, paramtype, param, index, &returnv))
+    {
+        run_channel (context, context->convert, read_rmcios, paramtype,
+                     &returnv, index + 1, param);
+    }
     if (returnv.param.bv->data != 0
         && returnv.param.bv->required_size == returnv.param.bv->length)
     {
@@ -840,6 +1747,34 @@ int read_i (const struct context_rmcios *context, int channel)
     return rvalue;
 }
 
+double read_d (const struct context_rmcios *context, int channel)
+{
+    double rvalue = 0;
+    struct combo_rmcios returnv = {
+        .paramtype = double_rmcios,
+        .num_params = 1,
+        .param.dv = &rvalue
+    };
+    run_channel (context, channel,
+                 read_rmcios, double_rmcios,
+                 &returnv, 0, (union param_rmcios) 0);
+    return rvalue;
+}
+
+long long read_i64 (const struct context_rmcios *context, int channel)
+{
+    long long rvalue = 0;
+    struct combo_rmcios returnv = {
+        .paramtype = int64_rmcios,
+        .num_params = 1,
+        .param.lv = &rvalue
+    };
+    run_channel (context, channel,
+                 read_rmcios, int64_rmcios,
+                 &returnv, 0, (union param_rmcios) 0);
+    return rvalue;
+}
+
 int read_str (const struct context_rmcios *context,
               int channel, char *string, int maxlen)
 {
@@ -865,53 +1800,219 @@ int read_str (const struct context_rmcios *context,
     return sreturn.required_size;
 }
 
-float write_f (const struct context_rmcios *context, int channel, float value)
+int read_chunk (const struct context_rmcios *context, int channel,
+                char *buffer, int size, long long *cursor)
 {
-    float rvalue = 0;
+    struct buffer_rmcios chunk = {
+        .data = buffer,
+        .length = 0,
+        .size = size,
+        .required_size = 0,
+        .trailing_size = 0,
+        .flags = buffer_chunked_rmcios
+    };
+    struct combo_rmcios cursor_return = {
+        .paramtype = int64_rmcios,
+        .num_params = 1,
+        .param.lv = cursor,
+        .next = 0
+    };
     struct combo_rmcios returnv = {
-        .paramtype = float_rmcios,
+        .paramtype = buffer_rmcios,
         .num_params = 1,
-        .param.fv = &rvalue
+        .param.bv = &chunk,
+        .next = &cursor_return
     };
+
     run_channel (context, channel,
-                 write_rmcios, float_rmcios,
-                 &returnv, 1, (union param_rmcios) &value);
-    return rvalue;
+                 read_rmcios, buffer_rmcios,
+                 &returnv, 0, (union param_rmcios) 0);
+    if (chunk.flags & buffer_chunked_rmcios)
+    {
+        // Channel returned data without chunks
+        *cursor = 0;
+        if (chunk.required_size > chunk.length)
+        {
+            // Truncated data is not reported as the last chunk
+            return -(int) chunk.required_size;
+        }
+    }
+    return chunk.length;
 }
 
-float write_fv (const struct context_rmcios *context, int channel, int params,
-                float *values)
+struct buffer_rmcios read_str_borrow (const struct context_rmcios *context,
+                                      int channel, char *string, int maxlen)
 {
-    float rvalue = 0;
+    struct buffer_rmcios sreturn = {
+        .data = string,
+        .length = 0,
+        .size = (maxlen > 0) ? maxlen - 1 : 0,
+        .required_size = 0,
+        .trailing_size = 0
+    };
     struct combo_rmcios returnv = {
-        .paramtype = float_rmcios,
+        .paramtype = borrowed_rmcios,
         .num_params = 1,
-        .param.fv = &rvalue
+        .param.bv = &sreturn
     };
+
     run_channel (context, channel,
-                 write_rmcios, float_rmcios,
-                 &returnv, params, (union param_rmcios) values);
-    return rvalue;
+                 read_rmcios, buffer_rmcios,
+                 &returnv, 0, (union param_rmcios) 0);
+    if (sreturn.data == string && sreturn.size != 0)
+    {
+        // Copied to fallback buffer:
+        sreturn.data[sreturn.length] = 0;       // Add NULL-termination
+        sreturn.trailing_size = 1;
+    }
+    sreturn.size = 0;
+    return sreturn;
 }
 
-int write_iv (const struct context_rmcios *context, int channel, int params,
-              int *values)
+void read_async_f (const struct context_rmcios *context,
+                   int channel, int return_channel)
 {
-    int rvalue = 0;
     struct combo_rmcios returnv = {
-        .paramtype = int_rmcios,
+        .paramtype = channel_rmcios,
         .num_params = 1,
-        .param.iv = &rvalue
+        .param.channel = return_channel
     };
     run_channel (context, channel,
-                 write_rmcios, int_rmcios,
-                 &returnv, params, (union param_rmcios) values);
-    return rvalue;
+                 read_rmcios, float_rmcios,
+                 &returnv, 0, (union param_rmcios) 0);
 }
 
-int write_i (const struct context_rmcios *context, int channel, int value)
+void read_async_i (const struct context_rmcios *context,
+                   int channel, int return_channel)
 {
-    int rvalue = 0;
+    struct combo_rmcios returnv = {
+        .paramtype = channel_rmcios,
+        .num_params = 1,
+        .param.channel = return_channel
+    };
+    run_channel (context, channel,
+                 read_rmcios, int_rmcios,
+                 &returnv, 0, (union param_rmcios) 0);
+}
+
+void read_async_str (const struct context_rmcios *context,
+                     int channel, int return_channel)
+{
+    struct combo_rmcios returnv = {
+        .paramtype = channel_rmcios,
+        .num_params = 1,
+        .param.channel = return_channel
+    };
+    run_channel (context, channel,
+                 read_rmcios, buffer_rmcios,
+                 &returnv, 0, (union param_rmcios) 0);
+}
+
+int defer_return (struct combo_rmcios *returnv)
+{
+    if (returnv == 0 || returnv->num_params == 0)
+    {
+        return 0;
+    }
+    if (returnv->paramtype == channel_rmcios)
+    {
+        return returnv->param.channel;
+    }
+    return 0;
+}
+
+float write_f (const struct context_rmcios *context, int channel, float value)
+{
+    float rvalue = 0;
+    struct combo_rmcios returnv = {
+        .paramtype = float_rmcios,
+        .num_params = 1,
+        .param.fv = &rvalue
+    };
+    run_channel (context, channel,
+                 write_rmcios, float_rmcios,
+                 &returnv, 1, (union param_rmcios) &value);
+    return rvalue;
+}
+
+float write_fv (const struct context_rmcios *context, int channel, int params,
+                float *values)
+{
+    float rvalue = 0;
+    struct combo_rmcios returnv = {
+        .paramtype = float_rmcios,
+        .num_params = 1,
+        .param.fv = &rvalue
+    };
+    run_channel (context, channel,
+                 write_rmcios, float_rmcios,
+                 &returnv, params, (union param_rmcios) values);
+    return rvalue;
+}
+
+double write_d (const struct context_rmcios *context, int channel,
+                double value)
+{
+    double rvalue = 0;
+    struct combo_rmcios returnv = {
+        .paramtype = double_rmcios,
+        .num_params = 1,
+        .param.dv = &rvalue
+    };
+    run_channel (context, channel,
+                 write_rmcios, double_rmcios,
+                 &returnv, 1, (union param_rmcios) &value);
+    return rvalue;
+}
+
+double write_dv (const struct context_rmcios *context, int channel,
+                 int params, double *values)
+{
+    double rvalue = 0;
+    struct combo_rmcios returnv = {
+        .paramtype = double_rmcios,
+        .num_params = 1,
+        .param.dv = &rvalue
+    };
+    run_channel (context, channel,
+                 write_rmcios, double_rmcios,
+                 &returnv, params, (union param_rmcios) values);
+    return rvalue;
+}
+
+long long write_i64 (const struct context_rmcios *context, int channel,
+                     long long value)
+{
+    long long rvalue = 0;
+    struct combo_rmcios returnv = {
+        .paramtype = int64_rmcios,
+        .num_params = 1,
+        .param.lv = &rvalue
+    };
+    run_channel (context, channel,
+                 write_rmcios, int64_rmcios,
+                 &returnv, 1, (union param_rmcios) &value);
+    return rvalue;
+}
+
+int write_iv (const struct context_rmcios *context, int channel, int params,
+              int *values)
+{
+    int rvalue = 0;
+    struct combo_rmcios returnv = {
+        .paramtype = int_rmcios,
+        .num_params = 1,
+        .param.iv = &rvalue
+    };
+    run_channel (context, channel,
+                 write_rmcios, int_rmcios,
+                 &returnv, params, (union param_rmcios) values);
+    return rvalue;
+}
+
+int write_i (const struct context_rmcios *context, int channel, int value)
+{
+    int rvalue = 0;
     struct combo_rmcios returnv = {
         .paramtype = int_rmcios,
         .num_params = 1,
@@ -995,6 +2096,66 @@ int write_binary (const struct context_rmcios *context,
     return breturnv.required_size;
 }
 
+struct buffer_rmcios allocate_buffer (const struct context_rmcios *context,
+                                      int size)
+{
+    struct buffer_rmcios buffer = {
+        .data = allocate_storage (context, size, 0),
+        .length = 0,
+        .size = size,
+        .required_size = 0,
+        .trailing_size = 0,
+        .flags = buffer_owned_rmcios
+    };
+    if (buffer.data == 0)
+    {
+        buffer.size = 0;
+        buffer.flags = 0;
+    }
+    return buffer;
+}
+
+char *take_buffer (enum type_rmcios paramtype,
+                   const union param_rmcios param, int index)
+{
+    struct buffer_rmcios *buffer;
+    // Flags of other parameter types may be uninitialized or copied.
+    if (paramtype != moved_rmcios || param.bv == 0)
+    {
+        return 0;
+    }
+    buffer = param.bv + index;
+    if ((buffer->flags & buffer_owned_rmcios) == 0)
+    {
+        return 0;
+    }
+    buffer->flags &= ~buffer_owned_rmcios;
+    return buffer->data;
+}
+
+void release_buffer (const struct context_rmcios *context,
+                     struct buffer_rmcios *buffer)
+{
+    if ((buffer->flags & buffer_owned_rmcios) != 0)
+    {
+        buffer->flags &= ~buffer_owned_rmcios;
+        free_storage (context, buffer->data, 0);
+    }
+}
+
+void write_buffer_move (const struct context_rmcios *context, int channel,
+                        struct buffer_rmcios *buffer)
+{
+    buffer->flags |= buffer_owned_rmcios;
+    run_channel (context, channel, write_rmcios, moved_rmcios,
+                 0, 1, (union param_rmcios) buffer);
+    // Free when the channel did not take the data:
+    release_buffer (context, buffer);
+    buffer->data = 0;
+    buffer->length = 0;
+    buffer->size = 0;
+}
+
 int linked_channels (const struct context_rmcios *context, int channel)
 {
     int ireturn = 0;
@@ -1009,6 +2170,66 @@ int linked_channels (const struct context_rmcios *context, int channel)
     return ireturn;
 }
 
+void copy_context (struct context_rmcios *context,
+                   const struct context_rmcios *parent)
+{
+    context->version = parent->version;
+    context->run_channel = parent->run_channel;
+    context->data = parent->data;
+    context->id = parent->id;
+    context->name = parent->name;
+    context->mem = parent->mem;
+    context->quemem = parent->quemem;
+    context->errors = parent->errors;
+    context->warning = parent->warning;
+    context->report = parent->report;
+    context->control = parent->control;
+    context->link = parent->link;
+    context->linked = parent->linked;
+    context->create = parent->create;
+    context->convert = parent->convert;
+    context->clock = context_clock (parent);
+    if (context->version < CONTEXT_VERSION_CLOCK_RMCIOS)
+    {
+        context->version = CONTEXT_VERSION_CLOCK_RMCIOS;
+    }
+}
+
+int context_clock (const struct context_rmcios *context)
+{
+    // Older contexts do not have the clock member
+    if (context->version < CONTEXT_VERSION_CLOCK_RMCIOS)
+    {
+        return 0;
+    }
+    return context->clock;
+}
+
+long long read_time (const struct context_rmcios *context)
+{
+    long long time = 0;
+    struct buffer_rmcios breturnv = {
+        .data = (char *) &time,
+        .length = 0,
+        .size = sizeof (time),
+        .required_size = 0,
+        .trailing_size = 0
+    };
+    struct combo_rmcios returnv = {
+        .paramtype = binary_rmcios,
+        .num_params = 1,
+        .param.bv = &breturnv
+    };
+    if (context_clock (context) == 0)
+    {
+        return 0;
+    }
+    run_channel (context, context->clock,
+                 read_rmcios, binary_rmcios,
+                 &returnv, 0, (union param_rmcios) 0);
+    return time;
+}
+
 void *allocate_storage (const struct context_rmcios *context, int size,
                         int storage_channel)
 {
@@ -1074,6 +2295,7 @@ int channel_enum (const struct context_rmcios *context,
     param.required_size = slen;
     param.size = 0;
     param.trailing_size = 0;
+    param.flags = 0;
     run_channel (context, context->id,
                  read_rmcios, buffer_rmcios,
                  &returnv, 1, (union param_rmcios) &param);
@@ -1101,6 +2323,779 @@ int channel_name (const struct context_rmcios *context,
     return breturnv.required_size;
 }
 
+struct buffer_rmcios channel_name_borrow (const struct context_rmcios
+                                          *context, int channel_id,
+                                          char *name_to, int maxlen)
+{
+    struct buffer_rmcios breturnv = {
+        .data = name_to,
+        .length = 0,
+        .size = (maxlen > 0) ? maxlen - 1 : 0,
+        .required_size = 0,
+        .trailing_size = 0
+    };
+    struct combo_rmcios returnv = {
+        .paramtype = borrowed_rmcios,
+        .num_params = 1,
+        .param.bv = &breturnv
+    };
+    run_channel (context, context->name,
+                 read_rmcios, int_rmcios,
+                 &returnv, 1, (union param_rmcios) &channel_id);
+    if (breturnv.data == name_to && breturnv.size != 0)
+    {
+        // Copied to fallback buffer:
+        breturnv.data[breturnv.length] = 0;     // Add NULL-termination
+        breturnv.trailing_size = 1;
+    }
+    breturnv.size = 0;
+    return breturnv;
+}
+
+// ***********************************************************************
+// Conversion plans:
+// ***********************************************************************
+
+// Numeric to numeric conversions
+#define NUMERIC_PLAN(name, from_member, to_member, to_ctype) \
+static void name (const struct context_rmcios *context, \
+                  union param_rmcios param, int index, \
+                  struct combo_rmcios *returnv) \
+{ \
+    returnv->param.to_member[0] = (to_ctype) param.from_member[index]; \
+}
+
+NUMERIC_PLAN (plan_int_to_int, iv, iv, int)
+NUMERIC_PLAN (plan_int_to_float, iv, fv, float)
+NUMERIC_PLAN (plan_int_to_int64, iv, lv, long long)
+NUMERIC_PLAN (plan_int_to_double, iv, dv, double)
+NUMERIC_PLAN (plan_float_to_int, fv, iv, int)
+NUMERIC_PLAN (plan_float_to_float, fv, fv, float)
+NUMERIC_PLAN (plan_float_to_int64, fv, lv, long long)
+NUMERIC_PLAN (plan_float_to_double, fv, dv, double)
+NUMERIC_PLAN (plan_int64_to_int, lv, iv, int)
+NUMERIC_PLAN (plan_int64_to_float, lv, fv, float)
+NUMERIC_PLAN (plan_int64_to_int64, lv, lv, long long)
+NUMERIC_PLAN (plan_int64_to_double, lv, dv, double)
+NUMERIC_PLAN (plan_double_to_int, dv, iv, int)
+NUMERIC_PLAN (plan_double_to_float, dv, fv, float)
+NUMERIC_PLAN (plan_double_to_int64, dv, lv, long long)
+NUMERIC_PLAN (plan_double_to_double, dv, dv, double)
+
+// Index of numeric type in plan tables. -1 on non-numeric types.
+static int numeric_index (enum type_rmcios type)
+{
+    switch (type)
+    {
+    case int_rmcios:
+        return 0;
+    case float_rmcios:
+        return 1;
+    case int64_rmcios:
+        return 2;
+    case double_rmcios:
+        return 3;
+    default:
+        return -1;
+    }
+}
+
+static const convert_func_rmcios numeric_plans[4][4] = {
+    {plan_int_to_int, plan_int_to_float,
+     plan_int_to_int64, plan_int_to_double},
+    {plan_float_to_int, plan_float_to_float,
+     plan_float_to_int64, plan_float_to_double},
+    {plan_int64_to_int, plan_int64_to_float,
+     plan_int64_to_int64, plan_int64_to_double},
+    {plan_double_to_int, plan_double_to_float,
+     plan_double_to_int64, plan_double_to_double}
+};
+
+// 64-bit integer and double types
+static int is_wide_numeric (enum type_rmcios type)
+{
+    return type == int64_rmcios || type == double_rmcios;
+}
+
+// Type pairs converted by convert_local()
+static int local_pair (enum type_rmcios from, enum type_rmcios to)
+{
+    int text_from = (from == buffer_rmcios || from == binary_rmcios);
+    int text_to = (to == buffer_rmcios || to == binary_rmcios);
+    if (!is_wide_numeric (from) && !is_wide_numeric (to))
+    {
+        return 0;
+    }
+    if (numeric_index (from) >= 0 && numeric_index (to) >= 0)
+    {
+        return 1;
+    }
+    if (is_wide_numeric (from))
+    {
+        return text_to || to == inline_rmcios || to == channel_rmcios;
+    }
+    return text_from;
+}
+
+static void plan_int64_to_channel (const struct context_rmcios *context,
+                                   union param_rmcios param, int index,
+                                   struct combo_rmcios *returnv);
+static void plan_double_to_channel (const struct context_rmcios *context,
+                                    union param_rmcios param, int index,
+                                    struct combo_rmcios *returnv);
+
+// Conversions of 64-bit integer and double values without the convert
+// channel. Returns 0 when the conversion is left to the convert channel.
+static int convert_local (const struct context_rmcios *context,
+                          enum type_rmcios from, union param_rmcios param,
+                          int index, struct combo_rmcios *returnv)
+{
+    enum type_rmcios to = returnv->paramtype;
+    char text[32];
+    int length;
+
+    if (!local_pair (from, to))
+    {
+        return 0;
+    }
+    if (numeric_index (from) >= 0 && numeric_index (to) >= 0)
+    {
+        numeric_plans[numeric_index (from)][numeric_index (to)]
+            (context, param, index, returnv);
+        return 1;
+    }
+    if (is_wide_numeric (to))
+    {
+        // Text to number
+        const struct buffer_rmcios *src = param.bv + index;
+        long long integer = 0;
+        double real = NAN;
+        if (src->data != 0)
+        {
+            parse_number (src->data, src->length, &integer, &real);
+        }
+        if (to == int64_rmcios)
+        {
+            returnv->param.lv[0] = integer;
+        }
+        else
+        {
+            returnv->param.dv[0] = real;
+        }
+        return 1;
+    }
+
+    if (to == channel_rmcios)
+    {
+        if (from == int64_rmcios)
+            plan_int64_to_channel (context, param, index, returnv);
+        else
+            plan_double_to_channel (context, param, index, returnv);
+        return 1;
+    }
+
+    // Number to text
+    if (from == int64_rmcios)
+    {
+        length = format_int64 (param.lv[index], text);
+    }
+    else
+    {
+        length = format_double (param.dv[index], text);
+    }
+    if (to == inline_rmcios)
+    {
+        struct inline_rmcios *sreturn = returnv->param.inv;
+        int i;
+        sreturn->length = (length < INLINE_BUFFER_SIZE) ?
+            length : INLINE_BUFFER_SIZE;
+        for (i = 0; i < sreturn->length; i++)
+        {
+            sreturn->data[i] = text[i];
+        }
+        if (sreturn->length < INLINE_BUFFER_SIZE)
+        {
+            sreturn->data[sreturn->length] = 0;
+        }
+    }
+    else
+    {
+        store_text (returnv->param.bv, text, length);
+    }
+    return 1;
+}
+
+// Buffer to buffer. 
+// Copies to writable return buffer. Refers to source on read only return.
+static void plan_buffer_to_buffer (const struct context_rmcios *context,
+                                   union param_rmcios param, int index,
+                                   struct combo_rmcios *returnv)
+{
+    struct buffer_rmcios *src = param.bv + index;
+    struct buffer_rmcios *dst = returnv->param.bv;
+    if (dst->size == 0)
+    {
+        *dst = *src;
+        dst->size = 0;
+        // Reference does not take the ownership
+        dst->flags = 0;
+        return;
+    }
+    dst->length = copy_mem_safe (src->data, src->length,
+                                 dst->data, dst->size);
+    dst->required_size = src->length;
+    dst->trailing_size = 0;
+    if (dst->length < dst->size)
+    {
+        // Terminated like string copies when there is room
+        dst->data[dst->length] = 0;
+        dst->trailing_size = 1;
+    }
+}
+
+// Numeric value to channel: Write value to the channel.
+static void plan_to_channel (const struct context_rmcios *context,
+                             union param_rmcios param, int index,
+                             struct combo_rmcios *returnv)
+{
+    union param_rmcios value;
+    value.iv = param.iv + index;
+    run_channel (context, returnv->param.channel, write_rmcios, int_rmcios,
+                 0, 1, value);
+}
+
+static void plan_float_to_channel (const struct context_rmcios *context,
+                                   union param_rmcios param, int index,
+                                   struct combo_rmcios *returnv)
+{
+    union param_rmcios value;
+    value.fv = param.fv + index;
+    run_channel (context, returnv->param.channel, write_rmcios, float_rmcios,
+                 0, 1, value);
+}
+
+static void plan_int64_to_channel (const struct context_rmcios *context,
+                                   union param_rmcios param, int index,
+                                   struct combo_rmcios *returnv)
+{
+    union param_rmcios value;
+    value.lv = param.lv + index;
+    run_channel (context, returnv->param.channel, write_rmcios, int64_rmcios,
+                 0, 1, value);
+}
+
+static void plan_double_to_channel (const struct context_rmcios *context,
+                                    union param_rmcios param, int index,
+                                    struct combo_rmcios *returnv)
+{
+    union param_rmcios value;
+    value.dv = param.dv + index;
+    run_channel (context, returnv->param.channel, write_rmcios,
+                 double_rmcios, 0, 1, value);
+}
+
+static void plan_buffer_to_channel (const struct context_rmcios *context,
+                                    union param_rmcios param, int index,
+                                    struct combo_rmcios *returnv)
+{
+    union param_rmcios value;
+    value.bv = param.bv + index;
+    run_channel (context, returnv->param.channel, write_rmcios,
+                 buffer_rmcios, 0, 1, value);
+}
+
+static void plan_binary_to_channel (const struct context_rmcios *context,
+                                    union param_rmcios param, int index,
+                                    struct combo_rmcios *returnv)
+{
+    union param_rmcios value;
+    value.bv = param.bv + index;
+    run_channel (context, returnv->param.channel, write_rmcios,
+                 binary_rmcios, 0, 1, value);
+}
+
+// Conversions without specialized plan are made by the convert channel.
+#define CONVERT_CHANNEL_PLAN(name, from_type) \
+static void name (const struct context_rmcios *context, \
+                  union param_rmcios param, int index, \
+                  struct combo_rmcios *returnv) \
+{ \
+    enum type_rmcios to = returnv->paramtype; \
+    if (convert_local (context, from_type, param, index, returnv)) \
+    { \
+        return; \
+    } \
+    if ((to == buffer_rmcios || to == binary_rmcios) \
+        && returnv->param.bv->size > 0) \
+    { \
+        run_channel (context, context->convert, write_rmcios, from_type, \
+                     returnv, index + 1, param); \
+    } \
+    else \
+    { \
+        run_channel (context, context->convert, read_rmcios, from_type, \
+                     returnv, index + 1, param); \
+    } \
+}
+
+CONVERT_CHANNEL_PLAN (plan_int_by_channel, int_rmcios)
+CONVERT_CHANNEL_PLAN (plan_float_by_channel, float_rmcios)
+CONVERT_CHANNEL_PLAN (plan_buffer_by_channel, buffer_rmcios)
+CONVERT_CHANNEL_PLAN (plan_binary_by_channel, binary_rmcios)
+CONVERT_CHANNEL_PLAN (plan_channel_by_channel, channel_rmcios)
+CONVERT_CHANNEL_PLAN (plan_int64_by_channel, int64_rmcios)
+CONVERT_CHANNEL_PLAN (plan_double_by_channel, double_rmcios)
+
+// Plans of element types known only at conversion time.
+// Table is filled on first use of each type pair. Concurrent fills 
+// store the same function.
+static convert_func_rmcios element_plan (enum type_rmcios from,
+                                         enum type_rmcios to)
+{
+    static plan_slot_rmcios plans[moved_rmcios + 1][moved_rmcios + 1];
+    convert_func_rmcios convert;
+    if (from < 0 || from > moved_rmcios || to < 0 || to > moved_rmcios)
+    {
+        return conversion_plan (from, to).convert;
+    }
+    convert = LOAD_PLAN (plans[from][to]);
+    if (convert == 0)
+    {
+        convert = conversion_plan (from, to).convert;
+        STORE_PLAN (plans[from][to], convert);
+    }
+    return convert;
+}
+
+// Element conversions of composite source may use the convert channel
+static int elements_use_channel (const enum type_rmcios *types, int count,
+                                 enum type_rmcios to)
+{
+    int i;
+    for (i = 0; i < count; i++)
+    {
+        if (conversion_plan (types[i], to).uses_channel)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Combo source: plan is selected by the type of the indexed parameter.
+static void plan_from_combo (const struct context_rmcios *context,
+                             union param_rmcios param, int index,
+                             struct combo_rmcios *returnv)
+{
+    struct combo_rmcios *combo = param.cv;
+    while (index >= combo->num_params)
+    {
+        index -= combo->num_params;
+        combo++;
+    }
+    element_plan (combo->paramtype, returnv->paramtype)
+        (context, combo->param, index, returnv);
+}
+
+// View inline string as buffer. Converted by the plan of buffer.
+static void plan_from_inline (const struct context_rmcios *context,
+                              union param_rmcios param, int index,
+                              struct combo_rmcios *returnv)
+{
+    struct buffer_rmcios view = inline_view (param.inv + index);
+    element_plan (buffer_rmcios, returnv->paramtype)
+        (context, (union param_rmcios) &view, 0, returnv);
+}
+
+// Inline return. Short values are stored without the convert channel.
+#define INLINE_RETURN_PLAN(name, from_type, from_member) \
+static void name (const struct context_rmcios *context, \
+                  union param_rmcios param, int index, \
+                  struct combo_rmcios *returnv) \
+{ \
+    union param_rmcios value; \
+    value.from_member = param.from_member + index; \
+    convert_return (context, from_type, returnv, value); \
+}
+
+INLINE_RETURN_PLAN (plan_int_to_inline, int_rmcios, iv)
+INLINE_RETURN_PLAN (plan_float_to_inline, float_rmcios, fv)
+INLINE_RETURN_PLAN (plan_buffer_to_inline, buffer_rmcios, bv)
+INLINE_RETURN_PLAN (plan_binary_to_inline, binary_rmcios, bv)
+INLINE_RETURN_PLAN (plan_int64_to_inline, int64_rmcios, lv)
+INLINE_RETURN_PLAN (plan_double_to_inline, double_rmcios, dv)
+
+// Linearize gather chain. Converted by the plan of buffer.
+static void plan_from_gather (const struct context_rmcios *context,
+                              union param_rmcios param, int index,
+                              struct combo_rmcios *returnv)
+{
+    char linear[64];
+    char *data = linear;
+    const struct gather_rmcios *gather = param.gv + index;
+    struct buffer_rmcios *dst = returnv->param.bv;
+    struct buffer_rmcios src;
+    int length;
+    if (returnv->paramtype == buffer_rmcios
+        || returnv->paramtype == binary_rmcios)
+    {
+        if (dst->size > 0)
+        {
+            // Straight to the return buffer:
+            dst->required_size = linearize_gather (gather, dst->data,
+                                                   dst->size);
+            dst->length = (dst->required_size < dst->size) ?
+                dst->required_size : dst->size;
+            dst->trailing_size = 0;
+            return;
+        }
+        if (gather->count > 1)
+        {
+            // Linearized copy does not outlive the call. Reference is not
+            // returned, only the size needed for a copy.
+            dst->length = 0;
+            dst->required_size = gather_length (gather);
+            dst->trailing_size = 0;
+            return;
+        }
+    }
+    length = sizeof (linear);
+    if (gather->count > 1 && gather_length (gather) > length)
+    {
+        // Long chain is linearized to temporary storage
+        length = gather_length (gather);
+        data = allocate_storage (context, length, 0);
+        if (data == 0)
+        {
+            data = linear;
+            length = sizeof (linear);
+        }
+    }
+    src = gather_to_buffer (gather, length, data);
+    element_plan (binary_rmcios, returnv->paramtype)
+        (context, (union param_rmcios) &src, 0, returnv);
+    if (data != linear)
+    {
+        free_storage (context, data, 0);
+    }
+}
+
+// Resolve array element and convert it by element type.
+static void plan_from_array (const struct context_rmcios *context,
+                             union param_rmcios param, int index,
+                             struct combo_rmcios *returnv)
+{
+    enum type_rmcios type;
+    union param_rmcios element = array_element (param, index, &type);
+    if (element.p != 0)
+    {
+        element_plan (type, returnv->paramtype)
+            (context, element, 0, returnv);
+    }
+}
+
+struct conversion_plan_rmcios conversion_plan (enum type_rmcios from,
+                                               enum type_rmcios to)
+{
+    if (from == moved_rmcios)
+    {
+        // Moved buffers convert as binary
+        from = binary_rmcios;
+    }
+    struct conversion_plan_rmcios plan = {
+        .from = from,
+        .to = to,
+        .convert = 0,
+        .uses_channel = 0,
+        .zero_copy = 0
+    };
+    static const enum type_rmcios numeric_types[] = {
+        int_rmcios, float_rmcios, int64_rmcios, double_rmcios
+    };
+    static const enum type_rmcios element_types[] = {
+        int_rmcios, float_rmcios, int64_rmcios, double_rmcios,
+        buffer_rmcios, binary_rmcios, channel_rmcios,
+        array_rmcios, gather_rmcios, inline_rmcios
+    };
+
+    if (from == combo_rmcios)
+    {
+        plan.convert = plan_from_combo;
+        plan.uses_channel = elements_use_channel (element_types,
+                                                  sizeof (element_types) /
+                                                  sizeof (element_types[0]),
+                                                  to);
+        return plan;
+    }
+
+    if (from == array_rmcios)
+    {
+        plan.convert = plan_from_array;
+        plan.uses_channel = elements_use_channel (numeric_types,
+                                                  sizeof (numeric_types) /
+                                                  sizeof (numeric_types[0]),
+                                                  to);
+        return plan;
+    }
+
+    if (from == gather_rmcios)
+    {
+        plan.convert = plan_from_gather;
+        plan.uses_channel = conversion_plan (binary_rmcios, to).uses_channel;
+        return plan;
+    }
+
+    if (from == inline_rmcios)
+    {
+        plan.convert = plan_from_inline;
+        plan.uses_channel = conversion_plan (buffer_rmcios, to).uses_channel;
+        return plan;
+    }
+
+    if (numeric_index (from) >= 0 && numeric_index (to) >= 0)
+    {
+        plan.convert = numeric_plans[numeric_index (from)]
+            [numeric_index (to)];
+        return plan;
+    }
+
+    switch (to)
+    {
+    case buffer_rmcios:
+    case binary_rmcios:
+        if (from == buffer_rmcios || from == binary_rmcios)
+        {
+            plan.convert = plan_buffer_to_buffer;
+            plan.zero_copy = 1;
+        }
+        break;
+
+    case inline_rmcios:
+        if (from == int_rmcios)
+            plan.convert = plan_int_to_inline;
+        else if (from == float_rmcios)
+            plan.convert = plan_float_to_inline;
+        else if (from == buffer_rmcios)
+            plan.convert = plan_buffer_to_inline;
+        else if (from == binary_rmcios)
+            plan.convert = plan_binary_to_inline;
+        else if (from == int64_rmcios)
+            plan.convert = plan_int64_to_inline;
+        else if (from == double_rmcios)
+            plan.convert = plan_double_to_inline;
+        // Numeric formatting is made by the convert channel
+        plan.uses_channel = (from != buffer_rmcios && from != binary_rmcios
+                             && !local_pair (from, to));
+        break;
+
+    case channel_rmcios:
+        if (from == int_rmcios)
+            plan.convert = plan_to_channel;
+        else if (from == float_rmcios)
+            plan.convert = plan_float_to_channel;
+        else if (from == buffer_rmcios)
+            plan.convert = plan_buffer_to_channel;
+        else if (from == binary_rmcios)
+            plan.convert = plan_binary_to_channel;
+        else if (from == int64_rmcios)
+            plan.convert = plan_int64_to_channel;
+        else if (from == double_rmcios)
+            plan.convert = plan_double_to_channel;
+        break;
+
+    default:
+        break;
+    }
+
+    if (plan.convert == 0)
+    {
+        // 64-bit integer and double text conversions are made locally
+        plan.uses_channel = !local_pair (from, to);
+        switch (from)
+        {
+        case int_rmcios:
+            plan.convert = plan_int_by_channel;
+            break;
+        case float_rmcios:
+            plan.convert = plan_float_by_channel;
+            break;
+        case buffer_rmcios:
+            plan.convert = plan_buffer_by_channel;
+            break;
+        case binary_rmcios:
+            plan.convert = plan_binary_by_channel;
+            break;
+        case int64_rmcios:
+            plan.convert = plan_int64_by_channel;
+            break;
+        case double_rmcios:
+            plan.convert = plan_double_by_channel;
+            break;
+        default:
+            plan.convert = plan_channel_by_channel;
+            break;
+        }
+    }
+    return plan;
+}
+
+// Array views:
+int array_element_size (enum type_rmcios type)
+{
+    switch (type)
+    {
+    case int_rmcios:
+        return sizeof (int);
+    case float_rmcios:
+        return sizeof (float);
+    case int64_rmcios:
+        return sizeof (long long);
+    case double_rmcios:
+        return sizeof (double);
+    default:
+        return 0;
+    }
+}
+
+struct array_rmcios make_array (enum type_rmcios type, void *data,
+                                int count, int stride)
+{
+    struct array_rmcios array = {
+        .type = type,
+        .data = data,
+        .count = count,
+        .stride = stride
+    };
+    return array;
+}
+
+union param_rmcios array_element (union param_rmcios param, int index,
+                                  enum type_rmcios *type)
+{
+    union param_rmcios element = {.p = 0 };
+    struct array_rmcios *array = param.av;
+    int stride;
+
+    if (array == 0 || index < 0)
+    {
+        return element;
+    }
+    while (index >= array->count)
+    {
+        index -= array->count;
+        array++;
+    }
+    stride = array->stride;
+    if (stride == 0)
+    {
+        stride = array_element_size (array->type);
+    }
+    *type = array->type;
+    element.p = (char *) array->data + (long) index * stride;
+    return element;
+}
+
+void write_array (const struct context_rmcios *context, int channel,
+                  const struct array_rmcios *array)
+{
+    run_channel (context, channel, write_rmcios, array_rmcios, 0,
+                 array->count, (union param_rmcios) (const void *) array);
+}
+
+// Bulk conversion between strided views of known numeric types
+#define CONVERT_ARRAY(src_ctype, dst_ctype) \
+    for (i = 0; i < count; i++) \
+    { \
+        *(dst_ctype *) (dst_data + (long) i * dst_stride) = \
+            (dst_ctype) *(const src_ctype *) (src_data + (long) i * src_stride); \
+    }
+
+#define CONVERT_ARRAY_FROM(src_ctype) \
+    switch (dst->type) \
+    { \
+    case int_rmcios: CONVERT_ARRAY (src_ctype, int) break; \
+    case float_rmcios: CONVERT_ARRAY (src_ctype, float) break; \
+    case int64_rmcios: CONVERT_ARRAY (src_ctype, long long) break; \
+    case double_rmcios: CONVERT_ARRAY (src_ctype, double) break; \
+    default: return 0; \
+    }
+
+int convert_array (const struct context_rmcios *context,
+                   const struct array_rmcios *src, struct array_rmcios *dst)
+{
+    int count = (src->count < dst->count) ? src->count : dst->count;
+    int src_stride = src->stride ? src->stride :
+        array_element_size (src->type);
+    int dst_stride = dst->stride ? dst->stride :
+        array_element_size (dst->type);
+    const char *src_data = src->data;
+    char *dst_data = dst->data;
+    int i;
+
+    if (count <= 0 || array_element_size (dst->type) == 0)
+    {
+        return 0;
+    }
+
+    switch (src->type)
+    {
+    case int_rmcios:
+        CONVERT_ARRAY_FROM (int);
+        break;
+    case float_rmcios:
+        CONVERT_ARRAY_FROM (float);
+        break;
+    case int64_rmcios:
+        CONVERT_ARRAY_FROM (long long);
+        break;
+    case double_rmcios:
+        CONVERT_ARRAY_FROM (double);
+        break;
+    default:
+        return 0;
+    }
+    return count;
+}
+
+int param_to_array (const struct context_rmcios *context,
+                    enum type_rmcios paramtype, int num_params,
+                    union param_rmcios param, struct array_rmcios *dst)
+{
+    struct conversion_plan_rmcios plan;
+    struct combo_rmcios element = {
+        .paramtype = dst->type,
+        .num_params = 1,
+        .next = 0
+    };
+    int count = (num_params < dst->count) ? num_params : dst->count;
+    int stride = dst->stride ? dst->stride : array_element_size (dst->type);
+    int i;
+
+    if (count <= 0 || array_element_size (dst->type) == 0)
+    {
+        return 0;
+    }
+
+    // Single view converts in bulk:
+    if (paramtype == array_rmcios && param.av->count >= count)
+    {
+        return convert_array (context, param.av, dst);
+    }
+    if (paramtype == dst->type || numeric_index (paramtype) >= 0)
+    {
+        struct array_rmcios src = make_array (paramtype, param.p, count, 0);
+        return convert_array (context, &src, dst);
+    }
+
+    plan = conversion_plan (paramtype, dst->type);
+    for (i = 0; i < count; i++)
+    {
+        element.param.p = (char *) dst->data + (long) i * stride;
+        plan.convert (context, param, i, &element);
+    }
+    return count;
+}
+
 // Creation of buffer structures:
 struct buffer_rmcios make_str_as_const_buffer (const char *str)
 {
@@ -1113,6 +3108,7 @@ struct buffer_rmcios make_str_as_const_buffer (const char *str)
     pb.size = 0;
     pb.required_size = i;
     pb.trailing_size = 1;
+    pb.flags = 0;
     return pb;
 }
 
@@ -1140,6 +3136,7 @@ struct buffer_rmcios make_str_as_buffer (char *str, int size)
     pb.size = size;
     pb.required_size = i;
     pb.trailing_size = 0;
+    pb.flags = 0;
     return pb;
 }
 
@@ -1151,5 +3148,6 @@ struct buffer_rmcios make_buffer (char *buffer, int length)
     pb.size = length;
     pb.required_size = length;
     pb.trailing_size = 0;
+    pb.flags = 0;
     return pb;
 }
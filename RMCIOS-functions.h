@@ -159,6 +159,24 @@ void return_int (const struct context_rmcios *context,
 void return_float (const struct context_rmcios *context,
                    struct combo_rmcios *returnv, float value);
 
+/// @brief Return a single 64-bit integer from a channel:
+/// 
+/// Helper function for implementing channels
+/// @param context pointer to target system context
+/// @param returnv pointer to return parameter
+/// @param value integer value to be returned
+void return_int64 (const struct context_rmcios *context,
+                   struct combo_rmcios *returnv, long long value);
+
+/// @brief Return a single double from a channel:
+/// 
+/// Helper function for implementing channels
+/// @param context pointer to target system context
+/// @param returnv pointer to return parameter
+/// @param value double value to be returned
+void return_double (const struct context_rmcios *context,
+                    struct combo_rmcios *returnv, double value);
+
 /// @brief Return string from a channel:
 /// 
 /// Helper function for implementing channels
@@ -183,6 +201,65 @@ void return_buffer (const struct context_rmcios *context,
                     struct combo_rmcios *returnv,
                     const char *buffer, unsigned int length);
 
+/// @brief Lend buffer data from a channel:
+/// 
+/// Helper function for implementing channels.
+/// Data must be owned by the channel and stay unchanged until the next 
+/// write or setup call to the channel. Return buffers of
+/// borrowed_rmcios type are pointed to the data without copy.
+/// Data is copied to other return types.
+/// @param context pointer to target system context
+/// @param returnv pointer to return parameter
+/// @param buffer pointer to data to be lent
+/// @param length bytes in @p buffer
+void lend_buffer (const struct context_rmcios *context,
+                  struct combo_rmcios *returnv,
+                  const char *buffer, unsigned int length);
+
+/// @brief Lend string from a channel:
+/// 
+/// NULL-terminated version of lend_buffer.
+/// @param context pointer to target system context
+/// @param returnv pointer to return parameter
+/// @param string NULL-terminated string to be lent
+void lend_string (const struct context_rmcios *context,
+                  struct combo_rmcios *returnv, const char *string);
+
+/// @brief Get cursor of chunked read
+/// 
+/// Helper function for implementing channels
+/// @param returnv pointer to return parameter
+/// @return pointer to continuation cursor. 0 when chunked read is not
+///         requested.
+long long *chunk_cursor (struct combo_rmcios *returnv);
+
+/// @brief Return chunk of data from a channel:
+/// 
+/// Helper function for implementing channels.
+/// Chunk is truncated to the size of the return buffer.
+/// @param context pointer to target system context
+/// @param returnv pointer to return parameter of chunked read
+/// @param buffer pointer to data of the chunk
+/// @param length bytes in the chunk
+/// @param cursor continuation cursor of next chunk. 0 on last chunk.
+void return_chunk (const struct context_rmcios *context,
+                   struct combo_rmcios *returnv,
+                   const char *buffer, unsigned int length,
+                   long long cursor);
+
+/// @brief Return buffer from a channel in chunks:
+/// 
+/// Helper function for implementing channels.
+/// Chunked reads get the part of @p buffer starting from the cursor. 
+/// Other reads get the buffer as with return_buffer.
+/// @param context pointer to target system context
+/// @param returnv pointer to return parameter
+/// @param buffer pointer to whole data
+/// @param length bytes in @p buffer
+void return_buffer_chunked (const struct context_rmcios *context,
+                            struct combo_rmcios *returnv,
+                            const char *buffer, unsigned int length);
+
 /// @brief Return binary data from a channel:
 /// 
 /// Helper function for implementing channels
@@ -234,6 +311,30 @@ float param_to_float (const struct context_rmcios *context,
                       enum type_rmcios paramtype,
                       union param_rmcios param, int index);
 
+/// @brief Convert parameter to 64-bit integer
+/// 
+/// Helper function for implementing channels
+/// @param context pointer to target system context
+/// @param paramtype type of @p param array
+/// @param param array of parameters
+/// @param index of the parameter to be read as 64-bit integer
+/// @return 64-bit integer representation of the parameter
+long long param_to_int64 (const struct context_rmcios *context,
+                          enum type_rmcios paramtype,
+                          union param_rmcios param, int index);
+
+/// @brief Convert parameter to double
+/// 
+/// Helper function for implementing channels
+/// @param context pointer to target system context
+/// @param paramtype type of @p param array
+/// @param param array of parameters
+/// @param index of the parameter to be read as double
+/// @return double representation of the parameter
+double param_to_double (const struct context_rmcios *context,
+                        enum type_rmcios paramtype,
+                        union param_rmcios param, int index);
+
 /// @brief Get/convert parameter to NULL-terminated string. 
 /// 
 /// Helper function for implementing channels
@@ -415,6 +516,20 @@ float read_f (const struct context_rmcios *context, int channel);
 /// @return integer read from the channel
 int read_i (const struct context_rmcios *context, int channel);
 
+/// @brief Reads data from channel without parameter (double)
+///
+/// @param context pointer to target system context
+/// @param channel handle of channel to be read
+/// @return double read from the channel
+double read_d (const struct context_rmcios *context, int channel);
+
+/// @brief Reads data from channel without parameter (64-bit integer)
+///
+/// @param context pointer to target system context
+/// @param channel handle of channel to be read
+/// @return 64-bit integer read from the channel
+long long read_i64 (const struct context_rmcios *context, int channel);
+
 /// @brief Reads string from channel
 ///
 /// @param context pointer to target system context
@@ -425,6 +540,79 @@ int read_i (const struct context_rmcios *context, int channel);
 int read_str (const struct context_rmcios *context,
               int channel, char *string, int maxlen);
 
+/// @brief Read chunk of data from channel
+///
+/// Large payloads are consumed in bounded memory:
+///
+///     long long cursor = 0;
+///     do {
+///         length = read_chunk (context, channel, buffer, size, &cursor);
+///     } while (cursor != 0);
+///
+/// Channels without chunked read support return the data in one call.
+/// Data that does not fit @p buffer is then reported with negative return.
+/// @param context pointer to target system context
+/// @param channel handle of channel to be read
+/// @param buffer buffer for the chunk
+/// @param size size of @p buffer
+/// @param cursor continuation cursor. 0 on first chunk. 
+///        Set to 0 after the last chunk.
+/// @return length of the chunk. -(required size) when channel without 
+///         chunked read support had more data than fits @p buffer.
+///         First @p size bytes are then in @p buffer and cursor is 0.
+int read_chunk (const struct context_rmcios *context, int channel,
+                char *buffer, int size, long long *cursor);
+
+/// @brief Reads string from channel borrowing channel storage
+///
+/// Channels that lend their data return it in one call without copy.
+/// Data of other channels is copied to @p string.
+/// @param context pointer to target system context
+/// @param channel handle of channel to be read
+/// @param string fallback buffer for copied data. Can be 0.
+/// @param maxlen size of buffer @p string
+/// @return read only buffer referring to borrowed or copied data.
+///         Copied data is NULL-terminated when it fits.
+struct buffer_rmcios read_str_borrow (const struct context_rmcios *context,
+                                      int channel, char *string, int maxlen);
+
+/// @brief Read float from channel asynchronously.
+///
+/// Channel writes the read value to @p return_channel when it completes.
+/// Completion can happen during the call or later from another thread.
+/// @param context pointer to target system context
+/// @param channel handle of channel to be read
+/// @param return_channel handle of channel that receives the value
+void read_async_f (const struct context_rmcios *context,
+                   int channel, int return_channel);
+
+/// @brief Read integer from channel asynchronously.
+///
+/// @param context pointer to target system context
+/// @param channel handle of channel to be read
+/// @param return_channel handle of channel that receives the value
+void read_async_i (const struct context_rmcios *context,
+                   int channel, int return_channel);
+
+/// @brief Read string from channel asynchronously.
+///
+/// @param context pointer to target system context
+/// @param channel handle of channel to be read
+/// @param return_channel handle of channel that receives the string
+void read_async_str (const struct context_rmcios *context,
+                     int channel, int return_channel);
+
+/// @brief Get channel for completing a call later.
+/// 
+/// Helper function for implementing channels
+/// Channels that complete reads later store the returned handle and 
+/// write the result to it (write_f, write_i, write_str) on completion.
+/// @param returnv pointer to return parameter
+/// @return channel handle for later completion. 
+/// 0 when caller waits for the return data. Channel must then return
+/// the data before returning from the call.
+int defer_return (struct combo_rmcios *returnv);
+
 /// @brief Write single float value to channel  (float)
 ///
 /// @param context pointer to target system context
@@ -441,6 +629,31 @@ float write_f (const struct context_rmcios *context,
 float write_fv (const struct context_rmcios *context,
                 int channel, int params, float *values);
 
+/// @brief Write single double value to channel
+///
+/// @param context pointer to target system context
+/// @param channel handle of channel to be written
+/// @param value double value to be written
+double write_d (const struct context_rmcios *context,
+                int channel, double value);
+
+/// @brief Write multiple double parameters to channel.
+///
+/// @param context pointer to target system context
+/// @param channel handle to channel to be written
+/// @param params number of parameters to be written from array @p values
+/// @param values array of double value parameters
+double write_dv (const struct context_rmcios *context,
+                 int channel, int params, double *values);
+
+/// @brief Write single 64-bit integer value to channel
+///
+/// @param context pointer to target system context
+/// @param channel handle of channel to be written
+/// @param value integer value to be written
+long long write_i64 (const struct context_rmcios *context,
+                     int channel, long long value);
+
 /// @brief Write single integer value to channel
 ///
 /// @param context pointer to target system context
@@ -491,6 +704,50 @@ int write_binary (const struct context_rmcios *context,
                   const char *buffer,
                   int length, char *return_data, int maxlen);
 
+/// @brief Allocate buffer with ownership flag.
+///
+/// Data is allocated from the context mem channel.
+/// @param context pointer to target system context
+/// @param size size of the buffer in bytes
+/// @return buffer with buffer_owned_rmcios flag. Size 0 on failure.
+struct buffer_rmcios allocate_buffer (const struct context_rmcios *context,
+                                      int size);
+
+/// @brief Take ownership of buffer data.
+///
+/// Helper function for implementing channels.
+/// Channel that takes the data frees it later with free_storage.
+/// Only parameters of the original call can be taken. Copies made by
+/// conversions are never owned.
+/// @param paramtype type of call parameters. Data is owned only on
+///        moved_rmcios parameters.
+/// @param param call parameters
+/// @param index index of the parameter
+/// @return pointer to data now owned by the caller. 
+///         0 when the buffer is not owned and data must be copied.
+char *take_buffer (enum type_rmcios paramtype,
+                   const union param_rmcios param, int index);
+
+/// @brief Free buffer data when the buffer still owns it.
+///
+/// @param context pointer to target system context
+/// @param buffer buffer to release
+void release_buffer (const struct context_rmcios *context,
+                     struct buffer_rmcios *buffer);
+
+/// @brief Write buffer to channel transferring the ownership of data.
+///
+/// Data must be allocated with allocate_buffer or allocate_storage.
+/// Buffer is written as moved_rmcios parameter.
+/// Receiving channel may keep the data with take_buffer. 
+/// Otherwise the data is freed after the call. 
+/// Buffer is cleared after the call.
+/// @param context pointer to target system context
+/// @param channel handle of channel to be written
+/// @param buffer buffer to be moved
+void write_buffer_move (const struct context_rmcios *context, int channel,
+                        struct buffer_rmcios *buffer);
+
 /// @brief get channel link representation handle
 /// 
 /// @param context pointer to target system context
@@ -498,6 +755,28 @@ int write_binary (const struct context_rmcios *context,
 /// @return Handle for linked channels
 int linked_channels (const struct context_rmcios *context, int channel);
 
+/// @brief Copy context for a wrapping context implementation.
+///
+/// Members that do not exist in the version of @p parent are cleared.
+/// Version of the copy is at least CONTEXT_VERSION_CLOCK_RMCIOS.
+/// @param context context to be filled
+/// @param parent context to be copied
+void copy_context (struct context_rmcios *context,
+                   const struct context_rmcios *parent);
+
+/// @brief Get clock channel of the context.
+///
+/// @param context pointer to target system context
+/// @return clock channel. 0 when context has no clock or is older than 
+///         CONTEXT_VERSION_CLOCK_RMCIOS.
+int context_clock (const struct context_rmcios *context);
+
+/// @brief Read current time from the context clock.
+///
+/// @param context pointer to target system context
+/// @return time in nanoseconds. 0 when context has no clock.
+long long read_time (const struct context_rmcios *context);
+
 /// Allocate storage from an storage channel
 /// @param context pointer to target system context
 /// @param size size to allocate. 
@@ -519,6 +798,22 @@ void *allocate_storage (const struct context_rmcios *context,
 void free_storage (const struct context_rmcios *context,
                    void *handle, int storage_channel);
 
+/// Function names and enums. Shared by the C and C++ name lookup:
+/// X(name, function)
+#define FUNCTION_NAMES_RMCIOS(X) \
+    X ("help", help_rmcios) \
+    X ("create", create_rmcios) \
+    X ("setup", setup_rmcios) \
+    X ("write", write_rmcios) \
+    X ("read", read_rmcios) \
+    /* Legacy command: (reset is now triggered with empty write) */ \
+    X ("reset", write_rmcios) \
+    /* Legacy command: */ \
+    /* (replaced with link -channel -> write link channel to_channel) */ \
+    X ("link", link_rmcios) \
+    /* Legacy name for setup: (setup is short enough by itelf) */ \
+    X ("conf", setup_rmcios)
+
 /// Convert ASCII name of function into number.
 /// @param name name of the function in NULL-terminated ASCII string
 /// @return enum number of the function. returns 0 on no match.
@@ -540,6 +835,170 @@ int channel_name (const struct context_rmcios *context,
                   int channel_id, char *name_to, int maxlen);
 
 
+/// Get channel name borrowing name storage.
+/// @param context pointer to target system context
+/// @param channel_enum channel id number.
+/// @param name_to fallback buffer for copied name. Can be 0.
+/// @param maxlen size of name_to -buffer
+/// @return read only buffer referring to borrowed or copied name.
+///         Copied name is NULL-terminated when it fits.
+struct buffer_rmcios channel_name_borrow (const struct context_rmcios
+                                          *context, int channel_id,
+                                          char *name_to, int maxlen);
+
+
+// ***********************************************************************
+// Conversion plans:
+// ***********************************************************************
+
+/// @brief Function that converts single parameter to return structure.
+/// @param context pointer to target system context
+/// @param param array of parameters in plan source type
+/// @param index index of the parameter to be converted
+/// @param returnv return structure in plan target type
+typedef void (*convert_func_rmcios) (const struct context_rmcios *context,
+                                     union param_rmcios param, int index,
+                                     struct combo_rmcios *returnv);
+
+/// @brief Conversion plan for (source type, target type) pair.
+struct conversion_plan_rmcios
+{
+    enum type_rmcios from;
+    enum type_rmcios to;
+    /// Conversion function specialized for the type pair.
+    convert_func_rmcios convert;
+    /// Non-zero when conversion is made by the context convert channel.
+    /// On combo, array, gather and inline sources non-zero when
+    /// conversion of some element type is made by the channel.
+    int uses_channel;
+    /// Non-zero when buffer result can refer to source data without copy.
+    int zero_copy;
+};
+
+/// @brief Get conversion plan for source and target types.
+///
+/// Plan is decided once and called directly on each conversion.
+/// Type pairs without specialized conversion use the convert channel.
+/// @param from type of source parameters
+/// @param to type of return structure
+/// @return conversion plan
+///
+/// @snippet examples.c conversion_plan
+struct conversion_plan_rmcios conversion_plan (enum type_rmcios from,
+                                               enum type_rmcios to);
+
+// Array views:
+
+/// @brief Size of single array element of numeric type
+///
+/// @param type element type
+/// @return size in bytes. 0 for non-numeric types.
+int array_element_size (enum type_rmcios type);
+
+/// @brief Make strided array view
+///
+/// @param type type of the elements
+/// @param data pointer to first element
+/// @param count number of elements
+/// @param stride distance between elements in bytes. 0 on contiguous.
+/// @return array view structure
+struct array_rmcios make_array (enum type_rmcios type, void *data,
+                                int count, int stride);
+
+/// @brief Get element of array view parameters
+///
+/// Helper function for implementing channels
+/// @param param array_rmcios parameters
+/// @param index index of element across all views
+/// @param[out] type type of the element
+/// @return parameter pointing to the element.
+///         Index must be less than number of parameters.
+union param_rmcios array_element (union param_rmcios param, int index,
+                                  enum type_rmcios *type);
+
+/// @brief Write array view to channel
+///
+/// Elements are passed without copy as array_rmcios parameter.
+/// @param context pointer to target system context
+/// @param channel handle of channel to be written
+/// @param array array view to be written
+void write_array (const struct context_rmcios *context, int channel,
+                  const struct array_rmcios *array);
+
+/// @brief Convert elements between array views
+///
+/// Converts min(src->count, dst->count) elements. 
+/// Numeric conversions are made directly without the convert channel.
+/// @param context pointer to target system context
+/// @param src source array view
+/// @param dst destination array view
+/// @return number of converted elements
+int convert_array (const struct context_rmcios *context,
+                   const struct array_rmcios *src,
+                   struct array_rmcios *dst);
+
+/// @brief Convert parameters to array
+///
+/// Helper function for implementing channels
+/// @param context pointer to target system context
+/// @param paramtype type of @p param array
+/// @param num_params number of parameters
+/// @param param array of parameters
+/// @param dst destination array view
+/// @return number of converted elements
+int param_to_array (const struct context_rmcios *context,
+                    enum type_rmcios paramtype, int num_params,
+                    union param_rmcios param, struct array_rmcios *dst);
+
+// Inline short strings:
+
+/// @brief Make inline string
+///
+/// Data longer than INLINE_BUFFER_SIZE is truncated.
+/// @param data data to be stored inline
+/// @param length length of @p data. -1 on NULL-terminated string.
+/// @return inline string
+struct inline_rmcios make_inline (const char *data, int length);
+
+/// @brief Read short string from channel to inline storage
+///
+/// Returned strings and buffers are stored without the convert channel.
+/// @param context pointer to target system context
+/// @param channel handle of channel to be read
+/// @param str inline string to read to
+/// @return length of the read string
+int read_inline (const struct context_rmcios *context, int channel,
+                 struct inline_rmcios *str);
+
+// Scatter-gather buffer chains:
+
+/// @brief Total length of gather chain
+///
+/// @param gather gather chain
+/// @return sum of segment lengths
+int gather_length (const struct gather_rmcios *gather);
+
+/// @brief Copy gather chain to contiguous buffer
+///
+/// @param gather gather chain
+/// @param buffer destination buffer
+/// @param size size of @p buffer
+/// @return total length of the chain. Data is truncated to @p size.
+int linearize_gather (const struct gather_rmcios *gather,
+                      char *buffer, int size);
+
+/// @brief Write scatter-gather chain to channel
+///
+/// Segments are passed as single gather_rmcios parameter without copy.
+/// Channels that read parameters with param_to_binary, param_to_buffer or
+/// param_to_string get the payload linearized.
+/// @param context pointer to target system context
+/// @param channel handle of channel to be written
+/// @param segments array of segments
+/// @param count number of segments
+void write_gather (const struct context_rmcios *context, int channel,
+                   struct buffer_rmcios *segments, int count);
+
 // Legacy functions for old-style channel modules:
 
 /// Convert parameter to channel handle or integer. 
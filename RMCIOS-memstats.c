@@ -0,0 +1,328 @@
+/*
+RMCIOS - Reactive Multipurpose Control Input Output System
+Copyright (c) 2018 Frans Korhonen
+
+RMCIOS was originally developed at Institute for Atmospheric 
+and Earth System Research / Physics, Faculty of Science, 
+University of Helsinki, Finland
+
+Assistance, experience and feedback from following persons have been 
+critical for development of RMCIOS: Erkki Siivola, Juha Kangasluoma, 
+Lauri Ahonen, Ella Häkkinen, Pasi Aalto, Joonas Enroth, Runlong Cai, 
+Markku Kulmala and Tuukka Petäjä.
+
+This file is part of RMCIOS. This notice was encoded using utf-8.
+
+RMCIOS is free software: you can redistribute this file and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RMCIOS is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public Licenses
+along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RMCIOS-memstats.h"
+#include "RMCIOS-functions.h"
+
+#include <stdio.h>
+#include <stdint.h>
+
+// Block table is filled at most to 3/4 to keep probe sequences short
+#define MAX_BLOCKS (MEMSTATS_BLOCKS / 4 * 3)
+
+static unsigned int block_slot (const void *ptr)
+{
+    return (unsigned int) (((uintptr_t) ptr >> 4) * 2654435761u)
+        & (MEMSTATS_BLOCKS - 1);
+}
+
+// Find tracked block. -1 when block is not in the table.
+static int find_block (struct memstats_rmcios *stats, const void *ptr)
+{
+    unsigned int index = block_slot (ptr);
+    while (stats->blocks[index].ptr != 0)
+    {
+        if (stats->blocks[index].ptr == ptr)
+        {
+            return index;
+        }
+        index = (index + 1) & (MEMSTATS_BLOCKS - 1);
+    }
+    return -1;
+}
+
+// Remove block from the table. Following blocks of the probe sequence 
+// are moved to fill the gap.
+static void remove_block (struct memstats_rmcios *stats, unsigned int gap)
+{
+    unsigned int index = gap;
+    stats->blocks[gap].ptr = 0;
+    for (;;)
+    {
+        unsigned int home;
+        index = (index + 1) & (MEMSTATS_BLOCKS - 1);
+        if (stats->blocks[index].ptr == 0)
+        {
+            break;
+        }
+        home = block_slot (stats->blocks[index].ptr);
+        // Move when home slot is not between the gap and the block
+        if (((index - home) & (MEMSTATS_BLOCKS - 1))
+            >= ((index - gap) & (MEMSTATS_BLOCKS - 1)))
+        {
+            stats->blocks[gap] = stats->blocks[index];
+            stats->blocks[index].ptr = 0;
+            gap = index;
+        }
+    }
+    stats->num_blocks--;
+}
+
+// Find or add stats entry of channel. -1 when table is full.
+static int find_entry (struct memstats_rmcios *stats, int channel, int add)
+{
+    unsigned int hash = (unsigned int) channel * 2654435761u;
+    int i;
+    for (i = 0; i < MEMSTATS_SLOTS; i++)
+    {
+        int index = (hash + i) & (MEMSTATS_SLOTS - 1);
+        struct memstats_entry_rmcios *entry = stats->entries + index;
+        if (entry->channel == channel)
+        {
+            return index;
+        }
+        if (entry->channel == -1)
+        {
+            if (!add)
+            {
+                return -1;
+            }
+            entry->channel = channel;
+            entry->count = 0;
+            entry->live = 0;
+            entry->peak = 0;
+            return index;
+        }
+    }
+    return -1;
+}
+
+static void *memstats_allocate (struct memstats_rmcios *stats, int size)
+{
+    void *ptr = allocate_storage (stats->parent, size, 0);
+    struct memstats_block_rmcios *block;
+    int index;
+
+    if (ptr == 0)
+    {
+        return 0;
+    }
+    if (stats->num_blocks >= MAX_BLOCKS)
+    {
+        // Untracked block is freed without accounting
+        stats->overflows++;
+        return ptr;
+    }
+    block = stats->blocks + block_slot (ptr);
+    while (block->ptr != 0)
+    {
+        block = (block + 1 == stats->blocks + MEMSTATS_BLOCKS) ?
+            stats->blocks : block + 1;
+    }
+    index = find_entry (stats, stats->current, 1);
+    block->ptr = ptr;
+    block->entry = index;
+    block->size = size;
+    stats->num_blocks++;
+    if (index < 0)
+    {
+        stats->overflows++;
+    }
+    else
+    {
+        struct memstats_entry_rmcios *entry = stats->entries + index;
+        entry->count++;
+        entry->live += size;
+        if (entry->live > entry->peak)
+        {
+            entry->peak = entry->live;
+        }
+    }
+    return ptr;
+}
+
+static void memstats_free (struct memstats_rmcios *stats, void *ptr)
+{
+    int index;
+    if (ptr == 0)
+    {
+        return;
+    }
+    index = find_block (stats, ptr);
+    if (index >= 0)
+    {
+        const struct memstats_block_rmcios *block = stats->blocks + index;
+        if (block->entry >= 0)
+        {
+            struct memstats_entry_rmcios *entry =
+                stats->entries + block->entry;
+            entry->count--;
+            entry->live -= block->size;
+        }
+        remove_block (stats, index);
+    }
+    // Blocks not in the table are freed without accounting
+    free_storage (stats->parent, ptr, 0);
+}
+
+// Format stats of all channels
+static int memstats_report (struct memstats_rmcios *stats,
+                            char *report, int size)
+{
+    int length = snprintf (report, size, "channel live peak count\r\n");
+    int i;
+    for (i = 0; i < MEMSTATS_SLOTS && length < size; i++)
+    {
+        const struct memstats_entry_rmcios *entry = stats->entries + i;
+        char name[32];
+        struct buffer_rmcios bname;
+        if (entry->channel == -1)
+        {
+            continue;
+        }
+        bname = channel_name_borrow (stats->parent, entry->channel,
+                                     name, sizeof (name));
+        if (bname.length == 0)
+        {
+            bname.data = "-";
+            bname.length = 1;
+        }
+        length += snprintf (report + length, size - length,
+                            "%.*s(%d) %lld %lld %u\r\n",
+                            (int) bname.length, bname.data, entry->channel,
+                            entry->live, entry->peak, entry->count);
+    }
+    return (length < size) ? length : size - 1;
+}
+
+// Accounting storage channel. Same interface as the mem channel.
+static void memstats_class_func (struct memstats_rmcios *this,
+                                 const struct context_rmcios *context,
+                                 int id,
+                                 enum function_rmcios function,
+                                 enum type_rmcios paramtype,
+                                 struct combo_rmcios *returnv,
+                                 int num_params,
+                                 const union param_rmcios param)
+{
+    switch (function)
+    {
+    case help_rmcios:
+        return_string (context, returnv,
+                       "memstats channel - memory accounting per channel\r\n"
+                       "write memstats size"
+                       " #allocate. Returns pointer as binary\r\n"
+                       "write memstats 0 pointer #free pointer\r\n"
+                       "read memstats #report of all channels\r\n"
+                       "read memstats channel #live bytes of channel\r\n");
+        break;
+
+    case write_rmcios:
+        if (num_params == 1)
+        {
+            int size = 0;
+            void *ptr;
+            param_to_binary (context, paramtype, param, 0,
+                             sizeof (size), &size);
+            ptr = memstats_allocate (this, size);
+            return_binary (context, returnv, (char *) &ptr, sizeof (ptr));
+        }
+        else if (num_params >= 2)
+        {
+            void *ptr = 0;
+            param_to_binary (context, paramtype, param, 1,
+                             sizeof (ptr), &ptr);
+            memstats_free (this, ptr);
+        }
+        break;
+
+    case read_rmcios:
+        if (num_params >= 1)
+        {
+            const struct memstats_entry_rmcios *entry =
+                memstats_get (this, param_to_channel (context, paramtype,
+                                                      param, 0));
+            return_int64 (context, returnv, entry ? entry->live : 0);
+        }
+        else
+        {
+            char report[MEMSTATS_REPORT_SIZE];
+            int length = memstats_report (this, report, sizeof (report));
+            return_buffer_chunked (context, returnv, report, length);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+// Track running channel. Calls to the accounting channel are not tracked.
+static void memstats_run (void *data,
+                          const struct context_rmcios *context,
+                          int id,
+                          enum function_rmcios function,
+                          enum type_rmcios paramtype,
+                          struct combo_rmcios *returnv,
+                          int num_params, union param_rmcios param)
+{
+    struct memstats_rmcios *stats = (struct memstats_rmcios *) data;
+    int previous = stats->current;
+    if (id != stats->id)
+    {
+        stats->current = id;
+    }
+    stats->parent->run_channel (stats->parent->data, context, id, function,
+                                paramtype, returnv, num_params, param);
+    stats->current = previous;
+}
+
+const struct memstats_entry_rmcios *memstats_get (struct memstats_rmcios
+                                                  *stats, int channel)
+{
+    int index = find_entry (stats, channel, 0);
+    return (index < 0) ? 0 : stats->entries + index;
+}
+
+const struct context_rmcios *memstats_init (struct memstats_rmcios *stats,
+                                            const struct context_rmcios
+                                            *parent)
+{
+    int i;
+    stats->parent = parent;
+    stats->current = 0;
+    stats->overflows = 0;
+    stats->num_blocks = 0;
+    for (i = 0; i < MEMSTATS_SLOTS; i++)
+    {
+        stats->entries[i].channel = -1;
+    }
+    for (i = 0; i < MEMSTATS_BLOCKS; i++)
+    {
+        stats->blocks[i].ptr = 0;
+    }
+    stats->id = create_channel_str (parent, "memstats",
+                                    (class_rmcios) memstats_class_func,
+                                    stats);
+    copy_context (&stats->context, parent);
+    stats->context.run_channel = memstats_run;
+    stats->context.data = stats;
+    stats->context.mem = stats->id;
+    return &stats->context;
+}
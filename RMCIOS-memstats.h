@@ -0,0 +1,128 @@
+/*
+RMCIOS - Reactive Multipurpose Control Input Output System
+Copyright (c) 2018 Frans Korhonen
+
+RMCIOS was originally developed at Institute for Atmospheric 
+and Earth System Research / Physics, Faculty of Science, 
+University of Helsinki, Finland
+
+Assistance, experience and feedback from following persons have been 
+critical for development of RMCIOS: Erkki Siivola, Juha Kangasluoma, 
+Lauri Ahonen, Ella Häkkinen, Pasi Aalto, Joonas Enroth, Runlong Cai, 
+Markku Kulmala and Tuukka Petäjä.
+
+This file is part of RMCIOS. This notice was encoded using utf-8.
+
+RMCIOS is free software: you can redistribute this file and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RMCIOS is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public Licenses
+along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file RMCIOS-memstats.h
+ * @author Frans Korhonen
+ * @brief Memory accounting per channel.
+ *
+ * Context wrapper that replaces the mem channel of the context with an
+ * accounting storage channel. Each allocation is tagged with the channel
+ * that was running when allocate_storage was called. Live bytes, peak 
+ * bytes and number of allocations are kept per channel in fixed side 
+ * table. Memory is allocated from the mem channel of the parent context.
+ * Live blocks are tracked by pointer in fixed block table. Blocks not in
+ * the table, allocated from the parent before the wrapper was installed
+ * or while the block table was full, are freed to the parent without 
+ * accounting.
+ *
+ * Channels must be given the wrapper context (memstats.context).
+ * Calls through the wrapper are expected from single thread.
+ *
+ * Stats are read from the accounting channel:
+ *   read memstats           # report of all channels
+ *   read memstats channel   # live bytes of channel
+ *
+ * Changelog: (date,who,description)
+ *
+ * */
+#ifndef rmcios_memstats_h
+#define rmcios_memstats_h
+
+#include "RMCIOS-API.h"
+
+/// Number of channels in stats table. Power of 2.
+#ifndef MEMSTATS_SLOTS
+#define MEMSTATS_SLOTS 1024
+#endif
+
+/// Number of tracked live blocks. Power of 2.
+#ifndef MEMSTATS_BLOCKS
+#define MEMSTATS_BLOCKS 4096
+#endif
+
+/// Size of text report buffer
+#ifndef MEMSTATS_REPORT_SIZE
+#define MEMSTATS_REPORT_SIZE 8192
+#endif
+
+/// @brief Memory stats of channel
+struct memstats_entry_rmcios
+{
+    /// Channel id. -1 on unused entry. 0 for allocations outside channels.
+    int channel;
+    unsigned int count;
+    long long live;
+    long long peak;
+};
+
+/// @brief Live block allocated through the accounting channel
+struct memstats_block_rmcios
+{
+    /// Block pointer. 0 on unused block.
+    void *ptr;
+    /// Index of stats entry. -1 when not accounted.
+    int entry;
+    int size;
+};
+
+/// @brief Memory accounting wrapper
+struct memstats_rmcios
+{
+    /// Wrapper context given to channels
+    struct context_rmcios context;
+    const struct context_rmcios *parent;
+    /// Accounting storage channel
+    int id;
+    /// Channel that is currently running
+    int current;
+    /// Allocations that did not fit the stats or block table
+    unsigned int overflows;
+    /// Number of tracked live blocks
+    unsigned int num_blocks;
+    struct memstats_entry_rmcios entries[MEMSTATS_SLOTS];
+    struct memstats_block_rmcios blocks[MEMSTATS_BLOCKS];
+};
+
+/// @brief Initialize memory accounting wrapper
+///
+/// Creates the accounting storage channel named memstats.
+/// @param stats wrapper to be initialized
+/// @param parent context that allocates the memory
+/// @return wrapper context for channels
+const struct context_rmcios *memstats_init (struct memstats_rmcios *stats,
+                                            const struct context_rmcios
+                                            *parent);
+
+/// @brief Get stats of channel
+/// @return pointer to stats. 0 when channel has not allocated memory.
+const struct memstats_entry_rmcios *memstats_get (struct memstats_rmcios
+                                                  *stats, int channel);
+
+#endif
@@ -0,0 +1,337 @@
+/*
+RMCIOS - Reactive Multipurpose Control Input Output System
+Copyright (c) 2018 Frans Korhonen
+
+RMCIOS was originally developed at Institute for Atmospheric 
+and Earth System Research / Physics, Faculty of Science, 
+University of Helsinki, Finland
+
+Assistance, experience and feedback from following persons have been 
+critical for development of RMCIOS: Erkki Siivola, Juha Kangasluoma, 
+Lauri Ahonen, Ella Häkkinen, Pasi Aalto, Joonas Enroth, Runlong Cai, 
+Markku Kulmala and Tuukka Petäjä.
+
+This file is part of RMCIOS. This notice was encoded using utf-8.
+
+RMCIOS is free software: you can redistribute this file and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RMCIOS is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public Licenses
+along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RMCIOS-onchange.h"
+#include "RMCIOS-functions.h"
+
+#include <string.h>
+#include <time.h>
+
+// Current time in nanoseconds. Context clock is preferred.
+static long long onchange_time (const struct context_rmcios *context)
+{
+    if (context_clock (context) != 0)
+    {
+        return read_time (context);
+    }
+    else
+    {
+        struct timespec now;
+        clock_gettime (CLOCK_MONOTONIC, &now);
+        return now.tv_sec * 1000000000LL + now.tv_nsec;
+    }
+}
+
+static int is_numeric (enum type_rmcios paramtype)
+{
+    return paramtype == int_rmcios || paramtype == float_rmcios
+        || paramtype == int64_rmcios || paramtype == double_rmcios;
+}
+
+// Bit pattern of numeric parameter
+static unsigned long long numeric_bits (enum type_rmcios paramtype,
+                                        const union param_rmcios param,
+                                        int index)
+{
+    unsigned long long bits = 0;
+    switch (paramtype)
+    {
+    case int_rmcios:
+        memcpy (&bits, param.iv + index, sizeof (param.iv[0]));
+        break;
+    case float_rmcios:
+        memcpy (&bits, param.fv + index, sizeof (param.fv[0]));
+        break;
+    case int64_rmcios:
+        memcpy (&bits, param.lv + index, sizeof (param.lv[0]));
+        break;
+    case double_rmcios:
+        memcpy (&bits, param.dv + index, sizeof (param.dv[0]));
+        break;
+    default:
+        break;
+    }
+    return bits;
+}
+
+// Value of numeric parameter. Read by type: double is not known by
+// convert channels of every system.
+static double numeric_value (enum type_rmcios paramtype,
+                             const union param_rmcios param, int index)
+{
+    switch (paramtype)
+    {
+    case int_rmcios:
+        return param.iv[index];
+    case float_rmcios:
+        return param.fv[index];
+    case int64_rmcios:
+        return (double) param.lv[index];
+    case double_rmcios:
+        return param.dv[index];
+    default:
+        return 0;
+    }
+}
+
+// FNV-1a hash of data
+static unsigned int hash_bytes (unsigned int hash, const char *data,
+                                unsigned int length)
+{
+    unsigned int i;
+    for (i = 0; i < length; i++)
+    {
+        hash = (hash ^ (unsigned char) data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Hash of single parameter. Buffer data is hashed whole without copy.
+static unsigned int hash_param (unsigned int hash,
+                                const struct context_rmcios *context,
+                                enum type_rmcios paramtype,
+                                const union param_rmcios param, int index)
+{
+    unsigned int length = 0;
+    switch (paramtype)
+    {
+    case buffer_rmcios:
+    case binary_rmcios:
+    case moved_rmcios:
+        length = param.bv[index].length;
+        hash = hash_bytes (hash, param.bv[index].data, length);
+        break;
+
+    case gather_rmcios:
+        {
+            const struct gather_rmcios *gather = param.gv + index;
+            int i;
+            for (i = 0; i < gather->count; i++)
+            {
+                length += gather->segments[i].length;
+                hash = hash_bytes (hash, gather->segments[i].data,
+                                   gather->segments[i].length);
+            }
+            break;
+        }
+
+    case inline_rmcios:
+        length = param.inv[index].length;
+        hash = hash_bytes (hash, param.inv[index].data, length);
+        break;
+
+    case combo_rmcios:
+        {
+            const struct combo_rmcios *combo = param.cv;
+            while (index >= combo->num_params)
+            {
+                index -= combo->num_params;
+                combo++;
+            }
+            return hash_param (hash, context, combo->paramtype,
+                               combo->param, index);
+        }
+
+    default:
+        {
+            // Numbers and array elements are hashed by their binary copy
+            char data[ONCHANGE_HASH_SIZE];
+            struct buffer_rmcios b = param_to_binary (context, paramtype,
+                                                      param, index,
+                                                      sizeof (data), data);
+            length = b.required_size;
+            hash = hash_bytes (hash, b.data, b.length);
+            break;
+        }
+    }
+    // Separate parameters
+    return (hash ^ (length + 1)) * 16777619u;
+}
+
+// FNV-1a hash of parameter data
+static unsigned int param_hash (const struct context_rmcios *context,
+                                enum type_rmcios paramtype,
+                                int num_params,
+                                const union param_rmcios param)
+{
+    unsigned int hash = 2166136261u;
+    int i;
+    for (i = 0; i < num_params; i++)
+    {
+        hash = hash_param (hash, context, paramtype, param, i);
+    }
+    return hash;
+}
+
+int onchange_test (struct onchange_rmcios *filter,
+                   enum type_rmcios paramtype,
+                   int num_params, const union param_rmcios param)
+{
+    const struct context_rmcios *context = filter->context;
+    int numeric = is_numeric (paramtype) && num_params <= ONCHANGE_MAX_PARAMS;
+    long long now = onchange_time (context);
+    int changed = !filter->valid || filter->paramtype != paramtype
+        || filter->num_params != num_params;
+    unsigned int hash = 0;
+    int i;
+
+    if (!numeric)
+    {
+        hash = param_hash (context, paramtype, num_params, param);
+        changed = changed || hash != filter->hash;
+    }
+    for (i = 0; numeric && !changed && i < num_params; i++)
+    {
+        if (filter->deadband > 0)
+        {
+            double difference = numeric_value (paramtype, param, i)
+                - filter->values[i];
+            changed = difference >= filter->deadband
+                || difference <= -filter->deadband;
+        }
+        else
+        {
+            changed = numeric_bits (paramtype, param, i) != filter->bits[i];
+        }
+    }
+    if (!changed && filter->refresh > 0
+        && now - filter->last_pass >= filter->refresh)
+    {
+        changed = 1;
+    }
+    if (!changed)
+    {
+        filter->suppressed++;
+        return 0;
+    }
+
+    // Store passed parameters
+    filter->valid = 1;
+    filter->paramtype = paramtype;
+    filter->num_params = num_params;
+    filter->hash = hash;
+    for (i = 0; numeric && i < num_params; i++)
+    {
+        filter->bits[i] = numeric_bits (paramtype, param, i);
+        filter->values[i] = numeric_value (paramtype, param, i);
+    }
+    filter->last_pass = now;
+    filter->passed++;
+    return 1;
+}
+
+void onchange_init (struct onchange_rmcios *filter,
+                    const struct context_rmcios *context,
+                    double deadband, int refresh_ms)
+{
+    memset (filter, 0, sizeof (*filter));
+    filter->context = context;
+    filter->deadband = deadband;
+    filter->refresh = refresh_ms * 1000000LL;
+}
+
+void onchange_class_func (struct onchange_rmcios *this,
+                          const struct context_rmcios *context,
+                          int id,
+                          enum function_rmcios function,
+                          enum type_rmcios paramtype,
+                          struct combo_rmcios *returnv,
+                          int num_params, const union param_rmcios param)
+{
+    switch (function)
+    {
+    case help_rmcios:
+        return_string (context, returnv,
+                       "onchange channel"
+                       " - pass writes to linked channels on change\r\n"
+                       "create onchange newname\r\n"
+                       "setup newname deadband refresh_ms"
+                       " #numeric deadband and forced refresh time\r\n"
+                       "write newname params"
+                       " #pass to linked channels when changed\r\n"
+                       "write newname #pass next write unconditionally\r\n"
+                       "read newname #number of suppressed writes\r\n");
+        break;
+
+    case create_rmcios:
+        if (num_params < 1)
+            break;
+        this = (struct onchange_rmcios *)
+            allocate_storage (context, sizeof (struct onchange_rmcios), 0);
+        if (this == 0)
+            break;
+        onchange_init (this, context, 0, 0);
+        this->id = create_channel_param (context, paramtype, param, 0,
+                                         (class_rmcios) onchange_class_func,
+                                         this);
+        break;
+
+    case setup_rmcios:
+        if (this == 0 || num_params < 1)
+            break;
+        this->deadband = param_to_double (context, paramtype, param, 0);
+        if (num_params >= 2)
+        {
+            this->refresh = param_to_integer (context, paramtype, param, 1)
+                * 1000000LL;
+        }
+        this->valid = 0;
+        break;
+
+    case write_rmcios:
+        if (this == 0)
+            break;
+        if (num_params == 0)
+        {
+            this->valid = 0;
+        }
+        else if (onchange_test (this, paramtype, num_params, param))
+        {
+            run_channel (context, linked_channels (context, id),
+                         write_rmcios, paramtype, returnv, num_params,
+                         param);
+        }
+        break;
+
+    case read_rmcios:
+        if (this == 0)
+            break;
+        return_int (context, returnv, this->suppressed);
+        break;
+
+    default:
+        break;
+    }
+}
+
+void init_onchange_channels (const struct context_rmcios *context)
+{
+    create_channel_str (context, "onchange",
+                        (class_rmcios) onchange_class_func, 0);
+}
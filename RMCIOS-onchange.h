@@ -0,0 +1,114 @@
+/*
+RMCIOS - Reactive Multipurpose Control Input Output System
+Copyright (c) 2018 Frans Korhonen
+
+RMCIOS was originally developed at Institute for Atmospheric 
+and Earth System Research / Physics, Faculty of Science, 
+University of Helsinki, Finland
+
+Assistance, experience and feedback from following persons have been 
+critical for development of RMCIOS: Erkki Siivola, Juha Kangasluoma, 
+Lauri Ahonen, Ella Häkkinen, Pasi Aalto, Joonas Enroth, Runlong Cai, 
+Markku Kulmala and Tuukka Petäjä.
+
+This file is part of RMCIOS. This notice was encoded using utf-8.
+
+RMCIOS is free software: you can redistribute this file and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RMCIOS is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public Licenses
+along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file RMCIOS-onchange.h
+ * @author Frans Korhonen
+ * @brief Change detection filter for linked channels.
+ *
+ * Filter channel is placed in a link chain. Writes are passed to the 
+ * linked channels of the filter only when the parameters have changed
+ * from the last passed write. Numeric parameters (int, float, int64,
+ * double) are compared bitwise, or against the deadband when deadband
+ * is set. Other parameters are compared by hash of their data.
+ * Unchanged value is passed anyway when the refresh time has elapsed.
+ *
+ *   create onchange status_changes
+ *   setup status_changes deadband refresh_ms
+ *   link status status_changes
+ *   link status_changes logger
+ *
+ * Channel implementations can filter own links with onchange_test().
+ * Filter is not thread safe.
+ *
+ * Changelog: (date,who,description)
+ *
+ * */
+#ifndef rmcios_onchange_h
+#define rmcios_onchange_h
+
+#include "RMCIOS-API.h"
+
+/// Maximum number of compared parameters. More parameters are hashed.
+#ifndef ONCHANGE_MAX_PARAMS
+#define ONCHANGE_MAX_PARAMS 8
+#endif
+
+/// Size of copy for hashing converted parameters.
+/// Buffer and gather data is hashed whole.
+#ifndef ONCHANGE_HASH_SIZE
+#define ONCHANGE_HASH_SIZE 256
+#endif
+
+/// @brief Change detection filter data
+struct onchange_rmcios
+{
+    const struct context_rmcios *context;
+    int id;
+    /// Numeric change smaller than this is not a change. 0 for bitwise.
+    double deadband;
+    /// Pass unchanged value after this time (ns). 0 for no refresh.
+    long long refresh;
+    /// Time of last passed write (ns)
+    long long last_pass;
+    /// Set when last parameters are stored
+    int valid;
+    enum type_rmcios paramtype;
+    int num_params;
+    /// Hash of non numeric parameters
+    unsigned int hash;
+    /// Last passed numeric values
+    double values[ONCHANGE_MAX_PARAMS];
+    /// Bit patterns of last passed numeric values
+    unsigned long long bits[ONCHANGE_MAX_PARAMS];
+    unsigned int passed;
+    unsigned int suppressed;
+};
+
+/// @brief Register onchange channel class to the context.
+void init_onchange_channels (const struct context_rmcios *context);
+
+/// @brief Initialize change detection filter
+/// @param filter filter to be initialized
+/// @param context pointer to target system context
+/// @param deadband numeric deadband. 0 for bitwise compare.
+/// @param refresh_ms refresh time in milliseconds. 0 for no refresh.
+void onchange_init (struct onchange_rmcios *filter,
+                    const struct context_rmcios *context,
+                    double deadband, int refresh_ms);
+
+/// @brief Test if parameters should be passed
+///
+/// Parameters are stored as the last passed when they are passed.
+/// @return 1 when parameters changed or refresh is due. 0 otherwise.
+int onchange_test (struct onchange_rmcios *filter,
+                   enum type_rmcios paramtype,
+                   int num_params, const union param_rmcios param);
+
+#endif
@@ -0,0 +1,462 @@
+/*
+RMCIOS - Reactive Multipurpose Control Input Output System
+Copyright (c) 2018 Frans Korhonen
+
+RMCIOS was originally developed at Institute for Atmospheric 
+and Earth System Research / Physics, Faculty of Science, 
+University of Helsinki, Finland
+
+Assistance, experience and feedback from following persons have been 
+critical for development of RMCIOS: Erkki Siivola, Juha Kangasluoma, 
+Lauri Ahonen, Ella Häkkinen, Pasi Aalto, Joonas Enroth, Runlong Cai, 
+Markku Kulmala and Tuukka Petäjä.
+
+This file is part of RMCIOS. This notice was encoded using utf-8.
+
+RMCIOS is free software: you can redistribute this file and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RMCIOS is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public Licenses
+along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RMCIOS-perfcount.h"
+#include "RMCIOS-functions.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static const char *event_names[perfcount_events] = {
+    "cycles",
+    "instructions",
+    "cache-misses",
+    "task-clock",
+    "page-faults"
+};
+
+static const char *function_name (enum function_rmcios function)
+{
+    switch (function)
+    {
+    case help_rmcios:
+        return "help";
+    case setup_rmcios:
+        return "setup";
+    case write_rmcios:
+        return "write";
+    case read_rmcios:
+        return "read";
+    case create_rmcios:
+        return "create";
+    case link_rmcios:
+        return "link";
+    default:
+        return "?";
+    }
+}
+
+#ifdef __linux__
+// Open counter of the calling thread. Returns file descriptor or -1.
+static int open_counter (enum perfcount_event_rmcios event, int group_fd)
+{
+    struct perf_event_attr attr;
+    memset (&attr, 0, sizeof (attr));
+    attr.size = sizeof (attr);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP
+        | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    switch (event)
+    {
+    case perfcount_cycles:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+        break;
+    case perfcount_instructions:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+        break;
+    case perfcount_cache_misses:
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        break;
+    case perfcount_task_clock:
+        attr.type = PERF_TYPE_SOFTWARE;
+        attr.config = PERF_COUNT_SW_TASK_CLOCK;
+        break;
+    case perfcount_page_faults:
+        attr.type = PERF_TYPE_SOFTWARE;
+        attr.config = PERF_COUNT_SW_PAGE_FAULTS;
+        break;
+    default:
+        return -1;
+    }
+    return (int) syscall (__NR_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+#endif
+
+// Read all counters. Unavailable counters read as 0.
+static void read_counters (struct perfcount_rmcios *perfcount,
+                           struct perfcount_sample_rmcios *sample)
+{
+    int event;
+#ifdef __linux__
+    // Group read: number of counters, time enabled, time running, values
+    unsigned long long group[3 + perfcount_events];
+    if (perfcount->group_fd >= 0
+        && read (perfcount->group_fd, group, sizeof (group)) > 0)
+    {
+        sample->enabled = group[1];
+        sample->running = group[2];
+        for (event = 0; event < perfcount_events; event++)
+        {
+            int position = perfcount->positions[event];
+            sample->values[event] = (position >= 0) ?
+                group[3 + position] : 0;
+        }
+        return;
+    }
+#endif
+    sample->enabled = 0;
+    sample->running = 0;
+    for (event = 0; event < perfcount_events; event++)
+    {
+        sample->values[event] = 0;
+    }
+}
+
+// Count of event between two samples. When the counters shared the
+// hardware with others, the count is scaled to the enabled time of 
+// the interval.
+static unsigned long long sample_delta (const struct perfcount_sample_rmcios
+                                        *start,
+                                        const struct perfcount_sample_rmcios
+                                        *end, int event)
+{
+    unsigned long long value;
+    unsigned long long enabled = end->enabled - start->enabled;
+    unsigned long long running = end->running - start->running;
+    if (end->values[event] <= start->values[event])
+    {
+        return 0;
+    }
+    value = end->values[event] - start->values[event];
+    if (end->running >= start->running && end->enabled >= start->enabled
+        && running > 0 && running < enabled)
+    {
+        value = (unsigned long long) ((double) value * enabled / running);
+    }
+    return value;
+}
+
+// Find or add entry of channel function. 0 when table is full.
+static struct perfcount_entry_rmcios *find_entry (struct perfcount_rmcios
+                                                  *perfcount, int channel,
+                                                  enum function_rmcios
+                                                  function, int add)
+{
+    unsigned int hash = ((unsigned int) channel * 8 + function)
+        * 2654435761u;
+    int i;
+    for (i = 0; i < PERFCOUNT_SLOTS; i++)
+    {
+        struct perfcount_entry_rmcios *entry =
+            perfcount->entries + ((hash + i) & (PERFCOUNT_SLOTS - 1));
+        if (entry->channel == channel && entry->function == function)
+        {
+            return entry;
+        }
+        if (entry->channel == -1)
+        {
+            if (!add)
+            {
+                return 0;
+            }
+            memset (entry, 0, sizeof (*entry));
+            entry->channel = channel;
+            entry->function = function;
+            return entry;
+        }
+    }
+    return 0;
+}
+
+int perfcount_available (const struct perfcount_rmcios *perfcount,
+                         enum perfcount_event_rmcios event)
+{
+    return perfcount->positions[event] >= 0;
+}
+
+const struct perfcount_entry_rmcios *perfcount_get (struct perfcount_rmcios
+                                                    *perfcount, int channel,
+                                                    enum function_rmcios
+                                                    function)
+{
+    return find_entry (perfcount, channel, function, 0);
+}
+
+void perfcount_clear (struct perfcount_rmcios *perfcount)
+{
+    int i;
+    for (i = 0; i < PERFCOUNT_SLOTS; i++)
+    {
+        perfcount->entries[i].channel = -1;
+    }
+    perfcount->overflows = 0;
+    perfcount->other_threads = 0;
+}
+
+int perfcount_report (struct perfcount_rmcios *perfcount,
+                      char *buffer, int size)
+{
+    int length = snprintf (buffer, size, "function calls");
+    int event;
+    int i;
+
+    for (event = 0; event < perfcount_events && length < size; event++)
+    {
+        if (perfcount_available (perfcount, event))
+        {
+            length += snprintf (buffer + length, size - length,
+                                " %s self", event_names[event]);
+        }
+    }
+    if (length < size)
+    {
+        length += snprintf (buffer + length, size - length, "\r\n");
+    }
+    for (i = 0; i < PERFCOUNT_SLOTS && length < size; i++)
+    {
+        const struct perfcount_entry_rmcios *entry = perfcount->entries + i;
+        char name[32];
+        struct buffer_rmcios bname;
+        if (entry->channel == -1)
+        {
+            continue;
+        }
+        bname = channel_name_borrow (perfcount->parent, entry->channel,
+                                     name, sizeof (name));
+        if (bname.length > 0)
+        {
+            length += snprintf (buffer + length, size - length,
+                                "%.*s.%s %u", (int) bname.length,
+                                bname.data, function_name (entry->function),
+                                entry->calls);
+        }
+        else
+        {
+            length += snprintf (buffer + length, size - length,
+                                "#%d.%s %u", entry->channel,
+                                function_name (entry->function),
+                                entry->calls);
+        }
+        for (event = 0; event < perfcount_events && length < size; event++)
+        {
+            if (perfcount_available (perfcount, event))
+            {
+                length += snprintf (buffer + length, size - length,
+                                    " %llu %llu", entry->total[event],
+                                    entry->self[event]);
+            }
+        }
+        if (length < size)
+        {
+            length += snprintf (buffer + length, size - length, "\r\n");
+        }
+    }
+    return (length < size) ? length : size - 1;
+}
+
+// Report channel
+static void perfcount_class_func (struct perfcount_rmcios *this,
+                                  const struct context_rmcios *context,
+                                  int id,
+                                  enum function_rmcios function,
+                                  enum type_rmcios paramtype,
+                                  struct combo_rmcios *returnv,
+                                  int num_params,
+                                  const union param_rmcios param)
+{
+    switch (function)
+    {
+    case help_rmcios:
+        return_string (context, returnv,
+                       "perfcount channel"
+                       " - performance counters per channel function\r\n"
+                       "read perfcount #report of counted functions\r\n"
+                       "write perfcount #clear counters\r\n");
+        break;
+
+    case write_rmcios:
+        perfcount_clear (this);
+        break;
+
+    case read_rmcios:
+        {
+            char report[PERFCOUNT_REPORT_SIZE];
+            int length = perfcount_report (this, report, sizeof (report));
+            return_buffer_chunked (context, returnv, report, length);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+// Read counters around the call and add them to the function results.
+static void perfcount_run (void *data,
+                           const struct context_rmcios *context,
+                           int id,
+                           enum function_rmcios function,
+                           enum type_rmcios paramtype,
+                           struct combo_rmcios *returnv,
+                           int num_params, union param_rmcios param)
+{
+    struct perfcount_rmcios *perfcount = (struct perfcount_rmcios *) data;
+    struct perfcount_entry_rmcios *entry;
+    struct perfcount_frame_rmcios *frame;
+    struct perfcount_sample_rmcios end;
+    int event;
+
+    if (!pthread_equal (pthread_self (), perfcount->owner))
+    {
+        // Counters and call frames belong to the measured thread
+        __sync_fetch_and_add (&perfcount->other_threads, 1);
+        perfcount->parent->run_channel (perfcount->parent->data, context,
+                                        id, function, paramtype, returnv,
+                                        num_params, param);
+        return;
+    }
+    if (id == perfcount->id || perfcount->depth >= PERFCOUNT_MAX_DEPTH)
+    {
+        if (id != perfcount->id)
+        {
+            perfcount->overflows++;
+        }
+        perfcount->parent->run_channel (perfcount->parent->data, context,
+                                        id, function, paramtype, returnv,
+                                        num_params, param);
+        return;
+    }
+
+    frame = perfcount->frames + perfcount->depth++;
+    memset (frame->nested, 0, sizeof (frame->nested));
+    read_counters (perfcount, &frame->start);
+    perfcount->parent->run_channel (perfcount->parent->data, context, id,
+                                    function, paramtype, returnv,
+                                    num_params, param);
+    read_counters (perfcount, &end);
+    perfcount->depth--;
+
+    entry = find_entry (perfcount, id, function, 1);
+    if (entry == 0)
+    {
+        perfcount->overflows++;
+    }
+    else
+    {
+        entry->calls++;
+    }
+    for (event = 0; event < perfcount_events; event++)
+    {
+        unsigned long long total = sample_delta (&frame->start, &end, event);
+        if (entry != 0)
+        {
+            entry->total[event] += total;
+            // Scaled nested counts can exceed the scaled total
+            if (total > frame->nested[event])
+            {
+                entry->self[event] += total - frame->nested[event];
+            }
+        }
+        if (perfcount->depth > 0)
+        {
+            perfcount->frames[perfcount->depth - 1].nested[event] += total;
+        }
+    }
+}
+
+void perfcount_close (struct perfcount_rmcios *perfcount)
+{
+    int event;
+    for (event = 0; event < perfcount_events; event++)
+    {
+#ifdef __linux__
+        if (perfcount->fds[event] >= 0)
+        {
+            close (perfcount->fds[event]);
+        }
+#endif
+        perfcount->fds[event] = -1;
+        perfcount->positions[event] = -1;
+    }
+    perfcount->group_fd = -1;
+    perfcount->num_counters = 0;
+}
+
+const struct context_rmcios *perfcount_init (struct perfcount_rmcios
+                                             *perfcount,
+                                             const struct context_rmcios
+                                             *parent)
+{
+    int event;
+
+    perfcount->parent = parent;
+    perfcount->owner = pthread_self ();
+    perfcount->group_fd = -1;
+    perfcount->num_counters = 0;
+    perfcount->depth = 0;
+    for (event = 0; event < perfcount_events; event++)
+    {
+        perfcount->fds[event] = -1;
+        perfcount->positions[event] = -1;
+    }
+    perfcount_clear (perfcount);
+
+#ifdef __linux__
+    for (event = 0; event < perfcount_events; event++)
+    {
+        int fd;
+        // Software counters are used when hardware counters fail
+        if (event >= perfcount_task_clock
+            && perfcount->positions[perfcount_cycles] >= 0)
+        {
+            break;
+        }
+        fd = open_counter (event, perfcount->group_fd);
+        if (fd < 0)
+        {
+            continue;
+        }
+        if (perfcount->group_fd < 0)
+        {
+            perfcount->group_fd = fd;
+        }
+        perfcount->fds[event] = fd;
+        perfcount->positions[event] = perfcount->num_counters++;
+    }
+#endif
+
+    perfcount->id = create_channel_str (parent, "perfcount",
+                                        (class_rmcios) perfcount_class_func,
+                                        perfcount);
+    copy_context (&perfcount->context, parent);
+    perfcount->context.run_channel = perfcount_run;
+    perfcount->context.data = perfcount;
+    return &perfcount->context;
+}
@@ -0,0 +1,182 @@
+/*
+RMCIOS - Reactive Multipurpose Control Input Output System
+Copyright (c) 2018 Frans Korhonen
+
+RMCIOS was originally developed at Institute for Atmospheric 
+and Earth System Research / Physics, Faculty of Science, 
+University of Helsinki, Finland
+
+Assistance, experience and feedback from following persons have been 
+critical for development of RMCIOS: Erkki Siivola, Juha Kangasluoma, 
+Lauri Ahonen, Ella Häkkinen, Pasi Aalto, Joonas Enroth, Runlong Cai, 
+Markku Kulmala and Tuukka Petäjä.
+
+This file is part of RMCIOS. This notice was encoded using utf-8.
+
+RMCIOS is free software: you can redistribute this file and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RMCIOS is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public Licenses
+along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file RMCIOS-perfcount.h
+ * @author Frans Korhonen
+ * @brief Performance counters per channel function.
+ *
+ * Context wrapper that reads Linux perf_event counters around each 
+ * dispatched channel call and sums them per (channel, function).
+ * Both inclusive counts and self counts (without nested channel calls)
+ * are kept. Hardware counters (cycles, instructions, cache misses) are
+ * used when available. Otherwise software counters (task clock,
+ * page faults) are used.
+ *
+ * Counters measure the thread that called perfcount_init(). Channels 
+ * must be given the wrapper context (perfcount.context). Calls from 
+ * other threads are forwarded without measuring and counted in
+ * other_threads. On other systems than Linux only calls are counted.
+ *
+ * Counters multiplexed by the kernel are scaled by the time enabled
+ * divided by the time running.
+ *
+ * Results are read from the perfcount channel:
+ *   read perfcount   # report: name.function calls (total self)...
+ *   write perfcount  # clear results
+ *
+ * Changelog: (date,who,description)
+ *
+ * */
+#ifndef rmcios_perfcount_h
+#define rmcios_perfcount_h
+
+#include "RMCIOS-API.h"
+
+#include <pthread.h>
+
+/// Number of (channel, function) results. Power of 2.
+#ifndef PERFCOUNT_SLOTS
+#define PERFCOUNT_SLOTS 512
+#endif
+
+/// Maximum nesting depth of measured calls
+#ifndef PERFCOUNT_MAX_DEPTH
+#define PERFCOUNT_MAX_DEPTH 32
+#endif
+
+/// Size of report buffer
+#ifndef PERFCOUNT_REPORT_SIZE
+#define PERFCOUNT_REPORT_SIZE 16384
+#endif
+
+/// @brief Counted events
+enum perfcount_event_rmcios
+{
+    perfcount_cycles = 0,
+    perfcount_instructions,
+    perfcount_cache_misses,
+    perfcount_task_clock,
+    perfcount_page_faults,
+    /// Number of events
+    perfcount_events
+};
+
+/// @brief Counters of channel function
+struct perfcount_entry_rmcios
+{
+    /// Channel id. -1 on unused entry.
+    int channel;
+    enum function_rmcios function;
+    unsigned int calls;
+    /// Counts including nested channel calls
+    unsigned long long total[perfcount_events];
+    /// Counts without nested channel calls
+    unsigned long long self[perfcount_events];
+};
+
+/// @brief Raw counter values read from the counter group
+struct perfcount_sample_rmcios
+{
+    /// Time the counters have been enabled (ns)
+    unsigned long long enabled;
+    /// Time the counters have been running on the hardware (ns)
+    unsigned long long running;
+    unsigned long long values[perfcount_events];
+};
+
+/// @brief Call in progress
+struct perfcount_frame_rmcios
+{
+    struct perfcount_sample_rmcios start;
+    /// Counts of nested calls
+    unsigned long long nested[perfcount_events];
+};
+
+/// @brief Performance counter wrapper
+struct perfcount_rmcios
+{
+    /// Wrapper context given to channels
+    struct context_rmcios context;
+    const struct context_rmcios *parent;
+    /// Report channel
+    int id;
+    /// Group leader file descriptor. -1 when counters are not available.
+    int group_fd;
+    /// Counter file descriptors. -1 on unavailable counter.
+    int fds[perfcount_events];
+    /// Position of counter in group read. -1 on unavailable counter.
+    int positions[perfcount_events];
+    int num_counters;
+    int depth;
+    /// Calls not measured because of table or depth limits
+    unsigned int overflows;
+    /// Thread that is measured
+    pthread_t owner;
+    /// Calls from other threads. Not measured.
+    unsigned int other_threads;
+    struct perfcount_frame_rmcios frames[PERFCOUNT_MAX_DEPTH];
+    struct perfcount_entry_rmcios entries[PERFCOUNT_SLOTS];
+};
+
+/// @brief Initialize performance counter wrapper
+///
+/// Opens counters of the calling thread and creates the report channel 
+/// named perfcount.
+/// @param perfcount wrapper to be initialized
+/// @param parent context the channel calls are forwarded to
+/// @return wrapper context for channels
+const struct context_rmcios *perfcount_init (struct perfcount_rmcios
+                                             *perfcount,
+                                             const struct context_rmcios
+                                             *parent);
+
+/// @brief Close counters
+void perfcount_close (struct perfcount_rmcios *perfcount);
+
+/// @brief Check if event is counted
+int perfcount_available (const struct perfcount_rmcios *perfcount,
+                         enum perfcount_event_rmcios event);
+
+/// @brief Get counters of channel function
+/// @return pointer to counters. 0 when function has not been called.
+const struct perfcount_entry_rmcios *perfcount_get (struct perfcount_rmcios
+                                                    *perfcount, int channel,
+                                                    enum function_rmcios
+                                                    function);
+
+/// @brief Write report to buffer
+/// @return length of written data
+int perfcount_report (struct perfcount_rmcios *perfcount,
+                      char *buffer, int size);
+
+/// @brief Clear results
+void perfcount_clear (struct perfcount_rmcios *perfcount);
+
+#endif
@@ -0,0 +1,257 @@
+/*
+RMCIOS - Reactive Multipurpose Control Input Output System
+Copyright (c) 2018 Frans Korhonen
+
+RMCIOS was originally developed at Institute for Atmospheric 
+and Earth System Research / Physics, Faculty of Science, 
+University of Helsinki, Finland
+
+Assistance, experience and feedback from following persons have been 
+critical for development of RMCIOS: Erkki Siivola, Juha Kangasluoma, 
+Lauri Ahonen, Ella Häkkinen, Pasi Aalto, Joonas Enroth, Runlong Cai, 
+Markku Kulmala and Tuukka Petäjä.
+
+This file is part of RMCIOS. This notice was encoded using utf-8.
+
+RMCIOS is free software: you can redistribute this file and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RMCIOS is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public Licenses
+along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RMCIOS-prepared.h"
+
+int prepare_call (struct prepared_rmcios *call,
+                  const struct context_rmcios *context,
+                  int channel,
+                  enum function_rmcios function,
+                  enum type_rmcios paramtype,
+                  int num_params, enum type_rmcios return_type)
+{
+    call->context = context;
+    call->channel = channel;
+    call->function = function;
+    call->paramtype = paramtype;
+    call->num_params = num_params;
+
+    call->value.l = 0;
+    call->return_buffer.data = 0;
+    call->return_buffer.length = 0;
+    call->return_buffer.size = 0;
+    call->return_buffer.required_size = 0;
+    call->return_buffer.trailing_size = 0;
+    call->return_buffer.flags = 0;
+
+    call->buffer = call->return_buffer;
+    call->plan.from = 0;
+    call->plan.to = 0;
+    call->plan.convert = 0;
+
+    call->returnv.paramtype = return_type;
+    call->returnv.num_params = 1;
+    call->returnv.next = 0;
+    switch (return_type)
+    {
+    case int_rmcios:
+        call->returnv.param.iv = &call->value.i;
+        break;
+    case float_rmcios:
+        call->returnv.param.fv = &call->value.f;
+        break;
+    case int64_rmcios:
+        call->returnv.param.lv = &call->value.l;
+        break;
+    case double_rmcios:
+        call->returnv.param.dv = &call->value.d;
+        break;
+    case buffer_rmcios:
+    case binary_rmcios:
+        call->returnv.param.bv = &call->return_buffer;
+        break;
+    case channel_rmcios:
+        call->returnv.param.channel = 0;
+        break;
+    default:
+        call->returnv.num_params = 0;
+        call->returnv.param.p = 0;
+        break;
+    }
+    call->preturnv = (call->returnv.num_params > 0) ? &call->returnv : 0;
+
+    return (channel != 0) ? 0 : -1;
+}
+
+int prepare_call_str (struct prepared_rmcios *call,
+                      const struct context_rmcios *context,
+                      const char *channel_name,
+                      enum function_rmcios function,
+                      enum type_rmcios paramtype,
+                      int num_params, enum type_rmcios return_type)
+{
+    return prepare_call (call, context, channel_enum (context, channel_name),
+                         function, paramtype, num_params, return_type);
+}
+
+void prepared_return_channel (struct prepared_rmcios *call,
+                              int return_channel)
+{
+    call->returnv.param.channel = return_channel;
+}
+
+void prepared_return_buffer (struct prepared_rmcios *call,
+                             char *buffer, int size)
+{
+    call->return_buffer.data = buffer;
+    call->return_buffer.size = size;
+}
+
+static void prepared_invoke (struct prepared_rmcios *call,
+                             enum type_rmcios paramtype,
+                             int num_params, union param_rmcios param)
+{
+    call->return_buffer.length = 0;
+    call->return_buffer.required_size = 0;
+    run_channel (call->context, call->channel, call->function,
+                 paramtype, call->preturnv, num_params, param);
+}
+
+void prepared_run (struct prepared_rmcios *call, union param_rmcios param)
+{
+    prepared_invoke (call, call->paramtype, call->num_params, param);
+}
+
+// Convert returned value to numeric type of the invocation.
+static void prepared_result (struct prepared_rmcios *call,
+                             enum type_rmcios to, union param_rmcios result)
+{
+    struct combo_rmcios element = {
+        .paramtype = to,
+        .num_params = 1,
+        .param = result,
+        .next = 0
+    };
+    union param_rmcios value;
+    switch (call->returnv.paramtype)
+    {
+    case int_rmcios:
+    case float_rmcios:
+    case int64_rmcios:
+    case double_rmcios:
+        value.p = &call->value;
+        break;
+    case buffer_rmcios:
+    case binary_rmcios:
+        if (call->return_buffer.length == 0)
+            return;
+        value.bv = &call->return_buffer;
+        break;
+    default:
+        // No value returned
+        return;
+    }
+    conversion_plan (call->returnv.paramtype, to).
+        convert (call->context, value, 0, &element);
+}
+
+// Run call with numeric values of type from.
+// Values are converted to the prepared numeric parameter type. 
+// Other parameter types are left for the channel to convert.
+static void prepared_values (struct prepared_rmcios *call,
+                             enum type_rmcios from, union param_rmcios values)
+{
+    struct combo_rmcios element = {
+        .paramtype = call->paramtype,
+        .num_params = 1,
+        .next = 0
+    };
+    int i;
+
+    if (call->paramtype == from
+        || (call->paramtype != int_rmcios && call->paramtype != float_rmcios
+            && call->paramtype != int64_rmcios
+            && call->paramtype != double_rmcios)
+        || call->num_params > PREPARED_MAX_PARAMS)
+    {
+        prepared_invoke (call, from, call->num_params, values);
+        return;
+    }
+
+    if (call->plan.convert == 0 || call->plan.from != from)
+    {
+        call->plan = conversion_plan (from, call->paramtype);
+    }
+    for (i = 0; i < call->num_params; i++)
+    {
+        switch (call->paramtype)
+        {
+        case int64_rmcios:
+            element.param.lv = call->values.lv + i;
+            break;
+        case double_rmcios:
+            element.param.dv = call->values.dv + i;
+            break;
+        case float_rmcios:
+            element.param.fv = call->values.fv + i;
+            break;
+        default:
+            element.param.iv = call->values.iv + i;
+            break;
+        }
+        call->plan.convert (call->context, values, i, &element);
+    }
+    prepared_invoke (call, call->paramtype, call->num_params,
+                     (union param_rmcios) call->values.iv);
+}
+
+float prepared_write_fv (struct prepared_rmcios *call, float *values)
+{
+    float result = 0;
+    call->value.l = 0;
+    prepared_values (call, float_rmcios, (union param_rmcios) values);
+    prepared_result (call, float_rmcios, (union param_rmcios) &result);
+    return result;
+}
+
+int prepared_write_iv (struct prepared_rmcios *call, int *values)
+{
+    int result = 0;
+    call->value.l = 0;
+    prepared_values (call, int_rmcios, (union param_rmcios) values);
+    prepared_result (call, int_rmcios, (union param_rmcios) &result);
+    return result;
+}
+
+void prepared_write_str (struct prepared_rmcios *call, const char *str)
+{
+    int i;
+    for (i = 0; str[i] != 0; i++);
+    call->buffer.data = (char *) str;
+    call->buffer.length = i;
+    call->buffer.required_size = i;
+    call->buffer.trailing_size = 1;     // Trailing 0
+    // Single string parameter regardless of prepared num_params
+    prepared_invoke (call, buffer_rmcios, 1,
+                     (union param_rmcios) &call->buffer);
+}
+
+int prepared_write_buffer (struct prepared_rmcios *call,
+                           const char *buffer, int length)
+{
+    call->buffer.data = (char *) buffer;
+    call->buffer.length = length;
+    call->buffer.required_size = length;
+    call->buffer.trailing_size = 0;
+    prepared_invoke (call,
+                     (call->paramtype == binary_rmcios) ?
+                     binary_rmcios : buffer_rmcios, 1,
+                     (union param_rmcios) &call->buffer);
+    return call->return_buffer.length;
+}
@@ -0,0 +1,159 @@
+/*
+RMCIOS - Reactive Multipurpose Control Input Output System
+Copyright (c) 2018 Frans Korhonen
+
+RMCIOS was originally developed at Institute for Atmospheric 
+and Earth System Research / Physics, Faculty of Science, 
+University of Helsinki, Finland
+
+Assistance, experience and feedback from following persons have been 
+critical for development of RMCIOS: Erkki Siivola, Juha Kangasluoma, 
+Lauri Ahonen, Ella Häkkinen, Pasi Aalto, Joonas Enroth, Runlong Cai, 
+Markku Kulmala and Tuukka Petäjä.
+
+This file is part of RMCIOS. This notice was encoded using utf-8.
+
+RMCIOS is free software: you can redistribute this file and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RMCIOS is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public Licenses
+along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file RMCIOS-prepared.h
+ * @author Frans Korhonen
+ * @brief Prepared channel calls for repeated channel invocations.
+ *
+ * Prepared call binds channel, function, parameter type and return 
+ * shape once. Parameter and return structures are built at preparation.
+ * Invoking the call only sets the new parameter values.
+ *
+ * Changelog: (date,who,description)
+ *
+ * */
+#ifndef rmcios_prepared_h
+#define rmcios_prepared_h
+
+#include "RMCIOS-API.h"
+#include "RMCIOS-functions.h"
+
+/// Maximum number of numeric parameters converted by prepared call
+#ifndef PREPARED_MAX_PARAMS
+#define PREPARED_MAX_PARAMS 16
+#endif
+
+/// @brief Prepared channel call
+struct prepared_rmcios
+{
+    const struct context_rmcios *context;
+    int channel;
+    enum function_rmcios function;
+    enum type_rmcios paramtype;
+    /// Number of parameters given on each invocation
+    int num_params;
+
+    /// Return structure. 
+    struct combo_rmcios returnv;
+    /// Pointer to returnv. 0 when return data is not wanted.
+    struct combo_rmcios *preturnv;
+    /// Storage for numeric return values
+    union
+    {
+        int i;
+        float f;
+        long long l;
+        double d;
+    } value;
+    /// Return buffer for buffer_rmcios and binary_rmcios returns
+    struct buffer_rmcios return_buffer;
+
+    /// Parameter structure for string and buffer invocations
+    struct buffer_rmcios buffer;
+
+    /// Conversion plan for invocation values that are not given in 
+    /// the prepared parameter type. Decided on first such invocation.
+    struct conversion_plan_rmcios plan;
+    /// Converted numeric parameters
+    union
+    {
+        int iv[PREPARED_MAX_PARAMS];
+        float fv[PREPARED_MAX_PARAMS];
+        long long lv[PREPARED_MAX_PARAMS];
+        double dv[PREPARED_MAX_PARAMS];
+    } values;
+};
+
+/// @brief Prepare channel call
+///
+/// @param call pointer to call to be prepared
+/// @param context pointer to target system context
+/// @param channel channel to be called
+/// @param function channel function to be called
+/// @param paramtype type of parameters given on invocation
+/// @param num_params number of parameters given on invocation
+/// @param return_type type of return data. 0 when not needed.
+///        return target is set with prepared_return_channel or 
+///        prepared_return_buffer for channel and buffer types.
+/// @return 0 on success. -1 when channel is invalid.
+int prepare_call (struct prepared_rmcios *call,
+                  const struct context_rmcios *context,
+                  int channel,
+                  enum function_rmcios function,
+                  enum type_rmcios paramtype,
+                  int num_params, enum type_rmcios return_type);
+
+/// @brief Prepare channel call. Channel is given by name.
+///
+/// Channel name is resolved once.
+/// @see prepare_call
+int prepare_call_str (struct prepared_rmcios *call,
+                      const struct context_rmcios *context,
+                      const char *channel_name,
+                      enum function_rmcios function,
+                      enum type_rmcios paramtype,
+                      int num_params, enum type_rmcios return_type);
+
+/// @brief Set channel that receives return data (return_type channel_rmcios)
+void prepared_return_channel (struct prepared_rmcios *call,
+                              int return_channel);
+
+/// @brief Set buffer for return data (return_type buffer_rmcios)
+void prepared_return_buffer (struct prepared_rmcios *call,
+                             char *buffer, int size);
+
+/// @brief Invoke prepared call with given parameter array.
+void prepared_run (struct prepared_rmcios *call, union param_rmcios param);
+
+/// @brief Invoke prepared call with float parameters.
+/// 
+/// Values are converted when call was prepared with integer parameters.
+/// @return return value converted to float. 0 when nothing was returned.
+float prepared_write_fv (struct prepared_rmcios *call, float *values);
+
+/// @brief Invoke prepared call with integer parameters.
+///
+/// Values are converted when call was prepared with float parameters.
+/// @return return value converted to integer. 0 when nothing was returned.
+int prepared_write_iv (struct prepared_rmcios *call, int *values);
+
+/// @brief Invoke prepared call with NULL-terminated string parameter.
+///
+/// Channel is called with one parameter regardless of prepared num_params.
+void prepared_write_str (struct prepared_rmcios *call, const char *str);
+
+/// @brief Invoke prepared call with buffer parameter.
+///
+/// Channel is called with one parameter regardless of prepared num_params.
+/// @return length of returned data in return buffer.
+int prepared_write_buffer (struct prepared_rmcios *call,
+                           const char *buffer, int length);
+
+#endif
@@ -0,0 +1,395 @@
+/*
+RMCIOS - Reactive Multipurpose Control Input Output System
+Copyright (c) 2018 Frans Korhonen
+
+RMCIOS was originally developed at Institute for Atmospheric 
+and Earth System Research / Physics, Faculty of Science, 
+University of Helsinki, Finland
+
+Assistance, experience and feedback from following persons have been 
+critical for development of RMCIOS: Erkki Siivola, Juha Kangasluoma, 
+Lauri Ahonen, Ella Häkkinen, Pasi Aalto, Joonas Enroth, Runlong Cai, 
+Markku Kulmala and Tuukka Petäjä.
+
+This file is part of RMCIOS. This notice was encoded using utf-8.
+
+RMCIOS is free software: you can redistribute this file and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RMCIOS is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public Licenses
+along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RMCIOS-profiler.h"
+#include "RMCIOS-functions.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifndef PROFILER_NO_TIMER
+#include <signal.h>
+#include <sys/time.h>
+#endif
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L \
+    && !defined(__STDC_NO_ATOMICS__)
+#define THREAD_LOCAL _Thread_local
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+#define TRY_LOCK(flag) (__sync_lock_test_and_set (&(flag), 1) == 0)
+#define UNLOCK(flag) __sync_lock_release (&(flag))
+
+// Shadow stack of the calling thread.
+// Volatile: read by signal handler interrupting the thread.
+static THREAD_LOCAL volatile struct
+{
+    int depth;
+    struct profiler_frame_rmcios frames[PROFILER_MAX_DEPTH];
+} shadow;
+
+// Profiler that receives the timer samples
+static struct profiler_rmcios *sampling;
+
+static const char *function_name (enum function_rmcios function)
+{
+    switch (function)
+    {
+    case help_rmcios:
+        return "help";
+    case setup_rmcios:
+        return "setup";
+    case write_rmcios:
+        return "write";
+    case read_rmcios:
+        return "read";
+    case create_rmcios:
+        return "create";
+    case link_rmcios:
+        return "link";
+    default:
+        return "?";
+    }
+}
+
+void profiler_sample (struct profiler_rmcios *profiler)
+{
+    struct profiler_frame_rmcios frames[PROFILER_MAX_DEPTH];
+    unsigned int hash = 2166136261u;
+    int depth = shadow.depth;
+    int i;
+
+    if (depth == 0)
+    {
+        profiler->idle++;
+        return;
+    }
+    if (depth > PROFILER_MAX_DEPTH)
+    {
+        depth = PROFILER_MAX_DEPTH;
+    }
+    // FNV-1a hash of the stack
+    for (i = 0; i < depth; i++)
+    {
+        frames[i].id = shadow.frames[i].id;
+        frames[i].function = shadow.frames[i].function;
+        hash = (hash ^ (unsigned int) frames[i].id) * 16777619u;
+        hash = (hash ^ (unsigned int) frames[i].function) * 16777619u;
+    }
+
+    if (!TRY_LOCK (profiler->busy))
+    {
+        profiler->dropped++;
+        return;
+    }
+    for (i = 0; i < PROFILER_STACKS; i++)
+    {
+        struct profiler_stack_rmcios *stack =
+            profiler->stacks + ((hash + i) & (PROFILER_STACKS - 1));
+        if (stack->count == 0)
+        {
+            stack->hash = hash;
+            stack->depth = depth;
+            memcpy (stack->frames, frames, depth * sizeof (frames[0]));
+            stack->count = 1;
+            break;
+        }
+        if (stack->hash == hash && stack->depth == depth
+            && memcmp (stack->frames, frames, depth * sizeof (frames[0])) == 0)
+        {
+            stack->count++;
+            break;
+        }
+    }
+    if (i == PROFILER_STACKS)
+    {
+        profiler->dropped++;
+    }
+    UNLOCK (profiler->busy);
+}
+
+// Append frame name. Separators of the collapsed format are replaced.
+static int append_name (char *buffer, int size, const char *name,
+                        int length)
+{
+    int i;
+    for (i = 0; i < length && i < size - 1; i++)
+    {
+        char c = name[i];
+        buffer[i] = (c == ' ' || c == ';' || c == '\n') ? '_' : c;
+    }
+    if (size > 0)
+    {
+        buffer[i] = 0;
+    }
+    return i;
+}
+
+int profiler_collapsed (struct profiler_rmcios *profiler,
+                        char *buffer, int size)
+{
+    int length = 0;
+    int i;
+
+    if (size <= 0)
+    {
+        return 0;
+    }
+    buffer[0] = 0;
+    while (!TRY_LOCK (profiler->busy));
+    for (i = 0; i < PROFILER_STACKS && length < size; i++)
+    {
+        const struct profiler_stack_rmcios *stack = profiler->stacks + i;
+        int frame;
+        if (stack->count == 0)
+        {
+            continue;
+        }
+        for (frame = 0; frame < stack->depth && length < size; frame++)
+        {
+            char name[32];
+            struct buffer_rmcios bname =
+                channel_name_borrow (profiler->parent,
+                                     stack->frames[frame].id,
+                                     name, sizeof (name));
+            if (bname.length > 0)
+            {
+                length += snprintf (buffer + length, size - length,
+                                    "%s", frame ? ";" : "");
+                if (length < size)
+                {
+                    length += append_name (buffer + length, size - length,
+                                           bname.data, bname.length);
+                }
+                if (length < size)
+                {
+                    length += snprintf (buffer + length, size - length,
+                                        ".%s",
+                                        function_name (stack->frames[frame].
+                                                       function));
+                }
+            }
+            else
+            {
+                length += snprintf (buffer + length, size - length,
+                                    "%s#%d.%s", frame ? ";" : "",
+                                    stack->frames[frame].id,
+                                    function_name (stack->frames[frame].
+                                                   function));
+            }
+        }
+        if (length < size)
+        {
+            length += snprintf (buffer + length, size - length,
+                                " %u\n", stack->count);
+        }
+    }
+    UNLOCK (profiler->busy);
+    return (length < size) ? length : size - 1;
+}
+
+void profiler_clear (struct profiler_rmcios *profiler)
+{
+    int i;
+    while (!TRY_LOCK (profiler->busy));
+    for (i = 0; i < PROFILER_STACKS; i++)
+    {
+        profiler->stacks[i].count = 0;
+    }
+    profiler->idle = 0;
+    profiler->dropped = 0;
+    UNLOCK (profiler->busy);
+}
+
+#ifndef PROFILER_NO_TIMER
+// Samples the thread that the signal is delivered to. ITIMER_PROF 
+// counts CPU time of the whole process, so the signal goes to any 
+// thread that is running, not only to threads making channel calls.
+static void profiler_signal (int signum)
+{
+    struct profiler_rmcios *profiler = sampling;
+    if (signum == SIGPROF && profiler != 0)
+    {
+        profiler_sample (profiler);
+    }
+}
+#endif
+
+int profiler_start (struct profiler_rmcios *profiler, int interval_us)
+{
+#ifndef PROFILER_NO_TIMER
+    struct sigaction action;
+    struct itimerval timer;
+
+    if (interval_us <= 0 || (sampling != 0 && sampling != profiler))
+    {
+        return -1;
+    }
+    memset (&action, 0, sizeof (action));
+    action.sa_handler = profiler_signal;
+    action.sa_flags = SA_RESTART;
+    sigemptyset (&action.sa_mask);
+    if (sigaction (SIGPROF, &action, 0) != 0)
+    {
+        return -1;
+    }
+    sampling = profiler;
+    profiler->interval_us = interval_us;
+    timer.it_interval.tv_sec = interval_us / 1000000;
+    timer.it_interval.tv_usec = interval_us % 1000000;
+    timer.it_value = timer.it_interval;
+    if (setitimer (ITIMER_PROF, &timer, 0) != 0)
+    {
+        sampling = 0;
+        profiler->interval_us = 0;
+        return -1;
+    }
+    return 0;
+#else
+    return -1;
+#endif
+}
+
+void profiler_stop (struct profiler_rmcios *profiler)
+{
+#ifndef PROFILER_NO_TIMER
+    struct itimerval timer;
+    if (sampling != profiler)
+    {
+        return;
+    }
+    memset (&timer, 0, sizeof (timer));
+    setitimer (ITIMER_PROF, &timer, 0);
+    signal (SIGPROF, SIG_IGN);
+    sampling = 0;
+#endif
+    profiler->interval_us = 0;
+}
+
+// Profiler control channel
+static void profiler_class_func (struct profiler_rmcios *this,
+                                 const struct context_rmcios *context,
+                                 int id,
+                                 enum function_rmcios function,
+                                 enum type_rmcios paramtype,
+                                 struct combo_rmcios *returnv,
+                                 int num_params,
+                                 const union param_rmcios param)
+{
+    switch (function)
+    {
+    case help_rmcios:
+        return_string (context, returnv,
+                       "profiler channel - sampling profiler of channel calls\r\n"
+                       "write profiler interval_us #start sampling\r\n"
+                       "write profiler 0 #stop sampling\r\n"
+                       "write profiler #clear samples\r\n"
+                       "read profiler #collapsed stacks for flamegraph\r\n");
+        break;
+
+    case write_rmcios:
+        if (num_params < 1)
+        {
+            profiler_clear (this);
+        }
+        else
+        {
+            int interval_us = param_to_int (context, paramtype, param, 0);
+            profiler_stop (this);
+            if (interval_us > 0)
+            {
+                profiler_start (this, interval_us);
+            }
+        }
+        break;
+
+    case read_rmcios:
+        {
+            char report[PROFILER_REPORT_SIZE];
+            int length = profiler_collapsed (this, report, sizeof (report));
+            return_buffer_chunked (context, returnv, report, length);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+// Push call to shadow stack. Calls to the control channel are not tracked.
+static void profiler_run (void *data,
+                          const struct context_rmcios *context,
+                          int id,
+                          enum function_rmcios function,
+                          enum type_rmcios paramtype,
+                          struct combo_rmcios *returnv,
+                          int num_params, union param_rmcios param)
+{
+    struct profiler_rmcios *profiler = (struct profiler_rmcios *) data;
+    int depth = shadow.depth;
+
+    if (id == profiler->id)
+    {
+        profiler->parent->run_channel (profiler->parent->data, context, id,
+                                       function, paramtype, returnv,
+                                       num_params, param);
+        return;
+    }
+    if (depth < PROFILER_MAX_DEPTH)
+    {
+        shadow.frames[depth].id = id;
+        shadow.frames[depth].function = function;
+    }
+    // Frame is complete before it becomes visible to the signal handler
+    shadow.depth = depth + 1;
+    profiler->parent->run_channel (profiler->parent->data, context, id,
+                                   function, paramtype, returnv,
+                                   num_params, param);
+    shadow.depth = depth;
+}
+
+const struct context_rmcios *profiler_init (struct profiler_rmcios
+                                            *profiler,
+                                            const struct context_rmcios
+                                            *parent)
+{
+    profiler->parent = parent;
+    profiler->interval_us = 0;
+    profiler->busy = 0;
+    profiler_clear (profiler);
+    profiler->id = create_channel_str (parent, "profiler",
+                                       (class_rmcios) profiler_class_func,
+                                       profiler);
+    copy_context (&profiler->context, parent);
+    profiler->context.run_channel = profiler_run;
+    profiler->context.data = profiler;
+    return &profiler->context;
+}
@@ -0,0 +1,146 @@
+/*
+RMCIOS - Reactive Multipurpose Control Input Output System
+Copyright (c) 2018 Frans Korhonen
+
+RMCIOS was originally developed at Institute for Atmospheric 
+and Earth System Research / Physics, Faculty of Science, 
+University of Helsinki, Finland
+
+Assistance, experience and feedback from following persons have been 
+critical for development of RMCIOS: Erkki Siivola, Juha Kangasluoma, 
+Lauri Ahonen, Ella Häkkinen, Pasi Aalto, Joonas Enroth, Runlong Cai, 
+Markku Kulmala and Tuukka Petäjä.
+
+This file is part of RMCIOS. This notice was encoded using utf-8.
+
+RMCIOS is free software: you can redistribute this file and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RMCIOS is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public Licenses
+along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file RMCIOS-profiler.h
+ * @author Frans Korhonen
+ * @brief Sampling profiler for channel call stacks.
+ *
+ * Context wrapper that keeps a per-thread shadow stack of running 
+ * channel calls (channel, function). The stack is sampled on SIGPROF 
+ * timer signal and identical stacks are counted. Output is in collapsed
+ * stack format for flamegraph tools, one stack per line:
+ *   sensor.read;filter.write;log.write 12
+ *
+ * Channels must be given the wrapper context (profiler.context).
+ * Only one profiler can sample at a time. Samples are taken from the 
+ * thread that receives the signal. ITIMER_PROF measures CPU time of the
+ * whole process and the signal is delivered to whichever thread is 
+ * running. Samples of threads without channel calls count as idle.
+ * Define PROFILER_NO_TIMER to leave out the signal timer and call 
+ * profiler_sample() from own timer.
+ *
+ * Spaces and ';' in channel names are written as '_' in the output.
+ *
+ * Profiler is controlled with the profiler channel:
+ *   write profiler interval_us  # start sampling. 0 stops.
+ *   read profiler               # collapsed stacks
+ *
+ * Changelog: (date,who,description)
+ *
+ * */
+#ifndef rmcios_profiler_h
+#define rmcios_profiler_h
+
+#include "RMCIOS-API.h"
+
+/// Maximum depth of sampled call stack. Deeper frames are left out.
+#ifndef PROFILER_MAX_DEPTH
+#define PROFILER_MAX_DEPTH 32
+#endif
+
+/// Number of different stacks that can be counted. Power of 2.
+#ifndef PROFILER_STACKS
+#define PROFILER_STACKS 512
+#endif
+
+/// Size of collapsed stack report buffer
+#ifndef PROFILER_REPORT_SIZE
+#define PROFILER_REPORT_SIZE 16384
+#endif
+
+/// @brief Channel call in shadow stack
+struct profiler_frame_rmcios
+{
+    int id;
+    enum function_rmcios function;
+};
+
+/// @brief Counted call stack
+struct profiler_stack_rmcios
+{
+    unsigned int hash;
+    /// Number of samples. 0 on unused entry.
+    unsigned int count;
+    int depth;
+    struct profiler_frame_rmcios frames[PROFILER_MAX_DEPTH];
+};
+
+/// @brief Sampling profiler
+struct profiler_rmcios
+{
+    /// Wrapper context given to channels
+    struct context_rmcios context;
+    const struct context_rmcios *parent;
+    /// Profiler control channel
+    int id;
+    /// Sampling interval in microseconds. 0 when stopped.
+    int interval_us;
+    /// Set while the stack table is in use
+    volatile int busy;
+    /// Samples taken when no channel was running
+    unsigned int idle;
+    /// Samples dropped because table was full or busy
+    unsigned int dropped;
+    struct profiler_stack_rmcios stacks[PROFILER_STACKS];
+};
+
+/// @brief Initialize profiler wrapper
+///
+/// Creates the profiler control channel named profiler.
+/// @param profiler profiler to be initialized
+/// @param parent context the channel calls are forwarded to
+/// @return wrapper context for channels
+const struct context_rmcios *profiler_init (struct profiler_rmcios
+                                            *profiler,
+                                            const struct context_rmcios
+                                            *parent);
+
+/// @brief Start sampling on SIGPROF timer
+/// @param interval_us sampling interval in microseconds of used CPU time
+/// @return 0 on success. -1 on failure.
+int profiler_start (struct profiler_rmcios *profiler, int interval_us);
+
+/// @brief Stop sampling
+void profiler_stop (struct profiler_rmcios *profiler);
+
+/// @brief Take sample of the shadow stack of the calling thread
+///
+/// Async-signal-safe.
+void profiler_sample (struct profiler_rmcios *profiler);
+
+/// @brief Write collapsed stacks to buffer
+/// @return length of written data
+int profiler_collapsed (struct profiler_rmcios *profiler,
+                        char *buffer, int size);
+
+/// @brief Clear collected samples
+void profiler_clear (struct profiler_rmcios *profiler);
+
+#endif
@@ -0,0 +1,413 @@
+/*
+RMCIOS - Reactive Multipurpose Control Input Output System
+Copyright (c) 2018 Frans Korhonen
+
+RMCIOS was originally developed at Institute for Atmospheric 
+and Earth System Research / Physics, Faculty of Science, 
+University of Helsinki, Finland
+
+Assistance, experience and feedback from following persons have been 
+critical for development of RMCIOS: Erkki Siivola, Juha Kangasluoma, 
+Lauri Ahonen, Ella Häkkinen, Pasi Aalto, Joonas Enroth, Runlong Cai, 
+Markku Kulmala and Tuukka Petäjä.
+
+This file is part of RMCIOS. This notice was encoded using utf-8.
+
+RMCIOS is free software: you can redistribute this file and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RMCIOS is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public Licenses
+along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RMCIOS-reactor.h"
+#include "RMCIOS-functions.h"
+
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/uio.h>
+
+static struct reactor_source_rmcios *find_source (struct reactor_rmcios
+                                                  *reactor, int fd)
+{
+    int i;
+    for (i = 0; i < REACTOR_MAX_SOURCES; i++)
+    {
+        if (reactor->sources[i].channel != 0 && reactor->sources[i].fd == fd)
+        {
+            return reactor->sources + i;
+        }
+    }
+    return 0;
+}
+
+static int add_source (struct reactor_rmcios *reactor,
+                       int fd, int channel, int timer)
+{
+    struct reactor_source_rmcios *source = 0;
+    struct epoll_event event = { 0 };
+    int i;
+
+    if (channel == 0 || find_source (reactor, fd) != 0)
+    {
+        return -1;
+    }
+    for (i = 0; i < REACTOR_MAX_SOURCES; i++)
+    {
+        if (reactor->sources[i].channel == 0)
+        {
+            source = reactor->sources + i;
+            break;
+        }
+    }
+    if (source == 0)
+    {
+        info (reactor->context, reactor->context->errors,
+              "reactor: too many sources\n");
+        return -1;
+    }
+
+    source->fd = fd;
+    source->timer = timer;
+    source->channel = channel;
+    source->generation++;
+    event.events = EPOLLIN | EPOLLRDHUP;
+    // Slot and generation identify the registration
+    event.data.u64 = ((unsigned long long) source->generation << 32)
+        | (unsigned long long) (source - reactor->sources);
+    if (epoll_ctl (reactor->epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0)
+    {
+        source->channel = 0;
+        info (reactor->context, reactor->context->errors,
+              "reactor: could not register fd\n");
+        return -1;
+    }
+    reactor->num_sources++;
+    return 0;
+}
+
+int reactor_init (struct reactor_rmcios *reactor,
+                  const struct context_rmcios *context)
+{
+    int i;
+    reactor->context = context;
+    reactor->id = 0;
+    reactor->running = 0;
+    reactor->num_sources = 0;
+    for (i = 0; i < REACTOR_MAX_SOURCES; i++)
+    {
+        reactor->sources[i].fd = -1;
+        reactor->sources[i].channel = 0;
+        reactor->sources[i].timer = 0;
+        reactor->sources[i].generation = 0;
+    }
+    reactor->epoll_fd = epoll_create1 (EPOLL_CLOEXEC);
+    if (reactor->epoll_fd < 0)
+    {
+        info (context, context->errors, "reactor: epoll_create failed\n");
+        return -1;
+    }
+    return 0;
+}
+
+int reactor_add_fd (struct reactor_rmcios *reactor, int fd, int channel)
+{
+    return add_source (reactor, fd, channel, 0);
+}
+
+int reactor_add_timer (struct reactor_rmcios *reactor,
+                       int period_ms, int channel)
+{
+    struct itimerspec spec = { 0 };
+    int fd;
+
+    if (period_ms <= 0)
+    {
+        return -1;
+    }
+    fd = timerfd_create (CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    spec.it_interval.tv_sec = period_ms / 1000;
+    spec.it_interval.tv_nsec = (period_ms % 1000) * 1000000L;
+    spec.it_value = spec.it_interval;
+    if (timerfd_settime (fd, 0, &spec, 0) != 0
+        || add_source (reactor, fd, channel, 1) != 0)
+    {
+        close (fd);
+        return -1;
+    }
+    return fd;
+}
+
+void reactor_remove (struct reactor_rmcios *reactor, int fd)
+{
+    struct reactor_source_rmcios *source = find_source (reactor, fd);
+    if (source == 0)
+    {
+        return;
+    }
+    epoll_ctl (reactor->epoll_fd, EPOLL_CTL_DEL, fd, 0);
+    if (source->timer)
+    {
+        close (fd);
+    }
+    source->channel = 0;
+    source->fd = -1;
+    reactor->num_sources--;
+}
+
+static void dispatch_event (struct reactor_rmcios *reactor,
+                            unsigned long long registration,
+                            unsigned int events)
+{
+    const struct context_rmcios *context = reactor->context;
+    struct reactor_source_rmcios *source =
+        reactor->sources + (registration & 0xFFFFFFFFu);
+    int channel = source->channel;
+
+    if (channel == 0 || source->generation != (registration >> 32))
+    {
+        // Source removed or replaced by earlier event of the same round.
+        return;
+    }
+
+    if (source->timer)
+    {
+        unsigned long long expirations = 0;
+        if (read (source->fd, &expirations, sizeof (expirations)) ==
+            sizeof (expirations))
+        {
+            write_i (context, channel, (int) expirations);
+        }
+        return;
+    }
+
+    if (events & EPOLLIN)
+    {
+        ssize_t length = read (source->fd, reactor->buffer,
+                               REACTOR_BUFFER_SIZE);
+        if (length > 0)
+        {
+            // Zero-copy view of the receive buffer
+            struct buffer_rmcios view = {
+                .data = reactor->buffer,
+                .length = length,
+                .size = 0,
+                .required_size = length,
+                .trailing_size = 0
+            };
+            run_channel (context, channel, write_rmcios, binary_rmcios,
+                         0, 1, (union param_rmcios) &view);
+            return;
+        }
+        if (length < 0 && (errno == EAGAIN || errno == EINTR))
+        {
+            return;
+        }
+    }
+    else if (!(events & (EPOLLHUP | EPOLLRDHUP | EPOLLERR)))
+    {
+        return;
+    }
+
+    // Closed by peer or error:
+    reactor_remove (reactor, source->fd);
+    run_channel (context, channel, write_rmcios, binary_rmcios,
+                 0, 0, (union param_rmcios) 0);
+}
+
+int reactor_run (struct reactor_rmcios *reactor, int timeout_ms)
+{
+    struct epoll_event events[REACTOR_MAX_EVENTS];
+    int i;
+    int n = epoll_wait (reactor->epoll_fd, events, REACTOR_MAX_EVENTS,
+                        timeout_ms);
+    if (n < 0)
+    {
+        return (errno == EINTR) ? 0 : -1;
+    }
+    for (i = 0; i < n; i++)
+    {
+        dispatch_event (reactor, events[i].data.u64, events[i].events);
+    }
+    return n;
+}
+
+void reactor_loop (struct reactor_rmcios *reactor)
+{
+    reactor->running = 1;
+    while (reactor->running)
+    {
+        if (reactor_run (reactor, 100) < 0)
+        {
+            info (reactor->context, reactor->context->errors,
+                  "reactor: epoll_wait failed\n");
+            break;
+        }
+    }
+    reactor->running = 0;
+}
+
+void reactor_stop (struct reactor_rmcios *reactor)
+{
+    reactor->running = 0;
+}
+
+void reactor_class_func (struct reactor_rmcios *this,
+                         const struct context_rmcios *context,
+                         int id,
+                         enum function_rmcios function,
+                         enum type_rmcios paramtype,
+                         struct combo_rmcios *returnv,
+                         int num_params, const union param_rmcios param)
+{
+    switch (function)
+    {
+    case help_rmcios:
+        return_string (context, returnv,
+                       "reactor channel - epoll based I/O event loop\r\n"
+                       "create reactor newname\r\n"
+                       "write newname fd channel"
+                       " #register fd. Received data is written to channel\r\n"
+                       "write newname fd 0 #unregister fd\r\n"
+                       "setup newname period_ms channel"
+                       " #add periodic timer. Returns timer fd\r\n"
+                       "write newname #dispatch pending events\r\n"
+                       "read newname #number of registered sources\r\n");
+        break;
+
+    case create_rmcios:
+        if (num_params < 1)
+            break;
+        this = (struct reactor_rmcios *)
+            allocate_storage (context, sizeof (struct reactor_rmcios), 0);
+        if (this == 0)
+            break;
+        if (reactor_init (this, context) != 0)
+        {
+            free_storage (context, this, 0);
+            break;
+        }
+        this->id = create_channel_param (context, paramtype, param, 0,
+                                         (class_rmcios) reactor_class_func,
+                                         this);
+        break;
+
+    case setup_rmcios:
+        if (this == 0 || num_params < 2)
+            break;
+        return_int (context, returnv,
+                    reactor_add_timer (this,
+                                       param_to_integer (context, paramtype,
+                                                         param, 0),
+                                       param_to_channel (context, paramtype,
+                                                         param, 1)));
+        break;
+
+    case write_rmcios:
+        if (this == 0)
+            break;
+        if (num_params == 0)
+        {
+            reactor_run (this, 0);
+        }
+        else if (num_params >= 2)
+        {
+            int fd = param_to_integer (context, paramtype, param, 0);
+            int channel = param_to_channel (context, paramtype, param, 1);
+            if (channel == 0)
+            {
+                reactor_remove (this, fd);
+            }
+            else
+            {
+                reactor_add_fd (this, fd, channel);
+            }
+        }
+        break;
+
+    case read_rmcios:
+        if (this == 0)
+            break;
+        return_int (context, returnv, this->num_sources);
+        break;
+
+    default:
+        break;
+    }
+}
+
+int reactor_writev (int fd, const struct gather_rmcios *gather)
+{
+    struct iovec iov[REACTOR_MAX_IOV];
+    int segment = 0;
+    // Bytes already written from the first segment in iov:
+    size_t offset = 0;
+    int written = 0;
+
+    while (segment < gather->count)
+    {
+        int n = 0;
+        ssize_t result;
+        size_t remaining;
+
+        while (n < REACTOR_MAX_IOV && segment + n < gather->count)
+        {
+            const struct buffer_rmcios *b = gather->segments + segment + n;
+            iov[n].iov_base = b->data;
+            iov[n].iov_len = b->length;
+            n++;
+        }
+        iov[0].iov_base = (char *) iov[0].iov_base + offset;
+        iov[0].iov_len -= offset;
+
+        result = writev (fd, iov, n);
+        if (result < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if ((errno == EAGAIN || errno == EWOULDBLOCK) && written > 0)
+            {
+                // Report partial progress to the caller
+                return written;
+            }
+            return -1;
+        }
+        written += result;
+
+        // Skip fully written segments:
+        remaining = result;
+        for (n = 0; n < REACTOR_MAX_IOV && segment < gather->count; n++)
+        {
+            if (remaining < iov[n].iov_len)
+            {
+                break;
+            }
+            remaining -= iov[n].iov_len;
+            segment++;
+            offset = 0;
+        }
+        offset += remaining;
+    }
+    return written;
+}
+
+void init_reactor_channels (const struct context_rmcios *context)
+{
+    create_channel_str (context, "reactor",
+                        (class_rmcios) reactor_class_func, 0);
+}
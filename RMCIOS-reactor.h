@@ -0,0 +1,155 @@
+/*
+RMCIOS - Reactive Multipurpose Control Input Output System
+Copyright (c) 2018 Frans Korhonen
+
+RMCIOS was originally developed at Institute for Atmospheric 
+and Earth System Research / Physics, Faculty of Science, 
+University of Helsinki, Finland
+
+Assistance, experience and feedback from following persons have been 
+critical for development of RMCIOS: Erkki Siivola, Juha Kangasluoma, 
+Lauri Ahonen, Ella Häkkinen, Pasi Aalto, Joonas Enroth, Runlong Cai, 
+Markku Kulmala and Tuukka Petäjä.
+
+This file is part of RMCIOS. This notice was encoded using utf-8.
+
+RMCIOS is free software: you can redistribute this file and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RMCIOS is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public Licenses
+along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file RMCIOS-reactor.h
+ * @author Frans Korhonen
+ * @brief epoll based I/O reactor channel for file descriptors (Linux).
+ *
+ * Single thread running the reactor serves all registered file 
+ * descriptors and timers. Received data is written to the registered 
+ * channel as read only binary buffer pointing to the reactor receive 
+ * buffer. The buffer is valid only during the write call.
+ *
+ * The source table is not synchronized. reactor_add_fd(), 
+ * reactor_add_timer() and reactor_remove() must be called on the thread 
+ * that runs reactor_run()/reactor_loop(), for example from a channel 
+ * that receives reactor events. Other threads must hand registrations 
+ * over to the reactor thread. Only reactor_stop() may be called from 
+ * any thread.
+ *
+ * Channel interface:
+ * create reactor newname
+ * write reactor fd channel -> register fd. Data is written to channel.
+ * write reactor fd 0 -> unregister fd
+ * setup reactor period_ms channel -> add periodic timer. Returns timer fd.
+ * write reactor -> dispatch pending events without waiting.
+ * read reactor -> number of registered sources.
+ *
+ * Changelog: (date,who,description)
+ *
+ * */
+#ifndef rmcios_reactor_h
+#define rmcios_reactor_h
+
+#include "RMCIOS-API.h"
+
+/// Maximum number of file descriptors and timers served by a reactor
+#ifndef REACTOR_MAX_SOURCES
+#define REACTOR_MAX_SOURCES 512
+#endif
+
+/// Size of receive buffer
+#ifndef REACTOR_BUFFER_SIZE
+#define REACTOR_BUFFER_SIZE 4096
+#endif
+
+/// Number of events handled on one epoll_wait
+#ifndef REACTOR_MAX_EVENTS
+#define REACTOR_MAX_EVENTS 64
+#endif
+
+/// Number of segments written with one writev call
+#ifndef REACTOR_MAX_IOV
+#define REACTOR_MAX_IOV 64
+#endif
+
+/// @brief Registered file descriptor or timer
+struct reactor_source_rmcios
+{
+    int fd;
+    /// Channel that receives data (0 on unused source)
+    int channel;
+    /// Set on timerfd sources
+    int timer;
+    /// Incremented when the source slot is reused. 
+    /// Events of earlier registrations are ignored.
+    unsigned int generation;
+};
+
+/// @brief Reactor channel data
+struct reactor_rmcios
+{
+    const struct context_rmcios *context;
+    int id;
+    int epoll_fd;
+    volatile int running;
+    int num_sources;
+    struct reactor_source_rmcios sources[REACTOR_MAX_SOURCES];
+    char buffer[REACTOR_BUFFER_SIZE];
+};
+
+/// @brief Register reactor channel class to the context.
+void init_reactor_channels (const struct context_rmcios *context);
+
+/// @brief Initialize reactor
+/// @return 0 on success. -1 on failure.
+int reactor_init (struct reactor_rmcios *reactor,
+                  const struct context_rmcios *context);
+
+/// @brief Register file descriptor.
+/// Data received from @p fd is written to @p channel.
+/// Empty write is made to @p channel when the fd is closed by the peer.
+/// Must be called on the reactor thread.
+/// @return 0 on success. -1 on failure.
+int reactor_add_fd (struct reactor_rmcios *reactor, int fd, int channel);
+
+/// @brief Add periodic timer.
+/// Number of expirations is written to @p channel on each expiry.
+/// Must be called on the reactor thread.
+/// @return file descriptor of the timer. -1 on failure.
+int reactor_add_timer (struct reactor_rmcios *reactor,
+                       int period_ms, int channel);
+
+/// @brief Unregister file descriptor or timer.
+/// Timer file descriptors are closed.
+/// Must be called on the reactor thread.
+void reactor_remove (struct reactor_rmcios *reactor, int fd);
+
+/// @brief Wait and dispatch events.
+/// @param timeout_ms maximum time to wait. -1 waits indefinitely.
+/// @return number of dispatched events. -1 on error.
+int reactor_run (struct reactor_rmcios *reactor, int timeout_ms);
+
+/// @brief Run reactor until reactor_stop() is called.
+void reactor_loop (struct reactor_rmcios *reactor);
+
+/// @brief Stop reactor_loop()
+/// Can be called from any thread.
+void reactor_stop (struct reactor_rmcios *reactor);
+
+/// @brief Write scatter-gather chain to file descriptor.
+/// Segments are written with writev without linearizing.
+/// Partial writes are continued until all data is written or 
+/// non-blocking @p fd would block.
+/// @return number of bytes written. -1 on error or when nothing could
+///         be written.
+int reactor_writev (int fd, const struct gather_rmcios *gather);
+
+#endif
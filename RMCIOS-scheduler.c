@@ -0,0 +1,399 @@
+/*
+RMCIOS - Reactive Multipurpose Control Input Output System
+Copyright (c) 2018 Frans Korhonen
+
+RMCIOS was originally developed at Institute for Atmospheric 
+and Earth System Research / Physics, Faculty of Science, 
+University of Helsinki, Finland
+
+Assistance, experience and feedback from following persons have been 
+critical for development of RMCIOS: Erkki Siivola, Juha Kangasluoma, 
+Lauri Ahonen, Ella Häkkinen, Pasi Aalto, Joonas Enroth, Runlong Cai, 
+Markku Kulmala and Tuukka Petäjä.
+
+This file is part of RMCIOS. This notice was encoded using utf-8.
+
+RMCIOS is free software: you can redistribute this file and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RMCIOS is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public Licenses
+along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RMCIOS-scheduler.h"
+#include "RMCIOS-functions.h"
+
+#define BATCH_SLOT SCHEDULER_SLOTS
+#define GENERATION_MASK 0x7FFF
+
+static void list_push (struct scheduler_rmcios *s, int slot, int index)
+{
+    struct scheduler_entry_rmcios *e = s->entries + index;
+    e->slot = slot;
+    e->prev = -1;
+    e->next = s->heads[slot];
+    if (e->next >= 0)
+    {
+        s->entries[e->next].prev = index;
+    }
+    s->heads[slot] = index;
+}
+
+static void list_remove (struct scheduler_rmcios *s, int index)
+{
+    struct scheduler_entry_rmcios *e = s->entries + index;
+    if (e->prev >= 0)
+    {
+        s->entries[e->prev].next = e->next;
+    }
+    else
+    {
+        s->heads[e->slot] = e->next;
+    }
+    if (e->next >= 0)
+    {
+        s->entries[e->next].prev = e->prev;
+    }
+    e->slot = -1;
+}
+
+// Put entry to the wheel slot matching its expiry time
+static void wheel_insert (struct scheduler_rmcios *s, int index)
+{
+    unsigned long long expires = s->entries[index].expires;
+    unsigned long long delta;
+    int level;
+
+    if (expires < s->current)
+    {
+        // Already expired. Run on the next processed tick.
+        list_push (s, s->current & SCHEDULER_LEVEL_MASK, index);
+        return;
+    }
+
+    delta = expires - s->current;
+    for (level = 0; level < SCHEDULER_LEVELS - 1; level++)
+    {
+        if (delta < (1ULL << (SCHEDULER_LEVEL_BITS * (level + 1))))
+        {
+            break;
+        }
+    }
+    if (delta >= (1ULL << (SCHEDULER_LEVEL_BITS * SCHEDULER_LEVELS)))
+    {
+        // Beyond wheel range. Cascaded down again later.
+        expires = s->current +
+            (1ULL << (SCHEDULER_LEVEL_BITS * SCHEDULER_LEVELS)) - 1;
+    }
+    list_push (s, level * SCHEDULER_LEVEL_SIZE +
+               ((expires >> (SCHEDULER_LEVEL_BITS * level))
+                & SCHEDULER_LEVEL_MASK), index);
+}
+
+// Move entries of higher level slot to lower levels.
+// Returns index of the cascaded slot.
+static int cascade (struct scheduler_rmcios *s, int level)
+{
+    int index = (s->current >> (SCHEDULER_LEVEL_BITS * level))
+        & SCHEDULER_LEVEL_MASK;
+    int slot = level * SCHEDULER_LEVEL_SIZE + index;
+    int entry = s->heads[slot];
+
+    s->heads[slot] = -1;
+    while (entry >= 0)
+    {
+        int next = s->entries[entry].next;
+        wheel_insert (s, entry);
+        entry = next;
+    }
+    return index;
+}
+
+static void free_entry (struct scheduler_rmcios *s, int index)
+{
+    struct scheduler_entry_rmcios *e = s->entries + index;
+    e->slot = -1;
+    e->generation = (e->generation + 1) & GENERATION_MASK;
+    if (e->generation == 0)
+    {
+        e->generation = 1;
+    }
+    e->next = s->free_list;
+    s->free_list = index;
+    s->num_entries--;
+}
+
+int scheduler_init (struct scheduler_rmcios *s,
+                    const struct context_rmcios *context, int capacity)
+{
+    int i;
+    if (capacity <= 0 || capacity > SCHEDULER_MAX_ENTRIES)
+    {
+        capacity = SCHEDULER_DEFAULT_ENTRIES;
+    }
+    s->entries = (struct scheduler_entry_rmcios *)
+        allocate_storage (context,
+                          capacity * sizeof (struct scheduler_entry_rmcios),
+                          0);
+    if (s->entries == 0)
+    {
+        return -1;
+    }
+    s->id = 0;
+    s->current = 0;
+    s->capacity = capacity;
+    s->num_entries = 0;
+    s->advancing = 0;
+    s->deferred_ticks = 0;
+    for (i = 0; i <= SCHEDULER_SLOTS; i++)
+    {
+        s->heads[i] = -1;
+    }
+    for (i = 0; i < capacity; i++)
+    {
+        s->entries[i].slot = -1;
+        s->entries[i].generation = 1;
+        s->entries[i].prev = -1;
+        s->entries[i].next = (i + 1 < capacity) ? i + 1 : -1;
+    }
+    s->free_list = 0;
+    return 0;
+}
+
+int scheduler_add (struct scheduler_rmcios *s,
+                   unsigned int delay, unsigned int period,
+                   int channel, enum function_rmcios function)
+{
+    int index = s->free_list;
+    struct scheduler_entry_rmcios *e;
+
+    if (index < 0 || channel == 0)
+    {
+        return 0;
+    }
+    e = s->entries + index;
+    s->free_list = e->next;
+    s->num_entries++;
+
+    e->expires = s->current + delay;
+    e->period = period;
+    e->channel = channel;
+    e->function = function;
+    wheel_insert (s, index);
+    return (e->generation << SCHEDULER_INDEX_BITS) | index;
+}
+
+int scheduler_cancel (struct scheduler_rmcios *s, int handle)
+{
+    int index = handle & (SCHEDULER_MAX_ENTRIES - 1);
+    unsigned int generation = (unsigned int) handle >> SCHEDULER_INDEX_BITS;
+
+    if (handle <= 0 || index >= s->capacity
+        || s->entries[index].slot < 0
+        || s->entries[index].generation != generation)
+    {
+        return -1;
+    }
+    list_remove (s, index);
+    free_entry (s, index);
+    return 0;
+}
+
+// Process single tick
+static void scheduler_tick (struct scheduler_rmcios *s,
+                            const struct context_rmcios *context)
+{
+    int index = s->current & SCHEDULER_LEVEL_MASK;
+    int entry;
+    int level;
+
+    if (index == 0)
+    {
+        for (level = 1; level < SCHEDULER_LEVELS; level++)
+        {
+            if (cascade (s, level) != 0)
+            {
+                break;
+            }
+        }
+    }
+    s->current++;
+
+    // Take all entries of the tick as one batch
+    s->heads[BATCH_SLOT] = s->heads[index];
+    s->heads[index] = -1;
+    for (entry = s->heads[BATCH_SLOT]; entry >= 0;
+         entry = s->entries[entry].next)
+    {
+        s->entries[entry].slot = BATCH_SLOT;
+    }
+
+    while ((entry = s->heads[BATCH_SLOT]) >= 0)
+    {
+        struct scheduler_entry_rmcios *e = s->entries + entry;
+        int channel = e->channel;
+        enum function_rmcios function = e->function;
+
+        list_remove (s, entry);
+        if (e->period > 0)
+        {
+            e->expires += e->period;
+            wheel_insert (s, entry);
+        }
+        else
+        {
+            free_entry (s, entry);
+        }
+        run_channel (context, channel, function, int_rmcios,
+                     0, 0, (union param_rmcios) 0);
+    }
+}
+
+void scheduler_advance (struct scheduler_rmcios *s,
+                        const struct context_rmcios *context,
+                        unsigned int ticks)
+{
+    if (s->advancing)
+    {
+        // Called from scheduled call. Batch slot is in use.
+        s->deferred_ticks += ticks;
+        return;
+    }
+    s->advancing = 1;
+    for (;;)
+    {
+        int index;
+        if (ticks == 0)
+        {
+            if (s->deferred_ticks == 0)
+            {
+                break;
+            }
+            ticks = s->deferred_ticks;
+            s->deferred_ticks = 0;
+        }
+        index = s->current & SCHEDULER_LEVEL_MASK;
+        if (index != 0 && s->heads[index] < 0)
+        {
+            // Skip empty ticks up to the next cascade boundary.
+            unsigned int skip = 1;
+            while (index + skip < SCHEDULER_LEVEL_SIZE && skip < ticks
+                   && s->heads[index + skip] < 0)
+            {
+                skip++;
+            }
+            s->current += skip;
+            ticks -= skip;
+            continue;
+        }
+        scheduler_tick (s, context);
+        ticks--;
+    }
+    s->advancing = 0;
+}
+
+void scheduler_class_func (struct scheduler_rmcios *this,
+                           const struct context_rmcios *context,
+                           int id,
+                           enum function_rmcios function,
+                           enum type_rmcios paramtype,
+                           struct combo_rmcios *returnv,
+                           int num_params, const union param_rmcios param)
+{
+    switch (function)
+    {
+    case help_rmcios:
+        return_string (context, returnv,
+                       "scheduler channel - timing wheel scheduler\r\n"
+                       "create scheduler newname [max_entries]\r\n"
+                       "write newname delay period channel [function]\r\n"
+                       " #schedule call. Returns handle."
+                       " Period 0 for single call\r\n"
+                       "setup newname handle #cancel scheduled call\r\n"
+                       "write newname #advance one tick\r\n"
+                       "write newname ticks #advance ticks\r\n"
+                       "read newname #current tick\r\n");
+        break;
+
+    case create_rmcios:
+        if (num_params < 1)
+            break;
+        this = (struct scheduler_rmcios *)
+            allocate_storage (context, sizeof (struct scheduler_rmcios), 0);
+        if (this == 0)
+            break;
+        if (scheduler_init (this, context, (num_params > 1) ?
+                            param_to_integer (context, paramtype,
+                                              param, 1) : 0) != 0)
+        {
+            free_storage (context, this, 0);
+            break;
+        }
+        this->id = create_channel_param (context, paramtype, param, 0,
+                                         (class_rmcios)
+                                         scheduler_class_func, this);
+        break;
+
+    case setup_rmcios:
+        if (this == 0 || num_params < 1)
+            break;
+        scheduler_cancel (this,
+                          param_to_integer (context, paramtype, param, 0));
+        break;
+
+    case write_rmcios:
+        if (this == 0)
+            break;
+        if (num_params == 0)
+        {
+            scheduler_advance (this, context, 1);
+        }
+        else if (num_params < 3)
+        {
+            scheduler_advance (this, context,
+                               param_to_integer (context, paramtype,
+                                                 param, 0));
+        }
+        else
+        {
+            enum function_rmcios call_function = write_rmcios;
+            if (num_params > 3)
+            {
+                call_function = param_to_function (context, paramtype,
+                                                   param, 3);
+            }
+            return_int (context, returnv,
+                        scheduler_add (this,
+                                       param_to_integer (context, paramtype,
+                                                         param, 0),
+                                       param_to_integer (context, paramtype,
+                                                         param, 1),
+                                       param_to_channel (context, paramtype,
+                                                         param, 2),
+                                       call_function));
+        }
+        break;
+
+    case read_rmcios:
+        if (this == 0)
+            break;
+        return_int64 (context, returnv, (long long) this->current);
+        break;
+
+    default:
+        break;
+    }
+}
+
+void init_scheduler_channels (const struct context_rmcios *context)
+{
+    create_channel_str (context, "scheduler",
+                        (class_rmcios) scheduler_class_func, 0);
+}
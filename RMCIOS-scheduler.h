@@ -0,0 +1,146 @@
+/*
+RMCIOS - Reactive Multipurpose Control Input Output System
+Copyright (c) 2018 Frans Korhonen
+
+RMCIOS was originally developed at Institute for Atmospheric 
+and Earth System Research / Physics, Faculty of Science, 
+University of Helsinki, Finland
+
+Assistance, experience and feedback from following persons have been 
+critical for development of RMCIOS: Erkki Siivola, Juha Kangasluoma, 
+Lauri Ahonen, Ella Häkkinen, Pasi Aalto, Joonas Enroth, Runlong Cai, 
+Markku Kulmala and Tuukka Petäjä.
+
+This file is part of RMCIOS. This notice was encoded using utf-8.
+
+RMCIOS is free software: you can redistribute this file and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RMCIOS is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public Licenses
+along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file RMCIOS-scheduler.h
+ * @author Frans Korhonen
+ * @brief Scheduler channel for periodic and delayed channel calls.
+ *
+ * Scheduled entries are kept in a hierarchical timing wheel. Inserting
+ * and cancelling entries takes constant time. Time is counted in ticks
+ * that are given to the scheduler by writes (eg. from reactor timer).
+ * Entries expiring on the same tick are run as one batch.
+ * Empty ticks are skipped without processing, so long time spans
+ * can be advanced quickly (see RMCIOS-simulation.h).
+ * Advance requested by a scheduled call is made after the running 
+ * advance has completed.
+ *
+ * Channel interface:
+ * create scheduler newname [max_entries]
+ * write newname delay period channel [function] 
+ *       -> schedule call. Returns handle. period 0 for single call.
+ * setup newname handle -> cancel scheduled call
+ * write newname -> advance one tick
+ * write newname ticks -> advance given number of ticks
+ * read newname -> current tick (int64)
+ *
+ * Changelog: (date,who,description)
+ *
+ * */
+#ifndef rmcios_scheduler_h
+#define rmcios_scheduler_h
+
+#include "RMCIOS-API.h"
+
+#define SCHEDULER_LEVEL_BITS 6
+#define SCHEDULER_LEVEL_SIZE (1 << SCHEDULER_LEVEL_BITS)
+#define SCHEDULER_LEVEL_MASK (SCHEDULER_LEVEL_SIZE - 1)
+#define SCHEDULER_LEVELS 4
+#define SCHEDULER_SLOTS (SCHEDULER_LEVELS * SCHEDULER_LEVEL_SIZE)
+
+// Handles are formed from entry index and generation count
+#define SCHEDULER_INDEX_BITS 16
+#define SCHEDULER_MAX_ENTRIES (1 << SCHEDULER_INDEX_BITS)
+
+/// Default number of entries
+#ifndef SCHEDULER_DEFAULT_ENTRIES
+#define SCHEDULER_DEFAULT_ENTRIES 4096
+#endif
+
+/// @brief Scheduled channel call
+struct scheduler_entry_rmcios
+{
+    /// Links of the slot list. -1 on end of list.
+    int next;
+    int prev;
+    /// Slot the entry is listed in. -1 on free entry.
+    int slot;
+    unsigned int generation;
+    /// Tick of next expiry
+    unsigned long long expires;
+    /// Repeat period in ticks. 0 on single call.
+    unsigned int period;
+    int channel;
+    enum function_rmcios function;
+};
+
+/// @brief Scheduler channel data
+struct scheduler_rmcios
+{
+    int id;
+    /// Next tick to be processed
+    unsigned long long current;
+    int capacity;
+    int num_entries;
+    /// First free entry
+    int free_list;
+    /// Slot list heads. Last slot holds the batch being run.
+    int heads[SCHEDULER_SLOTS + 1];
+    /// Set while expired calls are run
+    int advancing;
+    /// Ticks requested by scheduled calls during advance
+    unsigned int deferred_ticks;
+    struct scheduler_entry_rmcios *entries;
+};
+
+/// @brief Register scheduler channel class to the context.
+void init_scheduler_channels (const struct context_rmcios *context);
+
+/// @brief Initialize scheduler
+/// @param scheduler pointer to scheduler to be initialized
+/// @param context pointer to target system context
+/// @param capacity maximum number of scheduled entries
+/// @return 0 on success. -1 on failure.
+int scheduler_init (struct scheduler_rmcios *scheduler,
+                    const struct context_rmcios *context, int capacity);
+
+/// @brief Schedule channel call
+/// @param scheduler pointer to scheduler
+/// @param delay ticks until first call
+/// @param period ticks between calls. 0 for single call.
+/// @param channel channel to be called
+/// @param function channel function to be called
+/// @return handle of scheduled entry. 0 when scheduler is full.
+int scheduler_add (struct scheduler_rmcios *scheduler,
+                   unsigned int delay, unsigned int period,
+                   int channel, enum function_rmcios function);
+
+/// @brief Cancel scheduled call
+/// @return 0 on success. -1 on invalid handle.
+int scheduler_cancel (struct scheduler_rmcios *scheduler, int handle);
+
+/// @brief Advance scheduler time and run expired calls.
+/// @param scheduler pointer to scheduler
+/// @param context pointer to context used for running the calls
+/// @param ticks number of ticks to advance
+void scheduler_advance (struct scheduler_rmcios *scheduler,
+                        const struct context_rmcios *context,
+                        unsigned int ticks);
+
+#endif
@@ -0,0 +1,109 @@
+/*
+RMCIOS - Reactive Multipurpose Control Input Output System
+Copyright (c) 2018 Frans Korhonen
+
+RMCIOS was originally developed at Institute for Atmospheric 
+and Earth System Research / Physics, Faculty of Science, 
+University of Helsinki, Finland
+
+Assistance, experience and feedback from following persons have been 
+critical for development of RMCIOS: Erkki Siivola, Juha Kangasluoma, 
+Lauri Ahonen, Ella Häkkinen, Pasi Aalto, Joonas Enroth, Runlong Cai, 
+Markku Kulmala and Tuukka Petäjä.
+
+This file is part of RMCIOS. This notice was encoded using utf-8.
+
+RMCIOS is free software: you can redistribute this file and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RMCIOS is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public Licenses
+along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RMCIOS-simulation.h"
+#include "RMCIOS-functions.h"
+
+long long simulation_time (struct simulation_rmcios *simulation)
+{
+    unsigned long long tick = simulation->scheduler->current;
+    // During and after processing, time is the last processed tick.
+    if (tick > 0)
+    {
+        tick--;
+    }
+    return simulation->start_time + tick * simulation->tick_time;
+}
+
+// Virtual clock channel
+static void simulation_clock_func (void *data,
+                                   const struct context_rmcios *context,
+                                   int id,
+                                   enum function_rmcios function,
+                                   enum type_rmcios paramtype,
+                                   struct combo_rmcios *returnv,
+                                   int num_params,
+                                   union param_rmcios param)
+{
+    struct simulation_rmcios *simulation =
+        (struct simulation_rmcios *) data;
+    long long time;
+
+    if (function != read_rmcios)
+    {
+        return;
+    }
+    time = simulation_time (simulation);
+    if (returnv != 0 && returnv->paramtype == binary_rmcios)
+    {
+        return_binary (context, returnv, (const char *) &time,
+                       sizeof (time));
+    }
+    else
+    {
+        // Seconds for text and numeric readers
+        return_double (context, returnv, time / 1e9);
+    }
+}
+
+const struct context_rmcios *simulation_init (struct simulation_rmcios
+                                              *simulation,
+                                              const struct context_rmcios
+                                              *parent,
+                                              struct scheduler_rmcios
+                                              *scheduler,
+                                              long long start_time,
+                                              long long tick_time)
+{
+    copy_context (&simulation->context, parent);
+    simulation->scheduler = scheduler;
+    simulation->start_time = start_time;
+    simulation->tick_time = (tick_time > 0) ? tick_time : 1;
+    simulation->context.clock = create_channel (parent, 0, 0,
+                                                simulation_clock_func,
+                                                simulation);
+    if (simulation->context.clock == 0)
+    {
+        return 0;
+    }
+    return &simulation->context;
+}
+
+void simulation_run (struct simulation_rmcios *simulation,
+                     long long duration)
+{
+    long long ticks = duration / simulation->tick_time;
+    while (ticks > 0)
+    {
+        unsigned int step = (ticks > 0x7FFFFFFF) ? 0x7FFFFFFF : ticks;
+        scheduler_advance (simulation->scheduler, &simulation->context,
+                           step);
+        ticks -= step;
+    }
+}
@@ -0,0 +1,95 @@
+/*
+RMCIOS - Reactive Multipurpose Control Input Output System
+Copyright (c) 2018 Frans Korhonen
+
+RMCIOS was originally developed at Institute for Atmospheric 
+and Earth System Research / Physics, Faculty of Science, 
+University of Helsinki, Finland
+
+Assistance, experience and feedback from following persons have been 
+critical for development of RMCIOS: Erkki Siivola, Juha Kangasluoma, 
+Lauri Ahonen, Ella Häkkinen, Pasi Aalto, Joonas Enroth, Runlong Cai, 
+Markku Kulmala and Tuukka Petäjä.
+
+This file is part of RMCIOS. This notice was encoded using utf-8.
+
+RMCIOS is free software: you can redistribute this file and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RMCIOS is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public Licenses
+along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file RMCIOS-simulation.h
+ * @author Frans Korhonen
+ * @brief Virtual time context for fast-forward simulation.
+ *
+ * Simulation context replaces the context clock with a virtual clock 
+ * that follows scheduler time. Running the simulation advances the 
+ * scheduler directly from one scheduled call to the next, so long 
+ * control sequences are replayed without waiting for wall-clock time.
+ *
+ * Channels must be given the simulation context (simulation.context) and
+ * take timestamps with read_time(). Timers and recorded stimuli are 
+ * scheduled to the simulation scheduler.
+ *
+ * Changelog: (date,who,description)
+ *
+ * */
+#ifndef rmcios_simulation_h
+#define rmcios_simulation_h
+
+#include "RMCIOS-API.h"
+#include "RMCIOS-scheduler.h"
+
+/// @brief Simulation state
+struct simulation_rmcios
+{
+    /// Context to be given to channels.
+    struct context_rmcios context;
+    /// Scheduler that drives the simulation
+    struct scheduler_rmcios *scheduler;
+    /// Virtual time at tick 0 (ns)
+    long long start_time;
+    /// Length of scheduler tick (ns)
+    long long tick_time;
+};
+
+/// @brief Initialize simulation context
+///
+/// Creates the virtual clock channel.
+/// @param simulation pointer to simulation to be initialized
+/// @param parent context the simulation runs on
+/// @param scheduler scheduler for timers and scheduled writes
+/// @param start_time virtual time at the first tick (ns)
+/// @param tick_time length of scheduler tick (ns)
+/// @return pointer to the simulation context. 0 on failure.
+const struct context_rmcios *simulation_init (struct simulation_rmcios
+                                              *simulation,
+                                              const struct context_rmcios
+                                              *parent,
+                                              struct scheduler_rmcios
+                                              *scheduler,
+                                              long long start_time,
+                                              long long tick_time);
+
+/// @brief Run simulation
+///
+/// Runs all scheduled calls within @p duration of virtual time.
+/// @param simulation pointer to simulation
+/// @param duration virtual time to run (ns)
+void simulation_run (struct simulation_rmcios *simulation,
+                     long long duration);
+
+/// @brief Get current virtual time (ns)
+long long simulation_time (struct simulation_rmcios *simulation);
+
+#endif
@@ -0,0 +1,324 @@
+/*
+RMCIOS - Reactive Multipurpose Control Input Output System
+Copyright (c) 2018 Frans Korhonen
+
+RMCIOS was originally developed at Institute for Atmospheric 
+and Earth System Research / Physics, Faculty of Science, 
+University of Helsinki, Finland
+
+Assistance, experience and feedback from following persons have been 
+critical for development of RMCIOS: Erkki Siivola, Juha Kangasluoma, 
+Lauri Ahonen, Ella Häkkinen, Pasi Aalto, Joonas Enroth, Runlong Cai, 
+Markku Kulmala and Tuukka Petäjä.
+
+This file is part of RMCIOS. This notice was encoded using utf-8.
+
+RMCIOS is free software: you can redistribute this file and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RMCIOS is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public Licenses
+along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RMCIOS-trace.h"
+#include "RMCIOS-functions.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// Current time in nanoseconds. Context clock is preferred.
+static long long trace_time (const struct context_rmcios *context)
+{
+    if (context_clock (context) != 0)
+    {
+        return read_time (context);
+    }
+    else
+    {
+        struct timespec now;
+        clock_gettime (CLOCK_MONOTONIC, &now);
+        return now.tv_sec * 1000000000LL + now.tv_nsec;
+    }
+}
+
+// Core channels of the context. Writes to warning, error and report 
+// channels or storage are not part of the data path.
+static int service_channel (const struct context_rmcios *context, int id)
+{
+    return id == context->errors || id == context->warning
+        || id == context->report || id == context->control
+        || id == context->mem || id == context->quemem
+        || id == context->name || id == context->id
+        || id == context->link || id == context->linked
+        || id == context->create || id == context->convert
+        || id == context_clock (context);
+}
+
+static struct trace_sink_rmcios *find_sink (struct trace_rmcios *trace,
+                                            int channel)
+{
+    int i;
+    for (i = 0; i < trace->num_sinks; i++)
+    {
+        if (trace->sinks[i].channel == channel)
+        {
+            return trace->sinks + i;
+        }
+    }
+    return 0;
+}
+
+static void record_latency (struct trace_sink_rmcios *sink,
+                            long long latency_ns, int hops)
+{
+    long long us = latency_ns / 1000;
+    int bucket = 0;
+
+    while (us > 1 && bucket < TRACE_BUCKETS - 1)
+    {
+        us >>= 1;
+        bucket++;
+    }
+    sink->buckets[bucket]++;
+    sink->count++;
+    sink->total_ns += latency_ns;
+    if (latency_ns > sink->max_ns)
+    {
+        sink->max_ns = latency_ns;
+    }
+    if (hops > sink->max_hops)
+    {
+        sink->max_hops = hops;
+    }
+}
+
+int trace_add_sink (struct trace_rmcios *trace, int channel)
+{
+    struct trace_sink_rmcios *sink = find_sink (trace, channel);
+    if (sink != 0)
+    {
+        return 0;
+    }
+    if (trace->num_sinks >= TRACE_SINKS)
+    {
+        return -1;
+    }
+    sink = trace->sinks + trace->num_sinks++;
+    memset (sink, 0, sizeof (*sink));
+    sink->channel = channel;
+    return 0;
+}
+
+const struct trace_sink_rmcios *trace_get (struct trace_rmcios *trace,
+                                           int channel)
+{
+    return find_sink (trace, channel);
+}
+
+long long trace_percentile (const struct trace_sink_rmcios *sink,
+                            int percent)
+{
+    unsigned long long target =
+        ((unsigned long long) sink->count * percent + 99) / 100;
+    unsigned long long seen = 0;
+    int bucket;
+
+    if (sink->count == 0)
+    {
+        return 0;
+    }
+    for (bucket = 0; bucket < TRACE_BUCKETS - 1; bucket++)
+    {
+        seen += sink->buckets[bucket];
+        if (seen >= target)
+        {
+            break;
+        }
+    }
+    if (bucket == TRACE_BUCKETS - 1
+        || (2LL << bucket) * 1000 > sink->max_ns)
+    {
+        return sink->max_ns;
+    }
+    return (2LL << bucket) * 1000;
+}
+
+void trace_save (const struct trace_rmcios *trace,
+                 struct trace_context_rmcios *saved)
+{
+    *saved = trace->current;
+}
+
+void trace_restore (struct trace_rmcios *trace,
+                    const struct trace_context_rmcios *saved)
+{
+    if (saved == 0)
+    {
+        trace->current.hops = -1;
+    }
+    else
+    {
+        trace->current = *saved;
+    }
+}
+
+void trace_clear (struct trace_rmcios *trace)
+{
+    int i;
+    for (i = 0; i < trace->num_sinks; i++)
+    {
+        int channel = trace->sinks[i].channel;
+        memset (trace->sinks + i, 0, sizeof (trace->sinks[i]));
+        trace->sinks[i].channel = channel;
+    }
+}
+
+int trace_report (struct trace_rmcios *trace, char *buffer, int size)
+{
+    int length = snprintf (buffer, size,
+                           "sink count max_hops average_us p50_us p99_us"
+                           " max_us\r\n");
+    int i;
+    for (i = 0; i < trace->num_sinks && length < size; i++)
+    {
+        const struct trace_sink_rmcios *sink = trace->sinks + i;
+        char name[32];
+        struct buffer_rmcios bname =
+            channel_name_borrow (trace->parent, sink->channel,
+                                 name, sizeof (name));
+        if (bname.length > 0)
+        {
+            length += snprintf (buffer + length, size - length, "%.*s",
+                                (int) bname.length, bname.data);
+        }
+        else
+        {
+            length += snprintf (buffer + length, size - length, "#%d",
+                                sink->channel);
+        }
+        if (length < size)
+        {
+            length += snprintf (buffer + length, size - length,
+                                " %u %d %lld %lld %lld %lld\r\n",
+                                sink->count, sink->max_hops,
+                                sink->count ?
+                                sink->total_ns / sink->count / 1000 : 0,
+                                trace_percentile (sink, 50) / 1000,
+                                trace_percentile (sink, 99) / 1000,
+                                sink->max_ns / 1000);
+        }
+    }
+    return (length < size) ? length : size - 1;
+}
+
+// Trace configuration channel
+static void trace_class_func (struct trace_rmcios *this,
+                              const struct context_rmcios *context,
+                              int id,
+                              enum function_rmcios function,
+                              enum type_rmcios paramtype,
+                              struct combo_rmcios *returnv,
+                              int num_params,
+                              const union param_rmcios param)
+{
+    switch (function)
+    {
+    case help_rmcios:
+        return_string (context, returnv,
+                       "trace channel - latency through linked channels\r\n"
+                       "setup trace sink #record latency of writes to sink\r\n"
+                       "read trace #latency report of sinks\r\n"
+                       "write trace #clear recorded latencies\r\n");
+        break;
+
+    case setup_rmcios:
+        if (num_params < 1)
+            break;
+        trace_add_sink (this, param_to_channel (context, paramtype,
+                                                param, 0));
+        break;
+
+    case write_rmcios:
+        trace_clear (this);
+        break;
+
+    case read_rmcios:
+        {
+            char report[TRACE_REPORT_SIZE];
+            int length = trace_report (this, report, sizeof (report));
+            return_buffer_chunked (context, returnv, report, length);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+// Carry trace context through nested writes
+static void trace_run (void *data,
+                       const struct context_rmcios *context,
+                       int id,
+                       enum function_rmcios function,
+                       enum type_rmcios paramtype,
+                       struct combo_rmcios *returnv,
+                       int num_params, union param_rmcios param)
+{
+    struct trace_rmcios *trace = (struct trace_rmcios *) data;
+    struct trace_context_rmcios previous = trace->current;
+    struct trace_sink_rmcios *sink;
+
+    if (function != write_rmcios || id == trace->id
+        || service_channel (trace->parent, id))
+    {
+        trace->parent->run_channel (trace->parent->data, context, id,
+                                    function, paramtype, returnv,
+                                    num_params, param);
+        return;
+    }
+
+    if (trace->current.hops < 0)
+    {
+        trace->current.origin_ns = trace_time (trace->parent);
+        trace->current.origin = id;
+        trace->current.hops = 0;
+    }
+    else
+    {
+        trace->current.hops++;
+    }
+    sink = find_sink (trace, id);
+    if (sink != 0)
+    {
+        record_latency (sink,
+                        trace_time (trace->parent) - trace->current.origin_ns,
+                        trace->current.hops);
+    }
+    trace->parent->run_channel (trace->parent->data, context, id, function,
+                                paramtype, returnv, num_params, param);
+    trace->current = previous;
+}
+
+const struct context_rmcios *trace_init (struct trace_rmcios *trace,
+                                         const struct context_rmcios
+                                         *parent)
+{
+    trace->parent = parent;
+    trace->num_sinks = 0;
+    memset (&trace->current, 0, sizeof (trace->current));
+    trace->current.hops = -1;
+    trace->id = create_channel_str (parent, "trace",
+                                    (class_rmcios) trace_class_func, trace);
+    copy_context (&trace->context, parent);
+    trace->context.run_channel = trace_run;
+    trace->context.data = trace;
+    return &trace->context;
+}
@@ -0,0 +1,165 @@
+/*
+RMCIOS - Reactive Multipurpose Control Input Output System
+Copyright (c) 2018 Frans Korhonen
+
+RMCIOS was originally developed at Institute for Atmospheric 
+and Earth System Research / Physics, Faculty of Science, 
+University of Helsinki, Finland
+
+Assistance, experience and feedback from following persons have been 
+critical for development of RMCIOS: Erkki Siivola, Juha Kangasluoma, 
+Lauri Ahonen, Ella Häkkinen, Pasi Aalto, Joonas Enroth, Runlong Cai, 
+Markku Kulmala and Tuukka Petäjä.
+
+This file is part of RMCIOS. This notice was encoded using utf-8.
+
+RMCIOS is free software: you can redistribute this file and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RMCIOS is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public Licenses
+along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file RMCIOS-trace.h
+ * @author Frans Korhonen
+ * @brief End-to-end latency tracing through linked channel chains.
+ *
+ * Context wrapper that attaches trace context to channel writes. 
+ * Outermost write starts the trace with origin timestamp. The trace 
+ * travels with nested writes (writes to linked channels) and each nested
+ * write adds one hop. On writes to chosen sink channels the latency from
+ * the origin is recorded to a histogram of the sink.
+ *
+ * Writes to the core channels of the context (warning, errors, report,
+ * mem, name, link...) are not hops and do not start traces.
+ *
+ * Writes that are deferred (queued and run later) lose the trace unless
+ * the queuing channel stores it with trace_save() and restores it 
+ * around the deferred write with trace_restore(). Trampoline, completion
+ * and asynclog channels do not depend on the trace wrapper and do not 
+ * call these: Latency of writes deferred by them is measured from the 
+ * deferred write, not from the original origin.
+ *
+ * Time is read from the context clock. Monotonic system clock is used
+ * when the context has no clock. Channels must be given the wrapper 
+ * context (trace.context). Calls through the wrapper are expected from 
+ * single thread.
+ *
+ * Tracing is configured with the trace channel:
+ *   setup trace sink   # record latency of writes to sink
+ *   read trace         # latency report of sinks
+ *   write trace        # clear recorded latencies
+ *
+ * Changelog: (date,who,description)
+ *
+ * */
+#ifndef rmcios_trace_h
+#define rmcios_trace_h
+
+#include "RMCIOS-API.h"
+
+/// Maximum number of sink channels
+#ifndef TRACE_SINKS
+#define TRACE_SINKS 16
+#endif
+
+/// Number of latency histogram buckets.
+/// Bucket n counts latencies from 2^n to 2^(n+1) microseconds.
+#ifndef TRACE_BUCKETS
+#define TRACE_BUCKETS 32
+#endif
+
+/// Size of report buffer
+#ifndef TRACE_REPORT_SIZE
+#define TRACE_REPORT_SIZE 4096
+#endif
+
+/// @brief Trace context that travels with a write
+struct trace_context_rmcios
+{
+    /// Time of the origin write in nanoseconds
+    long long origin_ns;
+    /// Channel of the origin write
+    int origin;
+    /// Number of nested writes from the origin. -1 when no trace.
+    int hops;
+};
+
+/// @brief Latency statistics of sink channel
+struct trace_sink_rmcios
+{
+    int channel;
+    unsigned int count;
+    /// Largest hop count seen
+    int max_hops;
+    long long total_ns;
+    long long max_ns;
+    unsigned int buckets[TRACE_BUCKETS];
+};
+
+/// @brief Latency tracing wrapper
+struct trace_rmcios
+{
+    /// Wrapper context given to channels
+    struct context_rmcios context;
+    const struct context_rmcios *parent;
+    /// Trace configuration channel
+    int id;
+    /// Trace of the running write
+    struct trace_context_rmcios current;
+    int num_sinks;
+    struct trace_sink_rmcios sinks[TRACE_SINKS];
+};
+
+/// @brief Initialize latency tracing wrapper
+///
+/// Creates the configuration channel named trace.
+/// @param trace wrapper to be initialized
+/// @param parent context the channel calls are forwarded to
+/// @return wrapper context for channels
+const struct context_rmcios *trace_init (struct trace_rmcios *trace,
+                                         const struct context_rmcios
+                                         *parent);
+
+/// @brief Record latency of writes to channel
+/// @return 0 on success. -1 when sink table is full.
+int trace_add_sink (struct trace_rmcios *trace, int channel);
+
+/// @brief Get latency statistics of sink channel
+/// @return pointer to statistics. 0 when channel is not a sink.
+const struct trace_sink_rmcios *trace_get (struct trace_rmcios *trace,
+                                           int channel);
+
+/// @brief Latency percentile from sink histogram
+/// @param percent percentile 0-100
+/// @return upper bound of the histogram bucket in nanoseconds.
+///         Limited to the largest latency.
+long long trace_percentile (const struct trace_sink_rmcios *sink,
+                            int percent);
+
+/// @brief Store trace of the running write for deferred write
+void trace_save (const struct trace_rmcios *trace,
+                 struct trace_context_rmcios *saved);
+
+/// @brief Continue stored trace. 
+///
+/// Call with 0 after the deferred write to end the trace.
+void trace_restore (struct trace_rmcios *trace,
+                    const struct trace_context_rmcios *saved);
+
+/// @brief Write latency report to buffer
+/// @return length of written data
+int trace_report (struct trace_rmcios *trace, char *buffer, int size);
+
+/// @brief Clear recorded latencies. Sinks are kept.
+void trace_clear (struct trace_rmcios *trace);
+
+#endif
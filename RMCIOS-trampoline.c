@@ -0,0 +1,556 @@
+/*
+RMCIOS - Reactive Multipurpose Control Input Output System
+Copyright (c) 2018 Frans Korhonen
+
+RMCIOS was originally developed at Institute for Atmospheric 
+and Earth System Research / Physics, Faculty of Science, 
+University of Helsinki, Finland
+
+Assistance, experience and feedback from following persons have been 
+critical for development of RMCIOS: Erkki Siivola, Juha Kangasluoma, 
+Lauri Ahonen, Ella Häkkinen, Pasi Aalto, Joonas Enroth, Runlong Cai, 
+Markku Kulmala and Tuukka Petäjä.
+
+This file is part of RMCIOS. This notice was encoded using utf-8.
+
+RMCIOS is free software: you can redistribute this file and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RMCIOS is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public Licenses
+along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RMCIOS-trampoline.h"
+#include "RMCIOS-functions.h"
+
+// Alignment of parameter copies in arena
+#define ARENA_ALIGN 8
+#define ALIGN_SIZE(size) (((size) + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1))
+
+#define NO_ARENA (~0u)
+
+static void copy_bytes (const char *src, char *dst, unsigned int length)
+{
+    unsigned int i;
+    for (i = 0; i < length; i++)
+    {
+        dst[i] = src[i];
+    }
+}
+
+// Size of single numeric parameter
+static unsigned int numeric_size (enum type_rmcios paramtype)
+{
+    switch (paramtype)
+    {
+    case int64_rmcios:
+        return sizeof (long long);
+    case double_rmcios:
+        return sizeof (double);
+    case float_rmcios:
+        return sizeof (float);
+    default:
+        return sizeof (int);
+    }
+}
+
+// Number of arrays holding num_params elements.
+// -1 when the array descriptors would not fit in the arena.
+static int array_count (int num_params, const struct array_rmcios *av)
+{
+    int arrays;
+    int counted = 0;
+    for (arrays = 0; counted < num_params; arrays++)
+    {
+        if (arrays >= (int) (TRAMPOLINE_ARENA_SIZE /
+                             sizeof (struct array_rmcios))
+            || av[arrays].count < 0
+            || av[arrays].count > TRAMPOLINE_ARENA_SIZE)
+        {
+            return -1;
+        }
+        counted += av[arrays].count;
+    }
+    return arrays;
+}
+
+// Number of combos holding num_params parameters.
+// -1 when the combo descriptors would not fit in the arena.
+static int combo_count (int num_params, const struct combo_rmcios *cv)
+{
+    int combos;
+    int counted = 0;
+    for (combos = 0; counted < num_params; combos++)
+    {
+        if (combos >= (int) (TRAMPOLINE_ARENA_SIZE /
+                             sizeof (struct combo_rmcios))
+            || cv[combos].num_params < 0
+            || cv[combos].num_params > TRAMPOLINE_ARENA_SIZE)
+        {
+            return -1;
+        }
+        counted += cv[combos].num_params;
+    }
+    return combos;
+}
+
+// Size of memory needed for copying parameter array. -1 when not copyable.
+static int param_copy_size (enum type_rmcios paramtype,
+                            int num_params, union param_rmcios param,
+                            int nested)
+{
+    int size = 0;
+    int i;
+
+    if (num_params <= 0 || paramtype == channel_rmcios)
+    {
+        return 0;
+    }
+    if (param.p == 0)
+    {
+        return -1;
+    }
+
+    switch (paramtype)
+    {
+    case int_rmcios:
+    case float_rmcios:
+    case int64_rmcios:
+    case double_rmcios:
+        return ALIGN_SIZE (num_params * numeric_size (paramtype));
+
+    case buffer_rmcios:
+    case binary_rmcios:
+        size = ALIGN_SIZE (num_params * sizeof (struct buffer_rmcios));
+        for (i = 0; i < num_params; i++)
+        {
+            size += ALIGN_SIZE (param.bv[i].length +
+                                param.bv[i].trailing_size);
+        }
+        return size;
+
+    case inline_rmcios:
+        return ALIGN_SIZE (num_params * sizeof (struct inline_rmcios));
+
+    case gather_rmcios:
+        size = ALIGN_SIZE (num_params * sizeof (struct gather_rmcios));
+        for (i = 0; i < num_params; i++)
+        {
+            int j;
+            unsigned int length = 0;
+            for (j = 0; j < param.gv[i].count; j++)
+            {
+                length += param.gv[i].segments[j].length;
+            }
+            size += ALIGN_SIZE (sizeof (struct buffer_rmcios));
+            size += ALIGN_SIZE (length);
+        }
+        return size;
+
+    case array_rmcios:
+        {
+            int arrays = array_count (num_params, param.av);
+            if (arrays < 0)
+            {
+                return -1;
+            }
+            size = ALIGN_SIZE (arrays * sizeof (struct array_rmcios));
+            for (i = 0; i < arrays; i++)
+            {
+                size += ALIGN_SIZE (param.av[i].count *
+                                    numeric_size (param.av[i].type));
+            }
+            return size;
+        }
+
+    case combo_rmcios:
+        {
+            int combos;
+            if (nested)
+            {
+                return -1;
+            }
+            combos = combo_count (num_params, param.cv);
+            if (combos < 0)
+            {
+                return -1;
+            }
+            size = ALIGN_SIZE (combos * sizeof (struct combo_rmcios));
+            for (i = 0; i < combos; i++)
+            {
+                int csize = param_copy_size (param.cv[i].paramtype,
+                                             param.cv[i].num_params,
+                                             param.cv[i].param, 1);
+                if (csize < 0)
+                {
+                    return -1;
+                }
+                size += csize;
+            }
+            return size;
+        }
+
+    default:
+        return -1;
+    }
+}
+
+// Copy parameter array to memory at *dst. Advances *dst past the copy.
+static union param_rmcios param_copy (enum type_rmcios paramtype,
+                                      int num_params,
+                                      union param_rmcios param, char **dst)
+{
+    union param_rmcios copy = param;
+    int i;
+
+    if (num_params <= 0 || paramtype == channel_rmcios)
+    {
+        return copy;
+    }
+
+    switch (paramtype)
+    {
+    case int_rmcios:
+    case float_rmcios:
+    case int64_rmcios:
+    case double_rmcios:
+        {
+            unsigned int length = num_params * numeric_size (paramtype);
+            copy.p = *dst;
+            copy_bytes (param.p, *dst, length);
+            *dst += ALIGN_SIZE (length);
+            break;
+        }
+
+    case buffer_rmcios:
+    case binary_rmcios:
+        copy.bv = (struct buffer_rmcios *) *dst;
+        *dst += ALIGN_SIZE (num_params * sizeof (struct buffer_rmcios));
+        for (i = 0; i < num_params; i++)
+        {
+            unsigned int length = param.bv[i].length +
+                param.bv[i].trailing_size;
+            copy.bv[i] = param.bv[i];
+            copy.bv[i].data = *dst;
+            // Copy is given as read only buffer without ownership
+            copy.bv[i].size = 0;
+            copy.bv[i].flags = 0;
+            copy_bytes (param.bv[i].data, *dst, length);
+            *dst += ALIGN_SIZE (length);
+        }
+        break;
+
+    case inline_rmcios:
+        {
+            unsigned int length = num_params * sizeof (struct inline_rmcios);
+            copy.p = *dst;
+            copy_bytes (param.p, *dst, length);
+            *dst += ALIGN_SIZE (length);
+            break;
+        }
+
+    case gather_rmcios:
+        copy.gv = (struct gather_rmcios *) *dst;
+        *dst += ALIGN_SIZE (num_params * sizeof (struct gather_rmcios));
+        for (i = 0; i < num_params; i++)
+        {
+            // Copy is linearized to single segment
+            struct buffer_rmcios *segment = (struct buffer_rmcios *) *dst;
+            int j;
+            *dst += ALIGN_SIZE (sizeof (struct buffer_rmcios));
+            segment->data = *dst;
+            segment->length = 0;
+            segment->size = 0;
+            segment->trailing_size = 0;
+            segment->flags = 0;
+            for (j = 0; j < param.gv[i].count; j++)
+            {
+                const struct buffer_rmcios *src = param.gv[i].segments + j;
+                copy_bytes (src->data, segment->data + segment->length,
+                            src->length);
+                segment->length += src->length;
+            }
+            segment->required_size = segment->length;
+            *dst += ALIGN_SIZE (segment->length);
+            copy.gv[i].segments = segment;
+            copy.gv[i].count = 1;
+        }
+        break;
+
+    case array_rmcios:
+        {
+            int arrays = array_count (num_params, param.av);
+            copy.av = (struct array_rmcios *) *dst;
+            *dst += ALIGN_SIZE (arrays * sizeof (struct array_rmcios));
+            for (i = 0; i < arrays; i++)
+            {
+                const struct array_rmcios *array = param.av + i;
+                unsigned int element = numeric_size (array->type);
+                int stride = array->stride ? array->stride : (int) element;
+                int j;
+                // Copy is packed to contiguous array
+                copy.av[i] = *array;
+                copy.av[i].data = *dst;
+                copy.av[i].stride = 0;
+                for (j = 0; j < array->count; j++)
+                {
+                    copy_bytes ((const char *) array->data + (long) j * stride,
+                                *dst + j * element, element);
+                }
+                *dst += ALIGN_SIZE (array->count * element);
+            }
+            break;
+        }
+
+    case combo_rmcios:
+        {
+            int combos = combo_count (num_params, param.cv);
+            copy.cv = (struct combo_rmcios *) *dst;
+            *dst += ALIGN_SIZE (combos * sizeof (struct combo_rmcios));
+            for (i = 0; i < combos; i++)
+            {
+                copy.cv[i] = param.cv[i];
+                copy.cv[i].param = param_copy (param.cv[i].paramtype,
+                                               param.cv[i].num_params,
+                                               param.cv[i].param, dst);
+            }
+            break;
+        }
+
+    default:
+        break;
+    }
+    return copy;
+}
+
+// Allocate memory from parameter arena. Returns 0 when arena is full.
+static char *arena_alloc (struct trampoline_rmcios *t, unsigned int size)
+{
+    unsigned int start;
+
+    if (t->arena_used == 0)
+    {
+        t->arena_head = 0;
+        t->arena_tail = 0;
+    }
+
+    if (t->arena_tail >= t->arena_head)
+    {
+        if (size <= TRAMPOLINE_ARENA_SIZE - t->arena_tail)
+        {
+            start = t->arena_tail;
+        }
+        else if (size < t->arena_head)
+        {
+            // Wrap around to the beginning of the arena
+            start = 0;
+        }
+        else
+        {
+            return 0;
+        }
+    }
+    else if (t->arena_tail + size < t->arena_head)
+    {
+        start = t->arena_tail;
+    }
+    else
+    {
+        return 0;
+    }
+
+    t->arena_tail = start + size;
+    t->arena_used++;
+    return t->arena.bytes + start;
+}
+
+// Calls that can be queued do not return data to the caller.
+// Calls to system channels are always run directly.
+static int call_deferrable (const struct context_rmcios *context,
+                            int id,
+                            enum function_rmcios function,
+                            struct combo_rmcios *returnv)
+{
+    if (function != write_rmcios)
+    {
+        return 0;
+    }
+    if (returnv != 0 && (returnv->paramtype != channel_rmcios
+                         || returnv->next != 0))
+    {
+        return 0;
+    }
+    if (id == context->mem || id == context->quemem
+        || id == context->name || id == context->id
+        || id == context->create || id == context->link)
+    {
+        return 0;
+    }
+    return 1;
+}
+
+// Queue channel call. Returns 0 when call could not be queued.
+static int trampoline_queue (struct trampoline_rmcios *t,
+                             const struct context_rmcios *context,
+                             int id,
+                             enum function_rmcios function,
+                             enum type_rmcios paramtype,
+                             struct combo_rmcios *returnv,
+                             int num_params, union param_rmcios param)
+{
+    struct trampoline_call_rmcios *call;
+    int size;
+    char *copy = 0;
+
+    if (t->queue_count >= TRAMPOLINE_QUEUE_SIZE)
+    {
+        return 0;
+    }
+    size = param_copy_size (paramtype, num_params, param, 0);
+    if (size < 0)
+    {
+        return 0;
+    }
+    if (size > 0)
+    {
+        copy = arena_alloc (t, size);
+        if (copy == 0)
+        {
+            return 0;
+        }
+    }
+
+    call = t->queue + ((t->queue_head + t->queue_count)
+                       % TRAMPOLINE_QUEUE_SIZE);
+    call->context = context;
+    call->id = id;
+    call->function = function;
+    call->paramtype = paramtype;
+    call->return_channel = 0;
+    call->return_params = 0;
+    if (returnv != 0)
+    {
+        call->return_channel = returnv->param.channel;
+        call->return_params = returnv->num_params;
+    }
+    call->num_params = num_params;
+    if (size > 0)
+    {
+        call->param = param_copy (paramtype, num_params, param, &copy);
+        call->arena_end = copy - t->arena.bytes;
+    }
+    else
+    {
+        call->param = param;
+        call->arena_end = NO_ARENA;
+    }
+
+    t->queue_count++;
+    t->deferred++;
+    return 1;
+}
+
+static void trampoline_run (void *data,
+                            const struct context_rmcios *context,
+                            int id,
+                            enum function_rmcios function,
+                            enum type_rmcios paramtype,
+                            struct combo_rmcios *returnv,
+                            int num_params, union param_rmcios param);
+
+// Run queued calls until the queue is empty.
+static void trampoline_drain (struct trampoline_rmcios *t)
+{
+    t->draining = 1;
+    while (t->queue_count > 0)
+    {
+        struct trampoline_call_rmcios call = t->queue[t->queue_head];
+        struct combo_rmcios returnv = {
+            .paramtype = channel_rmcios,
+            .num_params = call.return_params,
+            .param.channel = call.return_channel,
+            .next = 0
+        };
+        t->queue_head = (t->queue_head + 1) % TRAMPOLINE_QUEUE_SIZE;
+        t->queue_count--;
+
+        trampoline_run (t, call.context, call.id, call.function,
+                        call.paramtype,
+                        call.return_channel != 0 ? &returnv : 0,
+                        call.num_params, call.param);
+
+        // Release parameter copy
+        if (call.arena_end != NO_ARENA)
+        {
+            t->arena_head = call.arena_end;
+            t->arena_used--;
+        }
+    }
+    t->draining = 0;
+}
+
+static void trampoline_run (void *data,
+                            const struct context_rmcios *context,
+                            int id,
+                            enum function_rmcios function,
+                            enum type_rmcios paramtype,
+                            struct combo_rmcios *returnv,
+                            int num_params, union param_rmcios param)
+{
+    struct trampoline_rmcios *t = (struct trampoline_rmcios *) data;
+
+    if (t->depth >= t->max_depth
+        && call_deferrable (context, id, function, returnv))
+    {
+        if (trampoline_queue (t, context, id, function, paramtype,
+                              returnv, num_params, param))
+        {
+            return;
+        }
+        t->overflows++;
+    }
+
+    t->depth++;
+    t->parent->run_channel (t->parent->data, context, id, function,
+                            paramtype, returnv, num_params, param);
+    t->depth--;
+
+    if (t->depth == 0 && t->draining == 0)
+    {
+        trampoline_drain (t);
+    }
+}
+
+const struct context_rmcios *trampoline_init (struct trampoline_rmcios
+                                              *trampoline,
+                                              const struct context_rmcios
+                                              *parent, int max_depth)
+{
+    copy_context (&trampoline->context, parent);
+    trampoline->context.run_channel = trampoline_run;
+    trampoline->context.data = trampoline;
+    trampoline->parent = parent;
+
+    if (max_depth < 1)
+    {
+        max_depth = 1;
+    }
+    trampoline->max_depth = max_depth;
+    trampoline->depth = 0;
+    trampoline->draining = 0;
+    trampoline->queue_head = 0;
+    trampoline->queue_count = 0;
+    trampoline->arena_head = 0;
+    trampoline->arena_tail = 0;
+    trampoline->arena_used = 0;
+    trampoline->deferred = 0;
+    trampoline->overflows = 0;
+    return &trampoline->context;
+}
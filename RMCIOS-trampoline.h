@@ -0,0 +1,136 @@
+/*
+RMCIOS - Reactive Multipurpose Control Input Output System
+Copyright (c) 2018 Frans Korhonen
+
+RMCIOS was originally developed at Institute for Atmospheric 
+and Earth System Research / Physics, Faculty of Science, 
+University of Helsinki, Finland
+
+Assistance, experience and feedback from following persons have been 
+critical for development of RMCIOS: Erkki Siivola, Juha Kangasluoma, 
+Lauri Ahonen, Ella Häkkinen, Pasi Aalto, Joonas Enroth, Runlong Cai, 
+Markku Kulmala and Tuukka Petäjä.
+
+This file is part of RMCIOS. This notice was encoded using utf-8.
+
+RMCIOS is free software: you can redistribute this file and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RMCIOS is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public Licenses
+along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file RMCIOS-trampoline.h
+ * @author Frans Korhonen
+ * @brief Context wrapper that runs deep channel call chains iteratively.
+ *
+ * Channel calls that do not return data to the caller (no return value or
+ * return to channel) are queued when call nesting reaches the configured
+ * depth. Queued calls are run by the outermost dispatcher one after
+ * another. Stack usage of link chains is then bounded by the depth limit.
+ *
+ * Queued calls are run after the outermost call returns. They run after
+ * all calls that were made directly later in the same outermost call,
+ * such as calls with return value. Calls that are run directly because
+ * the queue is full also run before earlier queued calls. Queued calls
+ * keep their order among themselves.
+ *
+ * Channels must be given the wrapper context (trampoline.context).
+ * Each thread needs its own trampoline.
+ *
+ * Changelog: (date,who,description)
+ *
+ * */
+#ifndef rmcios_trampoline_h
+#define rmcios_trampoline_h
+
+#include "RMCIOS-API.h"
+
+/// Maximum number of queued channel calls
+#ifndef TRAMPOLINE_QUEUE_SIZE
+#define TRAMPOLINE_QUEUE_SIZE 64
+#endif
+
+/// Size of memory for copies of queued call parameters (bytes)
+#ifndef TRAMPOLINE_ARENA_SIZE
+#define TRAMPOLINE_ARENA_SIZE 4096
+#endif
+
+/// @brief Queued channel call
+struct trampoline_call_rmcios
+{
+    /// Context the call was made with
+    const struct context_rmcios *context;
+    int id;
+    enum function_rmcios function;
+    enum type_rmcios paramtype;
+    /// Channel for return data. 0 when return data is not needed.
+    int return_channel;
+    int return_params;
+    int num_params;
+    /// Parameters. Points to copy in trampoline arena.
+    union param_rmcios param;
+    /// Arena offset of the first byte after parameter copy.
+    /// ~0 when parameters did not need copying.
+    unsigned int arena_end;
+};
+
+/// @brief Trampoline dispatcher state.
+struct trampoline_rmcios
+{
+    /// Context to be given to channels.
+    struct context_rmcios context;
+    /// Context the calls are forwarded to.
+    const struct context_rmcios *parent;
+
+    /// Call nesting depth where calls start to be queued
+    int max_depth;
+    /// Current call nesting depth
+    int depth;
+    /// Set while queued calls are run
+    int draining;
+
+    /// Queue of deferred calls
+    struct trampoline_call_rmcios queue[TRAMPOLINE_QUEUE_SIZE];
+    unsigned int queue_head;
+    unsigned int queue_count;
+
+    /// Ring memory for queued parameter copies
+    union
+    {
+        char bytes[TRAMPOLINE_ARENA_SIZE];
+        // Alignment for copied parameter structures
+        void *align_p;
+        double align_d;
+    } arena;
+    unsigned int arena_head;
+    unsigned int arena_tail;
+    /// Number of live parameter copies in the arena
+    unsigned int arena_used;
+
+    /// Number of calls that have been queued
+    unsigned int deferred;
+    /// Number of calls run directly because queue was full
+    unsigned int overflows;
+};
+
+/// @brief Initialize trampoline dispatcher
+///
+/// @param trampoline pointer to trampoline to be initialized
+/// @param parent context the channel calls are forwarded to
+/// @param max_depth nesting depth from where calls are queued.
+/// @return pointer to the wrapper context (trampoline->context)
+const struct context_rmcios *trampoline_init (struct trampoline_rmcios
+                                              *trampoline,
+                                              const struct context_rmcios
+                                              *parent, int max_depth);
+
+#endif
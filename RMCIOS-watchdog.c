@@ -0,0 +1,394 @@
+/*
+RMCIOS - Reactive Multipurpose Control Input Output System
+Copyright (c) 2018 Frans Korhonen
+
+RMCIOS was originally developed at Institute for Atmospheric 
+and Earth System Research / Physics, Faculty of Science, 
+University of Helsinki, Finland
+
+Assistance, experience and feedback from following persons have been 
+critical for development of RMCIOS: Erkki Siivola, Juha Kangasluoma, 
+Lauri Ahonen, Ella Häkkinen, Pasi Aalto, Joonas Enroth, Runlong Cai, 
+Markku Kulmala and Tuukka Petäjä.
+
+This file is part of RMCIOS. This notice was encoded using utf-8.
+
+RMCIOS is free software: you can redistribute this file and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RMCIOS is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public Licenses
+along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "RMCIOS-watchdog.h"
+#include "RMCIOS-functions.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+static const char *function_names[] = {
+    "?", "help", "setup", "write", "read", "create", "link"
+};
+
+static const char *function_name (enum function_rmcios function)
+{
+    if (function < help_rmcios || function > link_rmcios)
+    {
+        return function_names[0];
+    }
+    return function_names[function];
+}
+
+// Function from name. 0 on unknown name.
+static enum function_rmcios function_from_name (const char *name)
+{
+    int function;
+    for (function = help_rmcios; function <= link_rmcios; function++)
+    {
+        if (strcmp (name, function_names[function]) == 0)
+        {
+            return (enum function_rmcios) function;
+        }
+    }
+    return (enum function_rmcios) 0;
+}
+
+static long long monotonic_ns (void)
+{
+    struct timespec now;
+    clock_gettime (CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+// Find or add budget of channel function. 
+// 0 when not found or no free slot within WATCHDOG_PROBES.
+static struct watchdog_budget_rmcios *find_budget (struct watchdog_rmcios
+                                                   *watchdog, int channel,
+                                                   enum function_rmcios
+                                                   function, int add)
+{
+    unsigned int hash = ((unsigned int) channel * 8 + function)
+        * 2654435761u;
+    int i;
+    for (i = 0; i < WATCHDOG_PROBES; i++)
+    {
+        struct watchdog_budget_rmcios *budget =
+            watchdog->budgets + ((hash + i) & (WATCHDOG_SLOTS - 1));
+        if (budget->channel == channel && budget->function == function)
+        {
+            return budget;
+        }
+        if (budget->channel == -1)
+        {
+            if (!add)
+            {
+                return 0;
+            }
+            memset (budget, 0, sizeof (*budget));
+            budget->channel = channel;
+            budget->function = function;
+            budget->budget_ns = WATCHDOG_DEFAULT_BUDGET;
+            return budget;
+        }
+    }
+    return 0;
+}
+
+// Budget of function in nanoseconds. 0 when not measured.
+static long long budget_of (const struct watchdog_rmcios *watchdog,
+                            const struct watchdog_budget_rmcios *budget)
+{
+    return (budget->budget_ns >= 0) ?
+        budget->budget_ns : watchdog->default_budget_ns;
+}
+
+// Write name of channel function. Returns length as snprintf.
+static int frame_name (struct watchdog_rmcios *watchdog,
+                       char *buffer, int size,
+                       int id, enum function_rmcios function)
+{
+    char name[32];
+    struct buffer_rmcios bname = channel_name_borrow (watchdog->parent, id,
+                                                      name, sizeof (name));
+    if (bname.length > 0)
+    {
+        return snprintf (buffer, size, "%.*s.%s", (int) bname.length,
+                         bname.data, function_name (function));
+    }
+    return snprintf (buffer, size, "#%d.%s", id, function_name (function));
+}
+
+// Report violation with the call path to the warning channel
+static void report_violation (struct watchdog_rmcios *watchdog,
+                              int id, enum function_rmcios function,
+                              long long duration_ns, long long budget_ns)
+{
+    char message[256];
+    int length = snprintf (message, sizeof (message), "watchdog: ");
+    int depth = watchdog->depth;
+    int frame;
+
+    if (watchdog->parent->warning == 0)
+    {
+        return;
+    }
+    if (depth > WATCHDOG_MAX_DEPTH)
+    {
+        depth = WATCHDOG_MAX_DEPTH;
+    }
+    for (frame = 0; frame < depth && length < (int) sizeof (message);
+         frame++)
+    {
+        length += frame_name (watchdog, message + length,
+                              sizeof (message) - length,
+                              watchdog->frames[frame].id,
+                              watchdog->frames[frame].function);
+        if (length < (int) sizeof (message))
+        {
+            message[length++] = ';';
+        }
+    }
+    if (length < (int) sizeof (message))
+    {
+        length += frame_name (watchdog, message + length,
+                              sizeof (message) - length, id, function);
+    }
+    if (length < (int) sizeof (message))
+    {
+        length += snprintf (message + length, sizeof (message) - length,
+                            " %lldus > %lldus\r\n", duration_ns / 1000,
+                            budget_ns / 1000);
+    }
+    if (length >= (int) sizeof (message))
+    {
+        length = sizeof (message) - 1;
+    }
+    // Written through parent: warning channel is not measured
+    write_buffer (watchdog->parent, watchdog->parent->warning,
+                  message, length, 0);
+}
+
+int watchdog_set_budget (struct watchdog_rmcios *watchdog, int channel,
+                         enum function_rmcios function, long long budget_ns)
+{
+    struct watchdog_budget_rmcios *budget =
+        find_budget (watchdog, channel, function, 1);
+    if (budget == 0)
+    {
+        return -1;
+    }
+    budget->budget_ns = budget_ns;
+    return 0;
+}
+
+const struct watchdog_budget_rmcios *watchdog_get (struct watchdog_rmcios
+                                                   *watchdog, int channel,
+                                                   enum function_rmcios
+                                                   function)
+{
+    return find_budget (watchdog, channel, function, 0);
+}
+
+void watchdog_clear (struct watchdog_rmcios *watchdog)
+{
+    int i;
+    for (i = 0; i < WATCHDOG_SLOTS; i++)
+    {
+        struct watchdog_budget_rmcios *budget = watchdog->budgets + i;
+        budget->calls = 0;
+        budget->violations = 0;
+        budget->worst_ns = 0;
+        budget->total_ns = 0;
+    }
+    watchdog->overflows = 0;
+}
+
+int watchdog_report (struct watchdog_rmcios *watchdog,
+                     char *buffer, int size)
+{
+    int length = snprintf (buffer, size,
+                           "function calls violations budget_us worst_us"
+                           " average_us\r\n");
+    int i;
+    for (i = 0; i < WATCHDOG_SLOTS && length < size; i++)
+    {
+        const struct watchdog_budget_rmcios *budget = watchdog->budgets + i;
+        long long budget_ns = budget_of (watchdog, budget);
+        if (budget->channel == -1)
+        {
+            continue;
+        }
+        length += frame_name (watchdog, buffer + length, size - length,
+                              budget->channel, budget->function);
+        if (length < size)
+        {
+            length += snprintf (buffer + length, size - length,
+                                " %u %u %lld %lld %lld\r\n",
+                                budget->calls, budget->violations,
+                                budget_ns / 1000, budget->worst_ns / 1000,
+                                budget->calls ?
+                                budget->total_ns / budget->calls / 1000 : 0);
+        }
+    }
+    return (length < size) ? length : size - 1;
+}
+
+// Configuration channel
+static void watchdog_class_func (struct watchdog_rmcios *this,
+                                 const struct context_rmcios *context,
+                                 int id,
+                                 enum function_rmcios function,
+                                 enum type_rmcios paramtype,
+                                 struct combo_rmcios *returnv,
+                                 int num_params,
+                                 const union param_rmcios param)
+{
+    switch (function)
+    {
+    case help_rmcios:
+        return_string (context, returnv,
+                       "watchdog channel - deadline watchdog of channel calls\r\n"
+                       "setup watchdog budget_us #budget of all calls\r\n"
+                       "setup watchdog channel function budget_us"
+                       " #budget of channel function."
+                       " 0 exempts, -1 uses default\r\n"
+                       "read watchdog #budget report\r\n"
+                       "write watchdog #clear statistics\r\n");
+        break;
+
+    case setup_rmcios:
+        if (num_params == 1)
+        {
+            this->default_budget_ns =
+                param_to_int64 (context, paramtype, param, 0) * 1000;
+        }
+        else if (num_params >= 3)
+        {
+            char name[16];
+            int channel = param_to_channel (context, paramtype, param, 0);
+            enum function_rmcios f =
+                function_from_name (param_to_string (context, paramtype,
+                                                     param, 1,
+                                                     sizeof (name), name));
+            long long budget_ns =
+                param_to_int64 (context, paramtype, param, 2) * 1000;
+            if (budget_ns < 0)
+            {
+                budget_ns = WATCHDOG_DEFAULT_BUDGET;
+            }
+            if (f != 0)
+            {
+                watchdog_set_budget (this, channel, f, budget_ns);
+            }
+        }
+        break;
+
+    case write_rmcios:
+        watchdog_clear (this);
+        break;
+
+    case read_rmcios:
+        {
+            char report[WATCHDOG_REPORT_SIZE];
+            int length = watchdog_report (this, report, sizeof (report));
+            return_buffer_chunked (context, returnv, report, length);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+// Measure calls that have budget
+static void watchdog_run (void *data,
+                          const struct context_rmcios *context,
+                          int id,
+                          enum function_rmcios function,
+                          enum type_rmcios paramtype,
+                          struct combo_rmcios *returnv,
+                          int num_params, union param_rmcios param)
+{
+    struct watchdog_rmcios *watchdog = (struct watchdog_rmcios *) data;
+    struct watchdog_budget_rmcios *budget = 0;
+    long long budget_ns = 0;
+    long long start = 0;
+    long long duration;
+
+    if (id != watchdog->id)
+    {
+        budget = find_budget (watchdog, id, function,
+                              watchdog->default_budget_ns != 0);
+        if (budget != 0)
+        {
+            budget_ns = budget_of (watchdog, budget);
+        }
+        else if (watchdog->default_budget_ns != 0)
+        {
+            watchdog->overflows++;
+        }
+    }
+    if (budget_ns != 0)
+    {
+        start = monotonic_ns ();
+    }
+    if (watchdog->depth < WATCHDOG_MAX_DEPTH)
+    {
+        watchdog->frames[watchdog->depth].id = id;
+        watchdog->frames[watchdog->depth].function = function;
+    }
+    watchdog->depth++;
+    watchdog->parent->run_channel (watchdog->parent->data, context, id,
+                                   function, paramtype, returnv,
+                                   num_params, param);
+    watchdog->depth--;
+    if (budget_ns == 0)
+    {
+        return;
+    }
+    duration = monotonic_ns () - start;
+
+    budget->calls++;
+    budget->total_ns += duration;
+    if (duration > budget->worst_ns)
+    {
+        budget->worst_ns = duration;
+    }
+    if (duration > budget_ns)
+    {
+        budget->violations++;
+        report_violation (watchdog, id, function, duration, budget_ns);
+    }
+}
+
+const struct context_rmcios *watchdog_init (struct watchdog_rmcios
+                                            *watchdog,
+                                            const struct context_rmcios
+                                            *parent,
+                                            long long default_budget_ns)
+{
+    int i;
+    watchdog->parent = parent;
+    watchdog->default_budget_ns = default_budget_ns;
+    watchdog->depth = 0;
+    watchdog->overflows = 0;
+    for (i = 0; i < WATCHDOG_SLOTS; i++)
+    {
+        watchdog->budgets[i].channel = -1;
+    }
+    watchdog->id = create_channel_str (parent, "watchdog",
+                                       (class_rmcios) watchdog_class_func,
+                                       watchdog);
+    copy_context (&watchdog->context, parent);
+    watchdog->context.run_channel = watchdog_run;
+    watchdog->context.data = watchdog;
+    return &watchdog->context;
+}
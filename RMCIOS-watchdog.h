@@ -0,0 +1,157 @@
+/*
+RMCIOS - Reactive Multipurpose Control Input Output System
+Copyright (c) 2018 Frans Korhonen
+
+RMCIOS was originally developed at Institute for Atmospheric 
+and Earth System Research / Physics, Faculty of Science, 
+University of Helsinki, Finland
+
+Assistance, experience and feedback from following persons have been 
+critical for development of RMCIOS: Erkki Siivola, Juha Kangasluoma, 
+Lauri Ahonen, Ella Häkkinen, Pasi Aalto, Joonas Enroth, Runlong Cai, 
+Markku Kulmala and Tuukka Petäjä.
+
+This file is part of RMCIOS. This notice was encoded using utf-8.
+
+RMCIOS is free software: you can redistribute this file and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RMCIOS is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public Licenses
+along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file RMCIOS-watchdog.h
+ * @author Frans Korhonen
+ * @brief Deadline watchdog for slow channel calls.
+ *
+ * Context wrapper that measures duration of channel calls that have
+ * a latency budget. Each (channel, function) can have own budget. 
+ * Calls that take longer than their budget are reported to the warning 
+ * channel of the context with the channel call path and the duration:
+ *   watchdog: loop.write;pid.write;sensor.read 12400us > 10000us
+ *
+ * Durations are taken from the monotonic system clock. Channels must 
+ * be given the wrapper context (watchdog.context). Calls through the
+ * wrapper are expected from single thread.
+ *
+ * Watchdog is configured with the watchdog channel:
+ *   setup watchdog budget_us                  # budget of all calls
+ *   setup watchdog channel function budget_us # budget of function
+ *                                             # 0 exempts, -1 default
+ *   read watchdog                             # budget report
+ *   write watchdog                            # clear statistics
+ *
+ * Changelog: (date,who,description)
+ *
+ * */
+#ifndef rmcios_watchdog_h
+#define rmcios_watchdog_h
+
+#include "RMCIOS-API.h"
+
+/// Number of (channel, function) budgets. Power of 2.
+#ifndef WATCHDOG_SLOTS
+#define WATCHDOG_SLOTS 256
+#endif
+
+/// Maximum number of probed slots on lookup
+#ifndef WATCHDOG_PROBES
+#define WATCHDOG_PROBES 8
+#endif
+
+/// Maximum depth of call path in warnings
+#ifndef WATCHDOG_MAX_DEPTH
+#define WATCHDOG_MAX_DEPTH 16
+#endif
+
+/// Budget of function that uses the default budget
+#define WATCHDOG_DEFAULT_BUDGET -1
+
+/// Size of report buffer
+#ifndef WATCHDOG_REPORT_SIZE
+#define WATCHDOG_REPORT_SIZE 8192
+#endif
+
+/// @brief Budget and statistics of channel function
+struct watchdog_budget_rmcios
+{
+    /// Channel id. -1 on unused entry.
+    int channel;
+    enum function_rmcios function;
+    /// Latency budget in nanoseconds. 0 when not measured.
+    /// WATCHDOG_DEFAULT_BUDGET uses the default budget.
+    long long budget_ns;
+    unsigned int calls;
+    unsigned int violations;
+    long long worst_ns;
+    long long total_ns;
+};
+
+/// @brief Channel call in call path
+struct watchdog_frame_rmcios
+{
+    int id;
+    enum function_rmcios function;
+};
+
+/// @brief Deadline watchdog wrapper
+struct watchdog_rmcios
+{
+    /// Wrapper context given to channels
+    struct context_rmcios context;
+    const struct context_rmcios *parent;
+    /// Watchdog configuration channel
+    int id;
+    /// Budget of calls without own budget. 0 for no budget.
+    long long default_budget_ns;
+    int depth;
+    /// Calls without statistics because no free slot was found
+    unsigned int overflows;
+    struct watchdog_frame_rmcios frames[WATCHDOG_MAX_DEPTH];
+    struct watchdog_budget_rmcios budgets[WATCHDOG_SLOTS];
+};
+
+/// @brief Initialize deadline watchdog wrapper
+///
+/// Creates the configuration channel named watchdog.
+/// @param watchdog wrapper to be initialized
+/// @param parent context the channel calls are forwarded to
+/// @param default_budget_ns budget of all calls. 0 for no budget.
+/// @return wrapper context for channels
+const struct context_rmcios *watchdog_init (struct watchdog_rmcios
+                                            *watchdog,
+                                            const struct context_rmcios
+                                            *parent,
+                                            long long default_budget_ns);
+
+/// @brief Set latency budget of channel function
+/// @param budget_ns budget in nanoseconds. 0 exempts the function.
+///        WATCHDOG_DEFAULT_BUDGET uses the default budget.
+/// @return 0 on success. -1 when no free slot was found.
+int watchdog_set_budget (struct watchdog_rmcios *watchdog, int channel,
+                         enum function_rmcios function, long long budget_ns);
+
+/// @brief Get budget statistics of channel function
+/// @return pointer to statistics. 0 when function has no statistics.
+const struct watchdog_budget_rmcios *watchdog_get (struct watchdog_rmcios
+                                                   *watchdog, int channel,
+                                                   enum function_rmcios
+                                                   function);
+
+/// @brief Write budget report to buffer
+/// @return length of written data
+int watchdog_report (struct watchdog_rmcios *watchdog,
+                     char *buffer, int size);
+
+/// @brief Clear call statistics. Budgets are kept.
+void watchdog_clear (struct watchdog_rmcios *watchdog);
+
+#endif
@@ -0,0 +1,411 @@
+/*
+RMCIOS - Reactive Multipurpose Control Input Output System
+Copyright (c) 2018 Frans Korhonen
+
+RMCIOS was originally developed at Institute for Atmospheric 
+and Earth System Research / Physics, Faculty of Science, 
+University of Helsinki, Finland
+
+Assistance, experience and feedback from following persons have been 
+critical for development of RMCIOS: Erkki Siivola, Juha Kangasluoma, 
+Lauri Ahonen, Ella Häkkinen, Pasi Aalto, Joonas Enroth, Runlong Cai, 
+Markku Kulmala and Tuukka Petäjä.
+
+This file is part of RMCIOS. This notice was encoded using utf-8.
+
+RMCIOS is free software: you can redistribute this file and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RMCIOS is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public Licenses
+along with RMCIOS.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file RMCIOS.hpp
+ * @author Frans Korhonen
+ * @brief Header-only C++ interface for channel calls.
+ *
+ * Typed templates build the parameter arrays on stack and select the
+ * parameter type from argument types at compile time:
+ *
+ *   rmcios::write (context, channel, 1.5f, 2.5f);  // float_rmcios array
+ *   rmcios::write (context, channel, 1.5, 2.5);    // double_rmcios array
+ *   rmcios::write (context, channel, 5, "text");   // combo_rmcios
+ *   float value = rmcios::read<float> (context, channel);
+ *   constexpr int f = rmcios::function_enum ("write");
+ *
+ * Requires C++17.
+ *
+ * Changelog: (date,who,description)
+ *
+ * */
+#ifndef rmcios_hpp
+#define rmcios_hpp
+
+extern "C"
+{
+#include "RMCIOS-API.h"
+#include "RMCIOS-functions.h"
+}
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace rmcios
+{
+    // Enumerators buffer_rmcios and combo_rmcios hide the structure names
+    // in C++. Aliases for the structures:
+    using buffer = struct buffer_rmcios;
+    using combo = struct combo_rmcios;
+    using param = union param_rmcios;
+    using context = struct context_rmcios;
+
+    /// @brief Channel handle given as channel_rmcios parameter.
+    struct channel
+    {
+        int id;
+    };
+
+    namespace detail
+    {
+        struct function_name
+        {
+            const char *name;
+            int function;
+        };
+
+        // Same names as in C function_enum
+#define FUNCTION_NAME(name, function) { name, function },
+        constexpr function_name function_names[] = {
+            FUNCTION_NAMES_RMCIOS (FUNCTION_NAME)
+        };
+#undef FUNCTION_NAME
+
+        // Name ends at NULL or space as in C function_enum
+        constexpr bool name_equals (const char *a, const char *b)
+        {
+            while (*a != 0 && *a != ' ' && *a == *b)
+            {
+                a++;
+                b++;
+            }
+            return (*a == 0 || *a == ' ') && *b == 0;
+        }
+    }
+
+    /// @brief Convert function name to function enum at compile time.
+    ///
+    /// Names are the same as in C function_enum.
+    /// @return enum number of the function. 0 on no match.
+    constexpr int function_enum (const char *name)
+    {
+        for (const auto &f : detail::function_names)
+        {
+            if (detail::name_equals (name, f.name))
+            {
+                return f.function;
+            }
+        }
+        return 0;
+    }
+
+    static_assert (function_enum ("write") == write_rmcios
+                   && function_enum ("conf") == setup_rmcios
+                   && function_enum ("writ") == 0,
+                   "function name lookup");
+
+    /// @brief Parameter type for C++ type.
+    template <typename T, typename = void>
+    struct param_type
+    {
+        static constexpr enum type_rmcios value = buffer_rmcios;
+    };
+
+    template <typename T>
+    struct param_type<T, std::enable_if_t<std::is_integral_v<T>>>
+    {
+        static constexpr enum type_rmcios value =
+            (sizeof (T) > sizeof (int)) ? int64_rmcios : int_rmcios;
+    };
+
+    template <typename T>
+    struct param_type<T, std::enable_if_t<std::is_floating_point_v<T>>>
+    {
+        static constexpr enum type_rmcios value =
+            (sizeof (T) > sizeof (float)) ? double_rmcios : float_rmcios;
+    };
+
+    template <>
+    struct param_type<channel>
+    {
+        static constexpr enum type_rmcios value = channel_rmcios;
+    };
+
+    template <typename T>
+    constexpr enum type_rmcios param_type_v =
+        param_type<std::decay_t<T>>::value;
+
+    namespace detail
+    {
+        // Storage of single parameter in combo parameter list
+        struct param_value
+        {
+            enum type_rmcios type;
+            union
+            {
+                int i;
+                float f;
+                long long l;
+                double d;
+                buffer b;
+            };
+
+            param_value (int value) : type (int_rmcios), i (value)
+            {
+            }
+
+            param_value (float value) : type (float_rmcios), f (value)
+            {
+            }
+
+            param_value (long long value) : type (int64_rmcios), l (value)
+            {
+            }
+
+            param_value (double value) : type (double_rmcios), d (value)
+            {
+            }
+
+            param_value (channel value) : type (channel_rmcios), i (value.id)
+            {
+            }
+
+            param_value (std::string_view value)
+                : type (buffer_rmcios), b (make_view (value))
+            {
+            }
+
+            param_value (const char *value)
+                : param_value (value ? std::string_view (value)
+                               : std::string_view ())
+            {
+                // NULL-terminated string has trailing 0
+                b.trailing_size = value ? 1 : 0;
+            }
+
+            param_value (const std::string &value)
+                : param_value (value.c_str ())
+            {
+            }
+
+            template <typename T,
+                      std::enable_if_t<std::is_integral_v<T>, int> = 0>
+            param_value (T value) : type (param_type_v<T>)
+            {
+                if (type == int64_rmcios)
+                    l = static_cast<long long> (value);
+                else
+                    i = static_cast<int> (value);
+            }
+
+            template <typename T,
+                      std::enable_if_t<std::is_floating_point_v<T>, int> = 0>
+            param_value (T value) : param_value (static_cast<double> (value))
+            {
+            }
+
+            static buffer make_view (std::string_view value)
+            {
+                buffer view = { };
+                view.data = const_cast<char *> (value.data ());
+                view.length = static_cast<unsigned int> (value.size ());
+                view.size = 0;
+                view.required_size = view.length;
+                view.trailing_size = 0;
+                return view;
+            }
+
+            combo as_combo ()
+            {
+                combo c = { };
+                c.paramtype = type;
+                c.num_params = 1;
+                c.next = 0;
+                switch (type)
+                {
+                case channel_rmcios:
+                    c.param.channel = i;
+                    break;
+                case buffer_rmcios:
+                    c.param.bv = &b;
+                    break;
+                case int64_rmcios:
+                    c.param.lv = &l;
+                    break;
+                case double_rmcios:
+                    c.param.dv = &d;
+                    break;
+                default:
+                    c.param.p = &i;
+                    break;
+                }
+                return c;
+            }
+        };
+
+        // Parameter type shared by all arguments. combo_rmcios on mixed.
+        template <typename T, typename... Ts>
+        constexpr enum type_rmcios uniform_type_v =
+            ((param_type_v<Ts> == param_type_v<T>) && ...) ?
+            param_type_v<T> : combo_rmcios;
+    }
+
+    /// @brief Run channel function with typed parameters.
+    ///
+    /// Parameters of same numeric type are given as plain array.
+    /// Mixed parameters are given as combo_rmcios list.
+    template <typename... Args>
+    void call (const context *ctx, int id, enum function_rmcios function,
+               combo *returnv, Args &&... args)
+    {
+        constexpr std::size_t n = sizeof...(Args);
+        param p;
+        if constexpr (n == 0)
+        {
+            // Without parameters the type tells the wanted return type
+            enum type_rmcios type = returnv ? returnv->paramtype
+                : buffer_rmcios;
+            if (type == borrowed_rmcios)
+            {
+                // Borrowing return is read as buffer
+                type = buffer_rmcios;
+            }
+            p.p = 0;
+            run_channel (ctx, id, function, type, returnv, 0, p);
+        }
+        else if constexpr (detail::uniform_type_v<Args...> == int_rmcios)
+        {
+            int values[n] = { static_cast<int> (args)... };
+            p.iv = values;
+            run_channel (ctx, id, function, int_rmcios, returnv, n, p);
+        }
+        else if constexpr (detail::uniform_type_v<Args...> == float_rmcios)
+        {
+            float values[n] = { static_cast<float> (args)... };
+            p.fv = values;
+            run_channel (ctx, id, function, float_rmcios, returnv, n, p);
+        }
+        else if constexpr (detail::uniform_type_v<Args...> == int64_rmcios)
+        {
+            long long values[n] = { static_cast<long long> (args)... };
+            p.lv = values;
+            run_channel (ctx, id, function, int64_rmcios, returnv, n, p);
+        }
+        else if constexpr (detail::uniform_type_v<Args...> == double_rmcios)
+        {
+            double values[n] = { static_cast<double> (args)... };
+            p.dv = values;
+            run_channel (ctx, id, function, double_rmcios, returnv, n, p);
+        }
+        else
+        {
+            detail::param_value values[n] = {
+                detail::param_value (args)...
+            };
+            combo combos[n];
+            for (std::size_t i = 0; i < n; i++)
+            {
+                combos[i] = values[i].as_combo ();
+            }
+            p.cv = combos;
+            run_channel (ctx, id, function, combo_rmcios, returnv, n, p);
+        }
+    }
+
+    /// @brief Write typed parameters to channel.
+    template <typename... Args>
+    void write (const context *ctx, int id, Args &&... args)
+    {
+        call (ctx, id, write_rmcios, nullptr, std::forward<Args> (args)...);
+    }
+
+    /// @brief Read value from channel.
+    /// 
+    /// Supported types: integral, floating point and std::string.
+    template <typename T, typename... Args>
+    T read (const context *ctx, int id, Args &&... args)
+    {
+        combo returnv = { };
+        returnv.num_params = 1;
+        if constexpr (std::is_same_v<T, std::string>)
+        {
+            char text[256];
+            buffer breturn = { };
+            breturn.data = text;
+            breturn.size = sizeof (text);
+            // Lending channels return their data without copy:
+            returnv.paramtype = borrowed_rmcios;
+            returnv.param.bv = &breturn;
+            call (ctx, id, read_rmcios, &returnv, args...);
+            if (breturn.data != text
+                || breturn.required_size <= breturn.length)
+            {
+                return std::string (breturn.data, breturn.length);
+            }
+            // Longer copied value is read again to sized string:
+            std::string value (breturn.required_size, '\0');
+            breturn.data = value.data ();
+            breturn.size = breturn.required_size;
+            breturn.length = 0;
+            returnv.paramtype = buffer_rmcios;
+            call (ctx, id, read_rmcios, &returnv, args...);
+            value.resize (breturn.length);
+            return value;
+        }
+        else if constexpr (param_type_v<T> == int64_rmcios)
+        {
+            long long value = 0;
+            returnv.paramtype = int64_rmcios;
+            returnv.param.lv = &value;
+            call (ctx, id, read_rmcios, &returnv, args...);
+            return static_cast<T> (value);
+        }
+        else if constexpr (param_type_v<T> == double_rmcios)
+        {
+            double value = 0;
+            returnv.paramtype = double_rmcios;
+            returnv.param.dv = &value;
+            call (ctx, id, read_rmcios, &returnv, args...);
+            return static_cast<T> (value);
+        }
+        else if constexpr (std::is_integral_v<T>)
+        {
+            int value = 0;
+            returnv.paramtype = int_rmcios;
+            returnv.param.iv = &value;
+            call (ctx, id, read_rmcios, &returnv, args...);
+            return static_cast<T> (value);
+        }
+        else
+        {
+            static_assert (std::is_floating_point_v<T>,
+                           "unsupported read type");
+            float value = 0;
+            returnv.paramtype = float_rmcios;
+            returnv.param.fv = &value;
+            call (ctx, id, read_rmcios, &returnv, args...);
+            return static_cast<T> (value);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,209 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "test.h"
+#include "RMCIOS-API.h"
+#include "RMCIOS-functions.c"
+#define ASYNCLOG_THREADS 2
+#include "RMCIOS-asynclog.c"
+
+#define TEST_FUNC_NAME run_stub
+#define TEST_CALLBACK_NAME run_callback
+#undef TEST_FUNC_RETURN_TYPE
+#define TEST_FUNC_PARAMS PARAM(void *, data) SEP\
+                         PARAM(const struct context_rmcios * ,context) SEP\
+                         PARAM(int, id) SEP \
+                         PARAM(enum function_rmcios, function) SEP \
+                         PARAM(enum type_rmcios, paramtype) SEP \
+                         PARAM(struct combo_rmcios *, returnv) SEP\
+                         PARAM(int, num_params) SEP \
+                         PARAM(union param_rmcios, param)
+#include "test_callback_template.h"
+#include "test_helpers.h"
+
+struct context_rmcios context_mock =
+{
+        .run_channel = run_stub,
+        .id = 55,
+        .name = 56,
+        .mem = 57,
+        .quemem = 58,
+        .errors = 59,
+        .warning = 60,
+        .report = 61,
+        .control = 62,
+        .link = 63,
+        .linked = 64,
+        .create = 65,
+        .convert = 66,
+};
+
+#define SINK 70
+
+static struct asynclog_rmcios alog;
+static char sink_text[ASYNCLOG_LINE_SIZE];
+static int sink_length;
+static int sink_writes;
+
+// Copy message written to sink channel
+static void sink_write (union param_rmcios param)
+{
+    sink_length = param.bv->length;
+    memcpy (sink_text, param.bv->data, sink_length);
+    sink_text[sink_length] = 0;
+    sink_writes++;
+}
+
+static void *writer_thread (void *data)
+{
+    asynclog_write (&alog, "thread", 6);
+    asynclog_release (&alog);
+    return 0;
+}
+
+TEST_RUNNER
+{
+    TEST_SUITE("write")
+    {
+        SUITE_SETUP()
+        TEST_CASE("split", "Text longer than payload is joined by drainer")
+        {
+            char text[200];
+            memset (text, 'a', sizeof (text));
+            text[sizeof (text) - 1] = 'z';
+            sink_writes = 0;
+
+            TEST_CALLBACK(run_callback)
+            {
+                TEST_ASSERT_EQUAL_INT(run_callback.id, SINK);
+                TEST_ASSERT_EQUAL_INT(run_callback.function, write_rmcios);
+                sink_write (run_callback.param);
+                return;
+            }
+            asynclog_init (&alog, &context_mock, SINK);
+            TEST_ASSERT_EQUAL_INT(asynclog_write (&alog, text, sizeof (text)), 0);
+            TEST_ASSERT_EQUAL_INT(asynclog_drain (&alog), 1);
+            TEST_ASSERT_EQUAL_INT(sink_writes, 1);
+            TEST_ASSERT_EQUAL_INT(sink_length, 200);
+            TEST_ASSERT_EQUAL_INT(sink_text[199], 'z');
+        }
+
+        TEST_CASE("truncated", "Text longer than line is marked truncated")
+        {
+            char text[300];
+            memset (text, 'a', sizeof (text));
+            sink_writes = 0;
+
+            TEST_CALLBACK(run_callback)
+            {
+                sink_write (run_callback.param);
+                return;
+            }
+            asynclog_init (&alog, &context_mock, SINK);
+            asynclog_write (&alog, text, sizeof (text));
+            asynclog_drain (&alog);
+            TEST_ASSERT_EQUAL_INT(sink_length, ASYNCLOG_LINE_SIZE - 1);
+            TEST_ASSERT_EQUAL_STR(sink_text + sink_length - 4, "a...");
+        }
+
+        TEST_CASE("flush", "Write without parameters drains without thread")
+        {
+            sink_writes = 0;
+
+            TEST_CALLBACK(run_callback)
+            {
+                sink_write (run_callback.param);
+                return;
+            }
+            asynclog_init (&alog, &context_mock, SINK);
+            asynclog_printf (&alog, "value %d", 42);
+            TEST_ASSERT_EQUAL_INT(sink_writes, 0);
+            asynclog_class_func (&alog, &context_mock, 1000, write_rmcios,
+                                 int_rmcios, 0, 0, (union param_rmcios) 0);
+            TEST_ASSERT_EQUAL_INT(sink_writes, 1);
+            TEST_ASSERT_EQUAL_STR(sink_text, "value 42");
+        }
+
+        TEST_CASE("star", "Width and precision arguments are stored")
+        {
+            sink_writes = 0;
+
+            TEST_CALLBACK(run_callback)
+            {
+                sink_write (run_callback.param);
+                return;
+            }
+            asynclog_init (&alog, &context_mock, SINK);
+            asynclog_printf (&alog, "[%*d|%.*s|%-*.*f]", 5, 42, 3, "abcdef",
+                             7, 2, 1.5);
+            asynclog_drain (&alog);
+            TEST_ASSERT_EQUAL_INT(sink_writes, 1);
+            TEST_ASSERT_EQUAL_STR(sink_text, "[   42|abc|1.50   ]");
+        }
+
+        TEST_CASE("long_double", "L length modifier is rejected")
+        {
+            sink_writes = 0;
+            EXPECT_NO_CHANNEL_CALLS();
+            asynclog_init (&alog, &context_mock, SINK);
+            TEST_ASSERT_EQUAL_INT(asynclog_printf (&alog, "%Lf", 1.5L), -1);
+            asynclog_drain (&alog);
+            TEST_ASSERT_EQUAL_INT(sink_writes, 0);
+        }
+    }
+
+    TEST_SUITE("rings")
+    {
+        SUITE_SETUP()
+        TEST_CASE("release", "Ring of exited thread is freed after drain")
+        {
+            pthread_t thread;
+            sink_writes = 0;
+
+            TEST_CALLBACK(run_callback)
+            {
+                sink_write (run_callback.param);
+                return;
+            }
+            asynclog_init (&alog, &context_mock, SINK);
+            pthread_create (&thread, 0, writer_thread, 0);
+            pthread_join (thread, 0);
+            TEST_ASSERT_EQUAL_INT(alog.rings[0].claimed, ring_released);
+            asynclog_drain (&alog);
+            TEST_ASSERT_EQUAL_INT(sink_writes, 1);
+            TEST_ASSERT_EQUAL_STR(sink_text, "thread");
+            TEST_ASSERT_EQUAL_INT(alog.rings[0].claimed, ring_free);
+        }
+
+        TEST_CASE("no_ring", "Writes of threads without ring are counted")
+        {
+            pthread_t thread;
+            sink_writes = 0;
+
+            TEST_CALLBACK(run_callback)
+            {
+                sink_write (run_callback.param);
+                return;
+            }
+            asynclog_init (&alog, &context_mock, SINK);
+            // Rings claimed by threads that do not release them
+            alog.rings[0].claimed = ring_ready;
+            alog.rings[0].owner = pthread_self ();
+            alog.rings[1].claimed = ring_ready;
+            alog.rings[1].owner = pthread_self ();
+            pthread_create (&thread, 0, writer_thread, 0);
+            pthread_join (thread, 0);
+            TEST_ASSERT_EQUAL_INT(asynclog_drops (&alog), 1);
+            TEST_ASSERT_EQUAL_INT(alog.ring_drops, 1);
+            asynclog_drain (&alog);
+            TEST_ASSERT_EQUAL_STR(sink_text,
+                                  "asynclog: 1 messages dropped (1 without ring)\r\n");
+        }
+    }
+}
+
+int main(void)
+{
+    TEST_RUN(test_data)
+    return TEST_RESULTS(test_data)
+}
@@ -0,0 +1,182 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "test.h"
+#include "RMCIOS-API.h"
+#include "RMCIOS-functions.c"
+#include "RMCIOS-cache.c"
+
+#define TEST_FUNC_NAME run_stub
+#define TEST_CALLBACK_NAME run_callback
+#undef TEST_FUNC_RETURN_TYPE
+#define TEST_FUNC_PARAMS PARAM(void *, data) SEP\
+                         PARAM(const struct context_rmcios * ,context) SEP\
+                         PARAM(int, id) SEP \
+                         PARAM(enum function_rmcios, function) SEP \
+                         PARAM(enum type_rmcios, paramtype) SEP \
+                         PARAM(struct combo_rmcios *, returnv) SEP\
+                         PARAM(int, num_params) SEP \
+                         PARAM(union param_rmcios, param)
+#include "test_callback_template.h"
+
+struct context_rmcios context_mock =
+{
+        .run_channel = run_stub,
+        .id = 55,
+        .name = 56,
+        .mem = 57,
+        .quemem = 58,
+        .errors = 59,
+        .warning = 60,
+        .report = 61,
+        .control = 62,
+        .link = 63,
+        .linked = 64,
+        .create = 65,
+        .convert = 66,
+};
+
+#define TARGET 1000
+#define CLOCK 99
+#define CONVERT 98
+
+static struct cache_rmcios cache;
+static volatile int target_reads;
+static volatile int target_value;
+static long long now;
+
+static int cache_read_int (void);
+
+// Slow target channel, clock and convert channel of the cache context
+static void target_run (void *data, const struct context_rmcios *context,
+                        int id, enum function_rmcios function,
+                        enum type_rmcios paramtype,
+                        struct combo_rmcios *returnv,
+                        int num_params, union param_rmcios param)
+{
+    struct timespec delay = {.tv_sec = 0,.tv_nsec = 20000000 };
+    if (id == CONVERT)
+    {
+        // Returns of int and binary values
+        if (returnv->paramtype == int_rmcios)
+        {
+            *(returnv->param.iv) = param.iv[num_params - 1];
+        }
+        else
+        {
+            const struct buffer_rmcios *b = param.bv + num_params - 1;
+            memcpy (returnv->param.bv->data, b->data, b->length);
+            returnv->param.bv->length = b->length;
+        }
+    }
+    else if (id == CLOCK)
+    {
+        return_binary (context, returnv, (const char *) &now, sizeof (now));
+    }
+    else if (function == read_rmcios)
+    {
+        __sync_fetch_and_add (&target_reads, 1);
+        nanosleep (&delay, 0);
+        return_int (context, returnv, target_value);
+    }
+    else if (function == write_rmcios)
+    {
+        target_value = param.iv[0];
+        // Read through the cache during the write
+        cache_read_int ();
+    }
+}
+
+static struct context_rmcios target_context = {
+    .version = CONTEXT_VERSION_CLOCK_RMCIOS,
+    .run_channel = target_run,
+    .convert = CONVERT,
+};
+
+static int cache_read_int (void)
+{
+    int value = 0;
+    struct combo_rmcios returnv = {
+        .paramtype = int_rmcios,
+        .num_params = 1,
+        .param.iv = &value
+    };
+    cache_class_func (&cache, &target_context, cache.id, read_rmcios,
+                      int_rmcios, &returnv, 0, (union param_rmcios) 0);
+    return value;
+}
+
+static void *reader_thread (void *data)
+{
+    *(int *) data = cache_read_int ();
+    return 0;
+}
+
+TEST_RUNNER
+{
+    TEST_SUITE("cache")
+    {
+        SUITE_SETUP()
+        TEST_CASE("coalesce", "Concurrent readers share one target read")
+        {
+            struct timespec delay = {.tv_sec = 0,.tv_nsec = 5000000 };
+            pthread_t thread;
+            int first = 0;
+            int second;
+
+            target_context.clock = 0;
+            target_reads = 0;
+            target_value = 5;
+            cache_init (&cache, &target_context, TARGET, 1000);
+            pthread_create (&thread, 0, reader_thread, &first);
+            nanosleep (&delay, 0);
+            second = cache_read_int ();
+            pthread_join (thread, 0);
+            TEST_ASSERT_EQUAL_INT(first, 5);
+            TEST_ASSERT_EQUAL_INT(second, 5);
+            TEST_ASSERT_EQUAL_INT(target_reads, 1);
+            TEST_ASSERT_EQUAL_INT(cache.hits, 1);
+        }
+
+        TEST_CASE("ttl", "Entry is read again after time to live")
+        {
+            target_context.clock = CLOCK;
+            now = 0;
+            target_reads = 0;
+            target_value = 1;
+            cache_init (&cache, &target_context, TARGET, 500);
+            TEST_ASSERT_EQUAL_INT(cache_read_int (), 1);
+            target_value = 2;
+            now = 499000000LL;
+            TEST_ASSERT_EQUAL_INT(cache_read_int (), 1);
+            TEST_ASSERT_EQUAL_INT(target_reads, 1);
+            now = 500000000LL;
+            TEST_ASSERT_EQUAL_INT(cache_read_int (), 2);
+            TEST_ASSERT_EQUAL_INT(target_reads, 2);
+        }
+
+        TEST_CASE("invalidate", "Value read during write is not kept")
+        {
+            int value = 3;
+
+            target_context.clock = CLOCK;
+            now = 0;
+            target_reads = 0;
+            target_value = 1;
+            cache_init (&cache, &target_context, TARGET, 1000);
+            TEST_ASSERT_EQUAL_INT(cache_read_int (), 1);
+            cache_class_func (&cache, &target_context, cache.id,
+                              write_rmcios, int_rmcios, 0, 1,
+                              (union param_rmcios) &value);
+            TEST_ASSERT_EQUAL_INT(target_reads, 2);
+            TEST_ASSERT_EQUAL_INT(cache_read_int (), 3);
+            TEST_ASSERT_EQUAL_INT(target_reads, 3);
+        }
+    }
+}
+
+int main(void)
+{
+    TEST_RUN(test_data)
+    return TEST_RESULTS(test_data)
+}
@@ -0,0 +1,181 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "test.h"
+#include "RMCIOS-API.h"
+#include "RMCIOS-functions.c"
+#include "RMCIOS-coalesce.c"
+
+#define TEST_FUNC_NAME run_stub
+#define TEST_CALLBACK_NAME run_callback
+#undef TEST_FUNC_RETURN_TYPE
+#define TEST_FUNC_PARAMS PARAM(void *, data) SEP\
+                         PARAM(const struct context_rmcios * ,context) SEP\
+                         PARAM(int, id) SEP \
+                         PARAM(enum function_rmcios, function) SEP \
+                         PARAM(enum type_rmcios, paramtype) SEP \
+                         PARAM(struct combo_rmcios *, returnv) SEP\
+                         PARAM(int, num_params) SEP \
+                         PARAM(union param_rmcios, param)
+#include "test_callback_template.h"
+
+struct context_rmcios context_mock =
+{
+        .run_channel = run_stub,
+        .id = 55,
+        .name = 56,
+        .mem = 57,
+        .quemem = 58,
+        .errors = 59,
+        .warning = 60,
+        .report = 61,
+        .control = 62,
+        .link = 63,
+        .linked = 64,
+        .create = 65,
+        .convert = 66,
+};
+
+#include <stdlib.h>
+
+#define SINK 800
+#define MEM 801
+
+static struct coalesce_rmcios filter;
+static int sink_writes;
+static int sink_length;
+static int mem_calls;
+
+// Sink and memory channels of the filter context
+static void sink_run (void *data, const struct context_rmcios *context,
+                      int id, enum function_rmcios function,
+                      enum type_rmcios paramtype,
+                      struct combo_rmcios *returnv,
+                      int num_params, union param_rmcios param)
+{
+    if (id == SINK && function == write_rmcios)
+    {
+        sink_writes++;
+        sink_length = param.bv[0].length;
+    }
+    else if (id == MEM && num_params == 1)
+    {
+        void *ptr = malloc (*(int *) param.bv[0].data);
+        memcpy (returnv->param.bv->data, &ptr, sizeof (ptr));
+        returnv->param.bv->length = sizeof (ptr);
+        mem_calls++;
+    }
+    else if (id == MEM && num_params == 2)
+    {
+        free (*(void **) param.bv[1].data);
+        mem_calls++;
+    }
+}
+
+static struct context_rmcios sink_context = {
+    .run_channel = sink_run,
+    .mem = MEM,
+};
+
+// Write text to the filter channel as reported by channel source
+static void report (const char *text, int length, int source)
+{
+    struct buffer_rmcios segments[2] = {
+        {.data = (char *) text,.length = length / 2},
+        {.data = (char *) text + length / 2,.length = length - length / 2}
+    };
+    struct gather_rmcios gather = {.segments = segments,.count = 2 };
+    struct combo_rmcios returnv = {
+        .paramtype = channel_rmcios,
+        .num_params = 1,
+        .param.channel = source
+    };
+    coalesce_class_func (&filter, &sink_context, 0, write_rmcios,
+                         gather_rmcios, &returnv, 1,
+                         (union param_rmcios) &gather);
+}
+
+TEST_RUNNER
+{
+    TEST_SUITE("coalesce")
+    {
+        TEST_CASE("numbers", "Messages differing by numbers are coalesced")
+        {
+            coalesce_init (&filter, &sink_context, SINK, 10000);
+            TEST_ASSERT_EQUAL_INT(1, coalesce_write (&filter, 0, 0,
+                                                     "value 12.5 high", 15));
+            TEST_ASSERT_EQUAL_INT(0, coalesce_write (&filter, 0, 0,
+                                                     "value 13 high", 13));
+            TEST_ASSERT_EQUAL_INT(1, coalesce_write (&filter, 0, 0,
+                                                     "value 13 low", 12));
+            TEST_ASSERT_EQUAL_INT(2, sink_writes);
+        }
+
+        TEST_CASE("collision", "Templates with equal hash are kept apart")
+        {
+            // Both texts hash to 0x36c350d9
+            coalesce_init (&filter, &sink_context, SINK, 10000);
+            TEST_ASSERT_EQUAL_INT(1, coalesce_write (&filter, 0, 0,
+                                                     "warn hpkfwnxj", 13));
+            TEST_ASSERT_EQUAL_INT(1, coalesce_write (&filter, 0, 0,
+                                                     "warn aknexdaf", 13));
+            TEST_ASSERT_EQUAL_INT(0, coalesce_write (&filter, 0, 0,
+                                                     "warn hpkfwnxj", 13));
+            TEST_ASSERT_EQUAL_INT(0, coalesce_write (&filter, 0, 0,
+                                                     "warn aknexdaf", 13));
+            TEST_ASSERT_EQUAL_INT(2, filter.suppressed);
+        }
+
+        TEST_CASE("long", "Long message is passed through whole")
+        {
+            char text[150];
+            memset (text, 'x', sizeof (text));
+            coalesce_init (&filter, &sink_context, SINK, 10000);
+            sink_writes = 0;
+            report (text, sizeof (text), 0);
+            TEST_ASSERT_EQUAL_INT(1, sink_writes);
+            TEST_ASSERT_EQUAL_INT(sizeof (text), sink_length);
+            TEST_ASSERT_EQUAL_INT(0, mem_calls);
+
+            // Repeat is matched on the stored part of the message
+            report (text, sizeof (text), 0);
+            TEST_ASSERT_EQUAL_INT(1, sink_writes);
+        }
+
+        TEST_CASE("long_buffer", "Buffer message is passed without copy")
+        {
+            static char text[COALESCE_LINE_SIZE * 2];
+            struct buffer_rmcios message = {
+                .data = text,
+                .length = sizeof (text),
+                .required_size = sizeof (text)
+            };
+            memset (text, 'y', sizeof (text));
+            coalesce_init (&filter, &sink_context, SINK, 10000);
+            sink_writes = 0;
+            coalesce_class_func (&filter, &sink_context, 0, write_rmcios,
+                                 buffer_rmcios, 0, 1,
+                                 (union param_rmcios) &message);
+            TEST_ASSERT_EQUAL_INT(1, sink_writes);
+            TEST_ASSERT_EQUAL_INT(sizeof (text), sink_length);
+            TEST_ASSERT_EQUAL_INT(0, mem_calls);
+        }
+
+        TEST_CASE("source", "Source is taken from the return channel")
+        {
+            coalesce_init (&filter, &sink_context, SINK, 10000);
+            sink_writes = 0;
+            report ("sensor failed", 13, 7);
+            report ("sensor failed", 13, 8);
+            report ("sensor failed", 13, 7);
+            TEST_ASSERT_EQUAL_INT(2, sink_writes);
+            TEST_ASSERT_EQUAL_INT(1, filter.suppressed);
+        }
+    }
+}
+
+int main(void)
+{
+    TEST_RUN(test_data)
+    return TEST_RESULTS(test_data)
+}
@@ -0,0 +1,191 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "test.h"
+#include "RMCIOS-API.h"
+#include "RMCIOS-functions.c"
+#include "RMCIOS-completion.c"
+
+#define TEST_FUNC_NAME run_stub
+#define TEST_CALLBACK_NAME run_callback
+#undef TEST_FUNC_RETURN_TYPE
+#define TEST_FUNC_PARAMS PARAM(void *, data) SEP\
+                         PARAM(const struct context_rmcios * ,context) SEP\
+                         PARAM(int, id) SEP \
+                         PARAM(enum function_rmcios, function) SEP \
+                         PARAM(enum type_rmcios, paramtype) SEP \
+                         PARAM(struct combo_rmcios *, returnv) SEP\
+                         PARAM(int, num_params) SEP \
+                         PARAM(union param_rmcios, param)
+#include "test_callback_template.h"
+
+struct context_rmcios context_mock =
+{
+        .run_channel = run_stub,
+        .id = 55,
+        .name = 56,
+        .mem = 57,
+        .quemem = 58,
+        .errors = 59,
+        .warning = 60,
+        .report = 61,
+        .control = 62,
+        .link = 63,
+        .linked = 64,
+        .create = 65,
+        .convert = 66,
+};
+
+#define DEVICE 900
+#define CREATE 901
+#define CONVERT 902
+#define FIRST_SLOT 1000
+
+static class_rmcios slot_funcs[COMPLETION_SLOTS];
+static void *slot_data[COMPLETION_SLOTS];
+static int num_created;
+static int deferred;
+static struct completion_queue_rmcios queue;
+static int callbacks;
+static float callback_value;
+
+// Creates slot channels, converts values and defers reads of the device
+static void device_run (void *data, const struct context_rmcios *context,
+                        int id, enum function_rmcios function,
+                        enum type_rmcios paramtype,
+                        struct combo_rmcios *returnv,
+                        int num_params, union param_rmcios param)
+{
+    if (id == CONVERT)
+    {
+        // Returns of int and float values
+        if (returnv->paramtype == int_rmcios)
+        {
+            *(returnv->param.iv) = param.iv[num_params - 1];
+        }
+        else
+        {
+            *(returnv->param.fv) = param.fv[num_params - 1];
+        }
+    }
+    else if (id == CREATE)
+    {
+        slot_funcs[num_created] = *(class_rmcios *) param.bv[0].data;
+        slot_data[num_created] = *(void **) param.bv[1].data;
+        *(returnv->param.iv) = FIRST_SLOT + num_created++;
+    }
+    else if (id == DEVICE && function == read_rmcios)
+    {
+        deferred = defer_return (returnv);
+    }
+    else if (id >= FIRST_SLOT && id < FIRST_SLOT + num_created)
+    {
+        slot_funcs[id - FIRST_SLOT] (slot_data[id - FIRST_SLOT], context,
+                                     id, function, paramtype, returnv,
+                                     num_params, param);
+    }
+}
+
+static void on_complete (void *user_data,
+                         const struct completion_rmcios *result)
+{
+    callbacks++;
+    callback_value = result->fvalue;
+}
+
+static struct context_rmcios device_context = {
+    .run_channel = device_run,
+    .create = CREATE,
+    .convert = CONVERT,
+};
+
+TEST_RUNNER
+{
+    TEST_SUITE("completion")
+    {
+        struct completion_rmcios result;
+        int tag;
+
+        TEST_CASE("init", "Slot channels are created")
+        {
+            TEST_ASSERT_EQUAL_INT(COMPLETION_SLOTS,
+                                  completion_queue_init (&queue,
+                                                         &device_context));
+        }
+
+        TEST_CASE("poll", "Deferred result is polled once")
+        {
+            tag = completion_read_i (&queue, DEVICE, 0, 0);
+            TEST_ASSERT_EQUAL_INT(1, tag >= 0);
+            TEST_ASSERT_EQUAL_INT(FIRST_SLOT + tag % COMPLETION_SLOTS,
+                                  deferred);
+            TEST_ASSERT_EQUAL_INT(1, completion_pending (&queue));
+            TEST_ASSERT_EQUAL_INT(-1, completion_poll (&queue, &result));
+
+            write_i (&device_context, deferred, 42);
+            // Duplicate completion is ignored:
+            write_i (&device_context, deferred, 43);
+            TEST_ASSERT_EQUAL_INT(0, completion_pending (&queue));
+            TEST_ASSERT_EQUAL_INT(tag, completion_poll (&queue, &result));
+            TEST_ASSERT_EQUAL_INT(42, result.ivalue);
+            TEST_ASSERT_EQUAL_INT(DEVICE, result.channel);
+            TEST_ASSERT_EQUAL_INT(-1, completion_poll (&queue, &result));
+        }
+
+        TEST_CASE("callback", "Result is delivered to callback")
+        {
+            tag = completion_read_f (&queue, DEVICE, on_complete, 0);
+            write_f (&device_context, deferred, 2.5f);
+            TEST_ASSERT_EQUAL_INT(1, callbacks);
+            TEST_ASSERT_EQUAL_INT(1, callback_value == 2.5f);
+            TEST_ASSERT_EQUAL_INT(-1, completion_poll (&queue, &result));
+            TEST_ASSERT_EQUAL_INT(0, completion_pending (&queue));
+        }
+
+        TEST_CASE("cancel", "Late result of cancelled read is discarded")
+        {
+            int cancelled_slot;
+            int next;
+
+            tag = completion_read_i (&queue, DEVICE, 0, 0);
+            cancelled_slot = deferred;
+            TEST_ASSERT_EQUAL_INT(0, completion_cancel (&queue, tag));
+            TEST_ASSERT_EQUAL_INT(0, completion_pending (&queue));
+            TEST_ASSERT_EQUAL_INT(-1, completion_cancel (&queue, tag));
+
+            // Cancelled slot is not reused before the late result:
+            next = completion_read_i (&queue, DEVICE, 0, 0);
+            TEST_ASSERT_EQUAL_INT(1, next != tag);
+            write_i (&device_context, cancelled_slot, 7);
+            TEST_ASSERT_EQUAL_INT(-1, completion_poll (&queue, &result));
+            TEST_ASSERT_EQUAL_INT(1, completion_pending (&queue));
+
+            write_i (&device_context, deferred, 8);
+            TEST_ASSERT_EQUAL_INT(next, completion_poll (&queue, &result));
+            TEST_ASSERT_EQUAL_INT(8, result.ivalue);
+
+            // Slot is free again after the late result:
+            next = completion_read_i (&queue, DEVICE, 0, 0);
+            TEST_ASSERT_EQUAL_INT(cancelled_slot, deferred);
+            // Tag of the earlier read does not match the new read
+            TEST_ASSERT_EQUAL_INT(1, next != tag);
+            TEST_ASSERT_EQUAL_INT(-1, completion_cancel (&queue, tag));
+            TEST_ASSERT_EQUAL_INT(1, completion_pending (&queue));
+            TEST_ASSERT_EQUAL_INT(0, completion_cancel (&queue, next));
+        }
+
+        TEST_CASE("cancel_done", "Completed result can be discarded")
+        {
+            tag = completion_read_i (&queue, DEVICE, 0, 0);
+            write_i (&device_context, deferred, 1);
+            TEST_ASSERT_EQUAL_INT(0, completion_cancel (&queue, tag));
+            TEST_ASSERT_EQUAL_INT(-1, completion_poll (&queue, &result));
+        }
+    }
+}
+
+int main(void)
+{
+    TEST_RUN(test_data)
+    return TEST_RESULTS(test_data)
+}
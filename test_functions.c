@@ -17,6 +17,7 @@
                          PARAM(int, num_params) SEP \
                          PARAM(union param_rmcios, param)
 #include "test_callback_template.h"
+#include "test_helpers.h"
 
 struct context_rmcios context_mock =
 {
@@ -345,7 +346,10 @@ TEST_RUNNER
                         TEST_ASSERT_EQUAL_INT(run_callback.num_params, 1);
                         TEST_ASSERT_EQUAL_INT(run_callback.param.iv[0], base_channel_id);
  
-                        TEST_ASSERT_EQUAL_INT(run_callback.returnv->paramtype, buffer_rmcios);
+                        // Length is read borrowing the name
+                        TEST_ASSERT_EQUAL_INT(run_callback.returnv->paramtype,
+                                              run_callback.test_call_index == 0 ?
+                                              borrowed_rmcios : buffer_rmcios);
                         TEST_ASSERT_EQUAL_INT(run_callback.returnv->num_params, 1);
 
                         if (run_callback.test_call_index == 0) {
@@ -693,6 +697,624 @@ TEST_RUNNER
             size = param_buffer_alloc_size (&context_mock, int_rmcios,(const union param_rmcios)&value, 0);
             TEST_ASSERT_EQUAL_INT(size, 2)       
         }
+    }
+    TEST_SUITE("param_to_function")
+    {
+        SUITE_SETUP()
+        TEST_CASE("name", "Function name given as text")
+        {
+            static struct buffer_rmcios name = {
+                .data = "read",
+                .length = 4,
+                .size = 0,
+                .required_size = 4,
+                .trailing_size = 1
+            };
+
+            TEST_CALLBACK(run_callback)
+            {
+                switch (run_callback.test_call_index)
+                {
+                    case 0:
+                        // from: param_to_integer() - text is not a number
+                        TEST_ASSERT_EQUAL_INT(run_callback.id, context_mock.convert);
+                        TEST_ASSERT_EQUAL_INT(run_callback.function, read_rmcios);
+                        TEST_ASSERT_EQUAL_INT(run_callback.returnv->paramtype, int_rmcios);
+                        *(run_callback.returnv->param.iv) = 0;
+                        break;
+
+                    case 1:
+                        // from: param_to_buffer() - copy to fixed size buffer
+                        TEST_ASSERT_EQUAL_INT(run_callback.id, context_mock.convert);
+                        TEST_ASSERT_EQUAL_INT(run_callback.function, write_rmcios);
+                        TEST_ASSERT_EQUAL_INT(run_callback.paramtype, buffer_rmcios);
+                        TEST_ASSERT_EQUAL_INT(run_callback.num_params, 1);
+                        TEST_ASSERT_EQUAL_INT(run_callback.returnv->param.bv[0].size, FUNCTION_NAME_MAX);
+                        break;
+
+                    case 2:
+                        // from: param_to_buffer() - fetch original buffer
+                        TEST_ASSERT_EQUAL_INT(run_callback.id, context_mock.convert);
+                        TEST_ASSERT_EQUAL_INT(run_callback.function, read_rmcios);
+                        run_callback.returnv->param.bv[0] = run_callback.param.bv[0];
+                        break;
+                }
+                return;
+            }
+            int function = param_to_function (&context_mock, buffer_rmcios, (union param_rmcios)&name, 0);
+            TEST_ASSERT_EQUAL_INT(function, read_rmcios);
+        }
+    }
+    TEST_SUITE("conversion_plan")
+    {
+        SUITE_SETUP()
+        TEST_CASE("composite_uses_channel", "Composite sources report channel use of elements")
+        {
+            EXPECT_NO_CHANNEL_CALLS()
+            // Text elements are parsed by the convert channel
+            TEST_ASSERT_EQUAL_INT(conversion_plan (combo_rmcios, int_rmcios).uses_channel, 1);
+            TEST_ASSERT_EQUAL_INT(conversion_plan (inline_rmcios, int_rmcios).uses_channel, 1);
+            TEST_ASSERT_EQUAL_INT(conversion_plan (gather_rmcios, int_rmcios).uses_channel, 1);
+            // Numeric elements convert locally
+            TEST_ASSERT_EQUAL_INT(conversion_plan (array_rmcios, float_rmcios).uses_channel, 0);
+            TEST_ASSERT_EQUAL_INT(conversion_plan (inline_rmcios, buffer_rmcios).uses_channel, 0);
+        }
+
+        TEST_CASE("int_to_float", "Specialized plan runs without convert channel")
+        {
+            int values[2] = { 3, 7 };
+            float result = 0;
+            struct combo_rmcios returnv = {
+                .paramtype = float_rmcios,
+                .num_params = 1,
+                .param.fv = &result
+            };
+
+            EXPECT_NO_CHANNEL_CALLS()
+            struct conversion_plan_rmcios plan = conversion_plan (int_rmcios, float_rmcios);
+            TEST_ASSERT_EQUAL_INT(plan.uses_channel, 0);
+            plan.convert (&context_mock, (union param_rmcios) values, 1, &returnv);
+            TEST_ASSERT_EQUAL_INT((int) result, 7);
+        }
+
+        TEST_CASE("channel", "Unspecialized plan uses convert channel")
+        {
+            struct buffer_rmcios text = {
+                .data = "12",
+                .length = 2,
+                .size = 0,
+                .required_size = 2,
+                .trailing_size = 1
+            };
+            int result = 0;
+            struct combo_rmcios returnv = {
+                .paramtype = int_rmcios,
+                .num_params = 1,
+                .param.iv = &result
+            };
+
+            TEST_CALLBACK(run_callback)
+            {
+                TEST_ASSERT_EQUAL_INT(run_callback.id, context_mock.convert);
+                TEST_ASSERT_EQUAL_INT(run_callback.function, read_rmcios);
+                TEST_ASSERT_EQUAL_INT(run_callback.paramtype, buffer_rmcios);
+                TEST_ASSERT_EQUAL_INT(run_callback.num_params, 1);
+                *(run_callback.returnv->param.iv) = 12;
+                return;
+            }
+            struct conversion_plan_rmcios plan = conversion_plan (buffer_rmcios, int_rmcios);
+            TEST_ASSERT_EQUAL_INT(plan.uses_channel, 1);
+            plan.convert (&context_mock, (union param_rmcios) &text, 0, &returnv);
+            TEST_ASSERT_EQUAL_INT(result, 12);
+        }
+
+        TEST_CASE("int64_to_double", "64-bit values convert without convert channel")
+        {
+            long long values[1] = { 9007199254740993LL };
+            double result = 0;
+            struct combo_rmcios returnv = {
+                .paramtype = double_rmcios,
+                .num_params = 1,
+                .param.dv = &result
+            };
+
+            EXPECT_NO_CHANNEL_CALLS()
+            struct conversion_plan_rmcios plan = conversion_plan (int64_rmcios, double_rmcios);
+            TEST_ASSERT_EQUAL_INT(plan.uses_channel, 0);
+            plan.convert (&context_mock, (union param_rmcios) values, 0, &returnv);
+            // 2^53 + 1 rounds to nearest double 2^53
+            TEST_ASSERT_EQUAL_INT(1, result == 9007199254740992.0);
+        }
+
+        TEST_CASE("buffer_copy", "Buffer copy is terminated when there is room")
+        {
+            char text[] = "abc";
+            struct buffer_rmcios src = {
+                .data = text,
+                .length = 3,
+                .size = 0,
+                .required_size = 3,
+                .trailing_size = 0
+            };
+            char copy[4] = "xxxx";
+            struct buffer_rmcios dst = {
+                .data = copy,
+                .length = 0,
+                .size = sizeof (copy),
+                .required_size = 0,
+                .trailing_size = 0
+            };
+            struct combo_rmcios returnv = {
+                .paramtype = buffer_rmcios,
+                .num_params = 1,
+                .param.bv = &dst
+            };
+            struct conversion_plan_rmcios plan = conversion_plan (buffer_rmcios, buffer_rmcios);
+            plan.convert (&context_mock, (union param_rmcios) &src, 0, &returnv);
+            TEST_ASSERT_EQUAL_INT(dst.length, 3);
+            TEST_ASSERT_EQUAL_INT(dst.trailing_size, 1);
+            TEST_ASSERT_EQUAL_STR(copy, "abc");
+
+            // No room for the terminator:
+            dst.size = 3;
+            copy[3] = 'x';
+            plan.convert (&context_mock, (union param_rmcios) &src, 0, &returnv);
+            TEST_ASSERT_EQUAL_INT(dst.trailing_size, 0);
+            TEST_ASSERT_EQUAL_INT(copy[3], 'x');
+        }
+    }
+
+    TEST_SUITE("wide_numeric")
+    {
+        SUITE_SETUP()
+        TEST_CASE("return_double", "Double is returned into int without convert channel")
+        {
+            int result = 0;
+            struct combo_rmcios returnv = {
+                .paramtype = int_rmcios,
+                .num_params = 1,
+                .param.iv = &result
+            };
+
+            EXPECT_NO_CHANNEL_CALLS()
+            return_double (&context_mock, &returnv, 42.75);
+            TEST_ASSERT_EQUAL_INT(result, 42);
+        }
+
+        TEST_CASE("return_int64", "64-bit integer is formatted into buffer")
+        {
+            char text[24];
+            struct buffer_rmcios breturn = {
+                .data = text,
+                .length = 0,
+                .size = sizeof (text),
+                .required_size = 0,
+                .trailing_size = 0
+            };
+            struct combo_rmcios returnv = {
+                .paramtype = buffer_rmcios,
+                .num_params = 1,
+                .param.bv = &breturn
+            };
+
+            EXPECT_NO_CHANNEL_CALLS()
+            return_int64 (&context_mock, &returnv, -9007199254740993LL);
+            TEST_ASSERT_EQUAL_STR(text, "-9007199254740993");
+            TEST_ASSERT_EQUAL_INT(breturn.length, 17);
+            TEST_ASSERT_EQUAL_INT(breturn.trailing_size, 1);
+        }
+
+        TEST_CASE("return_double_text", "Double is formatted into buffer")
+        {
+            char text[32];
+            struct buffer_rmcios breturn = {
+                .data = text,
+                .length = 0,
+                .size = sizeof (text),
+                .required_size = 0,
+                .trailing_size = 0
+            };
+            struct combo_rmcios returnv = {
+                .paramtype = buffer_rmcios,
+                .num_params = 1,
+                .param.bv = &breturn
+            };
+
+            EXPECT_NO_CHANNEL_CALLS()
+            return_double (&context_mock, &returnv, 0.25);
+            TEST_ASSERT_EQUAL_STR(text, "0.25");
+            return_double (&context_mock, &returnv, 500);
+            TEST_ASSERT_EQUAL_STR(text, "500");
+        }
+
+        TEST_CASE("param_text", "Text is parsed into 64-bit integer and double")
+        {
+            struct buffer_rmcios params[2] = {
+                {.data = "500", .length = 3, .required_size = 3},
+                {.data = " -0.5e1", .length = 7, .required_size = 7}
+            };
+
+            EXPECT_NO_CHANNEL_CALLS()
+            TEST_ASSERT_EQUAL_INT((int) param_to_int64 (&context_mock, buffer_rmcios,
+                                      (union param_rmcios) params, 0), 500);
+            TEST_ASSERT_EQUAL_INT(param_to_double (&context_mock, buffer_rmcios,
+                                      (union param_rmcios) params, 1) == -5.0, 1);
+        }
+    }
+
+    TEST_SUITE("array_view")
+    {
+        SUITE_SETUP()
+        TEST_CASE("column", "Column of interleaved frame converts without copy")
+        {
+            float frame[6] = { 1, 10, 2, 20, 3, 30 };
+            int column[3] = { 0 };
+            struct array_rmcios src = make_array (float_rmcios, frame + 1, 3,
+                                                  2 * sizeof (float));
+            struct array_rmcios dst = make_array (int_rmcios, column, 3, 0);
+
+            EXPECT_NO_CHANNEL_CALLS()
+            TEST_ASSERT_EQUAL_INT(convert_array (&context_mock, &src, &dst), 3);
+            TEST_ASSERT_EQUAL_INT(column[0], 10);
+            TEST_ASSERT_EQUAL_INT(column[2], 30);
+        }
+    }
+
+    TEST_SUITE("combo_param")
+    {
+        SUITE_SETUP()
+        TEST_CASE("array_element", "Array element inside combo is resolved")
+        {
+            int values[3] = { 4, 5, 6 };
+            struct inline_rmcios name = {.length = 4, .data = "unit"};
+            struct array_rmcios array = make_array (int_rmcios, values, 3, 0);
+            struct combo_rmcios combo[2] = {
+                {.paramtype = inline_rmcios, .num_params = 1, .param.inv = &name},
+                {.paramtype = array_rmcios, .num_params = 3, .param.av = &array}
+            };
+            float result;
+
+            TEST_CALLBACK(run_callback)
+            {
+                // Element is converted as plain int
+                TEST_ASSERT_EQUAL_INT(run_callback.id, context_mock.convert);
+                TEST_ASSERT_EQUAL_INT(run_callback.paramtype, int_rmcios);
+                TEST_ASSERT_EQUAL_INT(run_callback.num_params, 1);
+                *(run_callback.returnv->param.fv) = run_callback.param.iv[0];
+                return;
+            }
+            result = param_to_float (&context_mock, combo_rmcios,
+                                     (union param_rmcios) combo, 3);
+            TEST_ASSERT_EQUAL_INT((int) result, 6);
+            TEST_ASSERT_EQUAL_INT(param_buffer_length (&context_mock, combo_rmcios,
+                                      (union param_rmcios) combo, 0), 4);
+            TEST_ASSERT_EQUAL_STR(param_to_string (&context_mock, combo_rmcios,
+                                      (union param_rmcios) combo, 0, 0, 0), "unit");
+        }
+    }
+
+    TEST_SUITE("buffer_ownership")
+    {
+        SUITE_SETUP()
+        TEST_CASE("take_buffer", "Data is taken only from owned buffers")
+        {
+            char data[4] = "abc";
+            struct buffer_rmcios owned = {
+                .data = data,
+                .length = 3,
+                .size = 4,
+                .required_size = 3,
+                .trailing_size = 0,
+                .flags = buffer_owned_rmcios
+            };
+            struct buffer_rmcios copy = owned;
+            struct buffer_rmcios borrowed = owned;
+            borrowed.flags = 0;
+
+            // Flag is ignored on other than moved parameters
+            TEST_ASSERT_EQUAL_INT(take_buffer (binary_rmcios,
+                                      (union param_rmcios) &copy, 0) == 0, 1);
+            TEST_ASSERT_EQUAL_INT(take_buffer (moved_rmcios,
+                                      (union param_rmcios) &owned, 0) == data, 1);
+            TEST_ASSERT_EQUAL_INT(owned.flags & buffer_owned_rmcios, 0);
+            TEST_ASSERT_EQUAL_INT(take_buffer (moved_rmcios,
+                                      (union param_rmcios) &owned, 0) == 0, 1);
+            TEST_ASSERT_EQUAL_INT(take_buffer (moved_rmcios,
+                                      (union param_rmcios) &borrowed, 0) == 0, 1);
+        }
+
+        TEST_CASE("lend_buffer", "Borrowing return buffer refers to lent data")
+        {
+            static const char data[] = "lent";
+            struct buffer_rmcios breturn = {
+                .data = 0,
+                .length = 0,
+                .size = 0,
+                .required_size = 0,
+                .trailing_size = 0
+            };
+            struct combo_rmcios returnv = {
+                .paramtype = borrowed_rmcios,
+                .num_params = 1,
+                .param.bv = &breturn
+            };
+
+            EXPECT_NO_CHANNEL_CALLS()
+            lend_buffer (&context_mock, &returnv, data, 4);
+            TEST_ASSERT_EQUAL_INT(breturn.data == data, 1);
+            TEST_ASSERT_EQUAL_INT(breturn.length, 4);
+        }
+
+        TEST_CASE("lend_to_buffer", "Data is copied to buffer return")
+        {
+            static const char data[] = "lent";
+            char copy[8];
+            struct buffer_rmcios breturn = {
+                .data = copy,
+                .length = 0,
+                .size = sizeof (copy),
+                .required_size = 0,
+                .trailing_size = 0,
+                // Flags of old callers are not a request to borrow
+                .flags = 0xffff
+            };
+            struct combo_rmcios returnv = {
+                .paramtype = buffer_rmcios,
+                .num_params = 1,
+                .param.bv = &breturn
+            };
+
+            TEST_CALLBACK(run_callback)
+            {
+                TEST_ASSERT_EQUAL_INT(run_callback.id, context_mock.convert);
+                TEST_ASSERT_EQUAL_INT(run_callback.returnv->paramtype,
+                                      buffer_rmcios);
+                return;
+            }
+            lend_buffer (&context_mock, &returnv, data, 4);
+            TEST_ASSERT_EQUAL_INT(breturn.data == copy, 1);
+        }
+
+        TEST_CASE("name_copy", "Copied channel name is NULL-terminated")
+        {
+            char name[8] = "xxxxxxx";
+            struct buffer_rmcios b;
+
+            TEST_CALLBACK(run_callback)
+            {
+                // Name channel copies without lending
+                TEST_ASSERT_EQUAL_INT(run_callback.id, context_mock.name);
+                TEST_ASSERT_EQUAL_INT(run_callback.returnv->param.bv->size, 7);
+                memcpy (run_callback.returnv->param.bv->data, "abc", 3);
+                run_callback.returnv->param.bv->length = 3;
+                run_callback.returnv->param.bv->required_size = 3;
+                return;
+            }
+            b = channel_name_borrow (&context_mock, 3, name, sizeof (name));
+            TEST_ASSERT_EQUAL_INT(b.length, 3);
+            TEST_ASSERT_EQUAL_INT(b.trailing_size, 1);
+            TEST_ASSERT_EQUAL_STR(b.data, "abc");
+        }
+    }
+
+    TEST_SUITE("buffer_move")
+    {
+        SUITE_SETUP()
+        TEST_CASE("convert", "Moved buffer converts as binary")
+        {
+            char data[4] = "abc";
+            struct buffer_rmcios moved = {
+                .data = data,
+                .length = 3,
+                .size = 4,
+                .required_size = 3,
+                .trailing_size = 0,
+                .flags = buffer_owned_rmcios
+            };
+
+            TEST_CALLBACK(run_callback)
+            {
+                // Receivers that do not take the data see binary
+                TEST_ASSERT_EQUAL_INT(run_callback.id, context_mock.convert);
+                TEST_ASSERT_EQUAL_INT(run_callback.paramtype, binary_rmcios);
+                TEST_ASSERT_EQUAL_INT(run_callback.param.bv->length, 3);
+                return;
+            }
+            TEST_ASSERT_EQUAL_INT(param_binary_length (&context_mock, moved_rmcios,
+                                      (union param_rmcios) &moved, 0), 0);
+            TEST_ASSERT_EQUAL_INT(conversion_plan (moved_rmcios, buffer_rmcios).from,
+                                  binary_rmcios);
+        }
+    }
+
+    TEST_SUITE("context_clock")
+    {
+        SUITE_SETUP()
+        TEST_CASE("version", "Clock is read only from new enough contexts")
+        {
+            struct context_rmcios context = context_mock;
+            context.clock = 67;
+
+            TEST_CALLBACK(run_callback)
+            {
+                long long time = 1234567890123LL;
+                TEST_ASSERT_EQUAL_INT(run_callback.id, 67);
+                TEST_ASSERT_EQUAL_INT(run_callback.function, read_rmcios);
+                memcpy (run_callback.returnv->param.bv->data, &time,
+                        sizeof (time));
+                run_callback.returnv->param.bv->length = sizeof (time);
+                return;
+            }
+            context.version = CONTEXT_VERSION_CLOCK_RMCIOS - 1;
+            TEST_ASSERT_EQUAL_INT(context_clock (&context), 0);
+            TEST_ASSERT_EQUAL_INT(read_time (&context) == 0, 1);
+            context.version = CONTEXT_VERSION_CLOCK_RMCIOS;
+            TEST_ASSERT_EQUAL_INT(context_clock (&context), 67);
+            TEST_ASSERT_EQUAL_INT(read_time (&context) == 1234567890123LL, 1);
+        }
+    }
+
+    TEST_SUITE("chunked_read")
+    {
+        SUITE_SETUP()
+        TEST_CASE("return_buffer_chunked", "Chunk continues from cursor")
+        {
+            static const char data[] = "0123456789";
+            char chunk[4];
+            long long cursor = 4;
+            struct buffer_rmcios breturn = {
+                .data = chunk,
+                .length = 0,
+                .size = sizeof (chunk),
+                .required_size = 0,
+                .trailing_size = 0,
+                .flags = buffer_chunked_rmcios
+            };
+            struct combo_rmcios creturn = {
+                .paramtype = int64_rmcios,
+                .num_params = 1,
+                .param.lv = &cursor
+            };
+            struct combo_rmcios returnv = {
+                .paramtype = buffer_rmcios,
+                .num_params = 1,
+                .param.bv = &breturn,
+                .next = &creturn
+            };
+
+            EXPECT_NO_CHANNEL_CALLS()
+            return_buffer_chunked (&context_mock, &returnv, data, 10);
+            TEST_ASSERT_EQUAL_INT(breturn.length, 4);
+            TEST_ASSERT_EQUAL_INT(chunk[0], '4');
+            TEST_ASSERT_EQUAL_INT((int) cursor, 8);
+
+            breturn.flags = buffer_chunked_rmcios;
+            return_buffer_chunked (&context_mock, &returnv, data, 10);
+            TEST_ASSERT_EQUAL_INT(breturn.length, 2);
+            TEST_ASSERT_EQUAL_INT((int) cursor, 0);
+        }
+
+        TEST_CASE("read_chunk_fallback", "Truncated data without chunks is reported")
+        {
+            char chunk[4];
+            long long cursor = 0;
+
+            TEST_CALLBACK(run_callback)
+            {
+                // Channel without chunked read support copies what fits
+                struct buffer_rmcios *b = run_callback.returnv->param.bv;
+                memcpy (b->data, "0123", 4);
+                b->length = 4;
+                b->required_size = 10;
+                return;
+            }
+            TEST_ASSERT_EQUAL_INT(read_chunk (&context_mock, 5, chunk,
+                                              sizeof (chunk), &cursor), -10);
+            TEST_ASSERT_EQUAL_INT((int) cursor, 0);
+            TEST_ASSERT_EQUAL_INT(chunk[3], '3');
+        }
+    }
+
+    TEST_SUITE("gather")
+    {
+        SUITE_SETUP()
+        TEST_CASE("param_to_binary", "Gather chain is linearized for legacy reads")
+        {
+            struct buffer_rmcios segments[3] = {
+                {.data = "ab", .length = 2, .required_size = 2},
+                {.data = "cde", .length = 3, .required_size = 3},
+                {.data = "f", .length = 1, .required_size = 1}
+            };
+            struct gather_rmcios gather = {
+                .segments = segments,
+                .count = 3
+            };
+            char linear[8];
+            struct buffer_rmcios result;
+
+            EXPECT_NO_CHANNEL_CALLS()
+            result = param_to_binary (&context_mock, gather_rmcios,
+                                      (union param_rmcios) &gather, 0,
+                                      sizeof (linear), linear);
+            TEST_ASSERT_EQUAL_INT(result.length, 6);
+            TEST_ASSERT_EQUAL_INT(linear[2], 'c');
+            TEST_ASSERT_EQUAL_INT(linear[5], 'f');
+        }
+    }
+
+    TEST_SUITE("gather_return")
+    {
+        SUITE_SETUP()
+        TEST_CASE("reference", "Multi-segment chain is not returned by reference")
+        {
+            struct buffer_rmcios segments[2] = {
+                {.data = "ab", .length = 2, .required_size = 2},
+                {.data = "cde", .length = 3, .required_size = 3}
+            };
+            struct gather_rmcios gather = {
+                .segments = segments,
+                .count = 2
+            };
+            struct buffer_rmcios breturn = { 0 };
+            struct combo_rmcios returnv = {
+                .paramtype = buffer_rmcios,
+                .num_params = 1,
+                .param.bv = &breturn
+            };
+
+            EXPECT_NO_CHANNEL_CALLS()
+            conversion_plan (gather_rmcios, buffer_rmcios).
+                convert (&context_mock, (union param_rmcios) &gather, 0,
+                         &returnv);
+            TEST_ASSERT_EQUAL_INT(breturn.data == 0, 1);
+            TEST_ASSERT_EQUAL_INT(breturn.length, 0);
+            TEST_ASSERT_EQUAL_INT(breturn.required_size, 5);
+
+            // Single segment is referred directly
+            gather.count = 1;
+            conversion_plan (gather_rmcios, buffer_rmcios).
+                convert (&context_mock, (union param_rmcios) &gather, 0,
+                         &returnv);
+            TEST_ASSERT_EQUAL_INT(breturn.data == segments[0].data, 1);
+            TEST_ASSERT_EQUAL_INT(breturn.length, 2);
+        }
+    }
+
+    TEST_SUITE("inline_string")
+    {
+        SUITE_SETUP()
+        TEST_CASE("return_string", "Short string is returned inline")
+        {
+            struct inline_rmcios str = { 0 };
+            struct combo_rmcios returnv = {
+                .paramtype = inline_rmcios,
+                .num_params = 1,
+                .param.inv = &str
+            };
+
+            EXPECT_NO_CHANNEL_CALLS()
+            return_string (&context_mock, &returnv, "mV");
+            TEST_ASSERT_EQUAL_INT(str.length, 2);
+            TEST_ASSERT_EQUAL_INT(str.data[1], 'V');
+            TEST_ASSERT_EQUAL_INT(str.data[2], 0);
+        }
+
+        TEST_CASE("param_to_channel", "Inline channel name is resolved as buffer")
+        {
+            struct inline_rmcios name = {.length = 6, .data = "sensor"};
+
+            TEST_CALLBACK(run_callback)
+            {
+                TEST_ASSERT_EQUAL_INT(run_callback.id, context_mock.id);
+                TEST_ASSERT_EQUAL_INT(run_callback.paramtype, buffer_rmcios);
+                TEST_ASSERT_EQUAL_INT(run_callback.num_params, 1);
+                TEST_ASSERT_EQUAL_INT(run_callback.param.bv->length, 6);
+                *(run_callback.returnv->param.iv) = 12;
+                return;
+            }
+            TEST_ASSERT_EQUAL_INT(param_to_channel (&context_mock, inline_rmcios,
+                                      (union param_rmcios) &name, 0), 12);
+        }
     }
         /* TODO
 
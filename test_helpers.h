@@ -0,0 +1,16 @@
+/*
+ * Helpers shared by the test programs. Included after
+ * test_callback_template.h, which defines the run_callback.
+ */
+#ifndef test_helpers_h
+#define test_helpers_h
+
+// Fails the test case when the tested function makes channel calls
+#define EXPECT_NO_CHANNEL_CALLS() \
+    TEST_CALLBACK(run_callback) \
+    { \
+        TEST_ASSERT_EQUAL_INT(1, 0); \
+        return; \
+    }
+
+#endif
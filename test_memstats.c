@@ -0,0 +1,219 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "test.h"
+#include "RMCIOS-API.h"
+#include "RMCIOS-functions.c"
+#include "RMCIOS-memstats.c"
+
+#define TEST_FUNC_NAME run_stub
+#define TEST_CALLBACK_NAME run_callback
+#undef TEST_FUNC_RETURN_TYPE
+#define TEST_FUNC_PARAMS PARAM(void *, data) SEP\
+                         PARAM(const struct context_rmcios * ,context) SEP\
+                         PARAM(int, id) SEP \
+                         PARAM(enum function_rmcios, function) SEP \
+                         PARAM(enum type_rmcios, paramtype) SEP \
+                         PARAM(struct combo_rmcios *, returnv) SEP\
+                         PARAM(int, num_params) SEP \
+                         PARAM(union param_rmcios, param)
+#include "test_callback_template.h"
+
+struct context_rmcios context_mock =
+{
+        .run_channel = run_stub,
+        .id = 55,
+        .name = 56,
+        .mem = 57,
+        .quemem = 58,
+        .errors = 59,
+        .warning = 60,
+        .report = 61,
+        .control = 62,
+        .link = 63,
+        .linked = 64,
+        .create = 65,
+        .convert = 66,
+};
+
+#include <stdlib.h>
+
+#define CREATE 700
+#define NAME 701
+#define MEM 702
+#define CONVERT 703
+#define WORKER 704
+#define ID 705
+#define FIRST_CHANNEL 1000
+
+static class_rmcios class_funcs[4];
+static void *class_data[4];
+static int num_created;
+static int parent_allocations;
+static void *worker_data;
+static struct memstats_rmcios stats;
+
+// Channels of the parent context. Worker allocates from its context.
+static void parent_run (void *data, const struct context_rmcios *context,
+                        int id, enum function_rmcios function,
+                        enum type_rmcios paramtype,
+                        struct combo_rmcios *returnv,
+                        int num_params, union param_rmcios param)
+{
+    if (id == CREATE)
+    {
+        class_funcs[num_created] = *(class_rmcios *) param.bv[0].data;
+        class_data[num_created] = *(void **) param.bv[1].data;
+        *(returnv->param.iv) = FIRST_CHANNEL + num_created++;
+    }
+    else if (id == MEM && num_params == 1)
+    {
+        void *ptr = malloc (*(int *) param.bv[0].data);
+        memcpy (returnv->param.bv->data, &ptr, sizeof (ptr));
+        returnv->param.bv->length = sizeof (ptr);
+        parent_allocations++;
+    }
+    else if (id == MEM && num_params == 2)
+    {
+        free (*(void **) param.bv[1].data);
+        parent_allocations--;
+    }
+    else if (id == CONVERT || id == ID)
+    {
+        // Returns of int and binary values. Channel ids are given as ints.
+        if (returnv->paramtype == int_rmcios)
+        {
+            *(returnv->param.iv) = param.iv[num_params - 1];
+        }
+        else if (function == read_rmcios)
+        {
+            // Reference to existing buffer
+            *(returnv->param.bv) = param.bv[num_params - 1];
+        }
+        else
+        {
+            const struct buffer_rmcios *b = param.bv + num_params - 1;
+            memcpy (returnv->param.bv->data, b->data, b->length);
+            returnv->param.bv->length = b->length;
+        }
+    }
+    else if (id == WORKER)
+    {
+        worker_data = allocate_storage (context, 100, 0);
+    }
+    else if (id >= FIRST_CHANNEL && id < FIRST_CHANNEL + num_created)
+    {
+        class_funcs[id - FIRST_CHANNEL] (class_data[id - FIRST_CHANNEL],
+                                         context, id, function, paramtype,
+                                         returnv, num_params, param);
+    }
+}
+
+static struct context_rmcios parent_context = {
+    .run_channel = parent_run,
+    .create = CREATE,
+    .name = NAME,
+    .mem = MEM,
+    .convert = CONVERT,
+    .id = ID,
+};
+
+TEST_RUNNER
+{
+    TEST_SUITE("memstats")
+    {
+        const struct context_rmcios *context;
+        const struct memstats_entry_rmcios *entry;
+
+        TEST_CASE("attribution", "Allocation is accounted to running channel")
+        {
+            num_created = 0;
+            context = memstats_init (&stats, &parent_context);
+            write_i (context, WORKER, 1);
+            entry = memstats_get (&stats, WORKER);
+            TEST_ASSERT_EQUAL_INT(1, entry != 0);
+            TEST_ASSERT_EQUAL_INT(100, (int) entry->live);
+            TEST_ASSERT_EQUAL_INT(1, (int) entry->count);
+
+            free_storage (context, worker_data, 0);
+            TEST_ASSERT_EQUAL_INT(0, (int) entry->live);
+            TEST_ASSERT_EQUAL_INT(0, (int) entry->count);
+            TEST_ASSERT_EQUAL_INT(100, (int) entry->peak);
+            TEST_ASSERT_EQUAL_INT(0, parent_allocations);
+        }
+
+        TEST_CASE("untracked", "Block from parent is freed without accounting")
+        {
+            void *ptr;
+            num_created = 0;
+            context = memstats_init (&stats, &parent_context);
+            write_i (context, WORKER, 1);
+            ptr = allocate_storage (&parent_context, 64, 0);
+            TEST_ASSERT_EQUAL_INT(2, parent_allocations);
+            free_storage (context, ptr, 0);
+            TEST_ASSERT_EQUAL_INT(1, parent_allocations);
+            TEST_ASSERT_EQUAL_INT(100, (int) memstats_get (&stats, WORKER)->live);
+            free_storage (context, worker_data, 0);
+            TEST_ASSERT_EQUAL_INT(0, parent_allocations);
+            TEST_ASSERT_EQUAL_INT(0, (int) stats.num_blocks);
+
+            // Null is ignored:
+            free_storage (context, 0, 0);
+            TEST_ASSERT_EQUAL_INT(0, parent_allocations);
+        }
+
+        TEST_CASE("read", "Live bytes are read without truncation")
+        {
+            long long live = 0;
+            int channel = WORKER;
+            struct combo_rmcios returnv = {
+                .paramtype = int64_rmcios,
+                .num_params = 1,
+                .param.lv = &live
+            };
+            num_created = 0;
+            context = memstats_init (&stats, &parent_context);
+            write_i (context, WORKER, 1);
+            ((struct memstats_entry_rmcios *)
+             memstats_get (&stats, WORKER))->live = 5000000000LL;
+            run_channel (context, stats.id, read_rmcios, int_rmcios,
+                         &returnv, 1, (union param_rmcios) &channel);
+            TEST_ASSERT_EQUAL_INT(1, live == 5000000000LL);
+            free (worker_data);
+            parent_allocations--;
+        }
+
+        TEST_CASE("many", "Blocks are tracked until the table is full")
+        {
+            static void *ptrs[MEMSTATS_BLOCKS];
+            int i;
+            num_created = 0;
+            context = memstats_init (&stats, &parent_context);
+            for (i = 0; i < MEMSTATS_BLOCKS; i++)
+            {
+                ptrs[i] = allocate_storage (context, 8, 0);
+            }
+            TEST_ASSERT_EQUAL_INT(MEMSTATS_BLOCKS / 4 * 3, stats.num_blocks);
+            TEST_ASSERT_EQUAL_INT(MEMSTATS_BLOCKS / 4, stats.overflows);
+            // Freed in other order than allocated:
+            for (i = 0; i < MEMSTATS_BLOCKS; i += 2)
+            {
+                free_storage (context, ptrs[i], 0);
+            }
+            for (i = 1; i < MEMSTATS_BLOCKS; i += 2)
+            {
+                free_storage (context, ptrs[i], 0);
+            }
+            TEST_ASSERT_EQUAL_INT(0, stats.num_blocks);
+            TEST_ASSERT_EQUAL_INT(0, (int) memstats_get (&stats, 0)->live);
+            TEST_ASSERT_EQUAL_INT(0, (int) memstats_get (&stats, 0)->count);
+            TEST_ASSERT_EQUAL_INT(0, parent_allocations);
+        }
+    }
+}
+
+int main(void)
+{
+    TEST_RUN(test_data)
+    return TEST_RESULTS(test_data)
+}
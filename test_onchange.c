@@ -0,0 +1,145 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "test.h"
+#include "RMCIOS-API.h"
+#include "RMCIOS-functions.c"
+#include "RMCIOS-onchange.c"
+
+#define TEST_FUNC_NAME run_stub
+#define TEST_CALLBACK_NAME run_callback
+#undef TEST_FUNC_RETURN_TYPE
+#define TEST_FUNC_PARAMS PARAM(void *, data) SEP\
+                         PARAM(const struct context_rmcios * ,context) SEP\
+                         PARAM(int, id) SEP \
+                         PARAM(enum function_rmcios, function) SEP \
+                         PARAM(enum type_rmcios, paramtype) SEP \
+                         PARAM(struct combo_rmcios *, returnv) SEP\
+                         PARAM(int, num_params) SEP \
+                         PARAM(union param_rmcios, param)
+#include "test_callback_template.h"
+#include "test_helpers.h"
+
+struct context_rmcios context_mock =
+{
+        .run_channel = run_stub,
+        .id = 55,
+        .name = 56,
+        .mem = 57,
+        .quemem = 58,
+        .errors = 59,
+        .warning = 60,
+        .report = 61,
+        .control = 62,
+        .link = 63,
+        .linked = 64,
+        .create = 65,
+        .convert = 66,
+};
+
+TEST_RUNNER
+{
+    TEST_SUITE("deadband")
+    {
+        SUITE_SETUP()
+        TEST_CASE("float", "Float write passes only when it crosses deadband")
+        {
+            struct onchange_rmcios filter;
+            float value;
+
+            EXPECT_NO_CHANNEL_CALLS()
+            onchange_init (&filter, &context_mock, 0.5, 0);
+            value = 1.0f;
+            TEST_ASSERT_EQUAL_INT(onchange_test (&filter, float_rmcios, 1,
+                                      (union param_rmcios) &value), 1);
+            value = 1.3f;
+            TEST_ASSERT_EQUAL_INT(onchange_test (&filter, float_rmcios, 1,
+                                      (union param_rmcios) &value), 0);
+            value = 0.75f;
+            TEST_ASSERT_EQUAL_INT(onchange_test (&filter, float_rmcios, 1,
+                                      (union param_rmcios) &value), 0);
+            value = 1.6f;
+            TEST_ASSERT_EQUAL_INT(onchange_test (&filter, float_rmcios, 1,
+                                      (union param_rmcios) &value), 1);
+            value = 1.0f;
+            TEST_ASSERT_EQUAL_INT(onchange_test (&filter, float_rmcios, 1,
+                                      (union param_rmcios) &value), 1);
+            TEST_ASSERT_EQUAL_INT(filter.suppressed, 2);
+            TEST_ASSERT_EQUAL_INT(filter.passed, 3);
+        }
+
+        TEST_CASE("setup", "Deadband is parsed from text")
+        {
+            struct onchange_rmcios filter;
+            struct buffer_rmcios params[2] = {
+                {.data = "0.5", .length = 3, .required_size = 3},
+                {.data = "100", .length = 3, .required_size = 3}
+            };
+
+            TEST_CALLBACK(run_callback)
+            {
+                // Refresh time is converted by convert channel
+                TEST_ASSERT_EQUAL_INT(run_callback.id, context_mock.convert);
+                TEST_ASSERT_EQUAL_INT(run_callback.returnv->paramtype, int_rmcios);
+                TEST_ASSERT_EQUAL_INT(run_callback.num_params, 2);
+                *(run_callback.returnv->param.iv) = 100;
+                return;
+            }
+            onchange_init (&filter, &context_mock, 0, 0);
+            onchange_class_func (&filter, &context_mock, 1000, setup_rmcios,
+                                 buffer_rmcios, 0, 2,
+                                 (union param_rmcios) params);
+            TEST_ASSERT_EQUAL_INT(filter.deadband == 0.5, 1);
+            TEST_ASSERT_EQUAL_INT((int) (filter.refresh / 1000000), 100);
+        }
+    }
+
+    TEST_SUITE("change")
+    {
+        SUITE_SETUP()
+        TEST_CASE("exact", "Without deadband any change passes")
+        {
+            struct onchange_rmcios filter;
+            int value = 7;
+
+            EXPECT_NO_CHANNEL_CALLS()
+            onchange_init (&filter, &context_mock, 0, 0);
+            TEST_ASSERT_EQUAL_INT(onchange_test (&filter, int_rmcios, 1,
+                                      (union param_rmcios) &value), 1);
+            TEST_ASSERT_EQUAL_INT(onchange_test (&filter, int_rmcios, 1,
+                                      (union param_rmcios) &value), 0);
+            value = 8;
+            TEST_ASSERT_EQUAL_INT(onchange_test (&filter, int_rmcios, 1,
+                                      (union param_rmcios) &value), 1);
+        }
+
+        TEST_CASE("long_buffer", "Change past the hash copy size passes")
+        {
+            struct onchange_rmcios filter;
+            static char text[ONCHANGE_HASH_SIZE + 64];
+            struct buffer_rmcios status = {
+                .data = text,
+                .length = sizeof (text),
+                .size = 0,
+                .required_size = sizeof (text)
+            };
+
+            EXPECT_NO_CHANNEL_CALLS()
+            memset (text, 'a', sizeof (text));
+            onchange_init (&filter, &context_mock, 0, 0);
+            TEST_ASSERT_EQUAL_INT(onchange_test (&filter, buffer_rmcios, 1,
+                                      (union param_rmcios) &status), 1);
+            TEST_ASSERT_EQUAL_INT(onchange_test (&filter, buffer_rmcios, 1,
+                                      (union param_rmcios) &status), 0);
+            text[ONCHANGE_HASH_SIZE + 32] = 'b';
+            TEST_ASSERT_EQUAL_INT(onchange_test (&filter, buffer_rmcios, 1,
+                                      (union param_rmcios) &status), 1);
+        }
+    }
+}
+
+int main(void)
+{
+    TEST_RUN(test_data)
+    return TEST_RESULTS(test_data)
+}
@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "test.h"
+#include "RMCIOS-API.h"
+#include "RMCIOS-functions.c"
+#include "RMCIOS-perfcount.c"
+
+#define TEST_FUNC_NAME run_stub
+#define TEST_CALLBACK_NAME run_callback
+#undef TEST_FUNC_RETURN_TYPE
+#define TEST_FUNC_PARAMS PARAM(void *, data) SEP\
+                         PARAM(const struct context_rmcios * ,context) SEP\
+                         PARAM(int, id) SEP \
+                         PARAM(enum function_rmcios, function) SEP \
+                         PARAM(enum type_rmcios, paramtype) SEP \
+                         PARAM(struct combo_rmcios *, returnv) SEP\
+                         PARAM(int, num_params) SEP \
+                         PARAM(union param_rmcios, param)
+#include "test_callback_template.h"
+
+struct context_rmcios context_mock =
+{
+        .run_channel = run_stub,
+        .id = 55,
+        .name = 56,
+        .mem = 57,
+        .quemem = 58,
+        .errors = 59,
+        .warning = 60,
+        .report = 61,
+        .control = 62,
+        .link = 63,
+        .linked = 64,
+        .create = 65,
+        .convert = 66,
+};
+
+#define CREATE 600
+#define OUTER 602
+#define INNER 603
+#define FIRST_CHANNEL 1000
+
+static struct perfcount_rmcios perfcount;
+static const struct context_rmcios *wrapper;
+static volatile unsigned int sink;
+
+// Parent context: outer channel calls the inner channel
+static void parent_run (void *data, const struct context_rmcios *context,
+                        int id, enum function_rmcios function,
+                        enum type_rmcios paramtype,
+                        struct combo_rmcios *returnv,
+                        int num_params, union param_rmcios param)
+{
+    int i;
+    if (id == CREATE)
+    {
+        *(returnv->param.iv) = FIRST_CHANNEL;
+    }
+    else if (id == OUTER)
+    {
+        for (i = 0; i < 10000; i++)
+        {
+            sink += i;
+        }
+        run_channel (context, INNER, read_rmcios, int_rmcios, 0, 0,
+                     (union param_rmcios) 0);
+    }
+    else if (id == INNER)
+    {
+        for (i = 0; i < 100000; i++)
+        {
+            sink += i;
+        }
+    }
+}
+
+static struct context_rmcios parent_context = {
+    .run_channel = parent_run,
+    .create = CREATE,
+};
+
+static void *other_thread (void *arg)
+{
+    write_i (wrapper, INNER, 1);
+    return 0;
+}
+
+TEST_RUNNER
+{
+    TEST_SUITE("perfcount")
+    {
+        const struct perfcount_entry_rmcios *outer;
+        const struct perfcount_entry_rmcios *inner;
+        int event;
+
+        TEST_CASE("nested", "Nested call is left out of self counts")
+        {
+            wrapper = perfcount_init (&perfcount, &parent_context);
+            write_i (wrapper, OUTER, 1);
+            outer = perfcount_get (&perfcount, OUTER, write_rmcios);
+            inner = perfcount_get (&perfcount, INNER, read_rmcios);
+            TEST_ASSERT_EQUAL_INT(1, outer != 0 && inner != 0);
+            TEST_ASSERT_EQUAL_INT(1, outer->calls);
+            TEST_ASSERT_EQUAL_INT(1, inner->calls);
+            for (event = 0; event < perfcount_events; event++)
+            {
+                // Holds also for unavailable counters reading 0
+                TEST_ASSERT_EQUAL_INT(1, outer->self[event]
+                                      <= outer->total[event]);
+                TEST_ASSERT_EQUAL_INT(1, inner->total[event]
+                                      <= outer->total[event]);
+            }
+        }
+
+        TEST_CASE("multiplexed", "Interval counts are scaled by interval times")
+        {
+            struct perfcount_sample_rmcios start = {
+                .enabled = 1000,
+                .running = 1000,
+                .values = { 5000 }
+            };
+            struct perfcount_sample_rmcios end = {
+                .enabled = 3000,
+                .running = 1500,
+                .values = { 5400 }
+            };
+            // 400 counted in 500 of 2000 enabled
+            TEST_ASSERT_EQUAL_INT(1600, sample_delta (&start, &end, 0));
+            // Unchanged or reset counter counts 0
+            end.values[0] = 5000;
+            TEST_ASSERT_EQUAL_INT(0, sample_delta (&start, &end, 0));
+            end.values[0] = 4000;
+            TEST_ASSERT_EQUAL_INT(0, sample_delta (&start, &end, 0));
+            // Not multiplexed
+            end.running = 3000;
+            end.values[0] = 5400;
+            TEST_ASSERT_EQUAL_INT(400, sample_delta (&start, &end, 0));
+        }
+
+        TEST_CASE("thread", "Calls from other threads are not measured")
+        {
+            pthread_t thread;
+            pthread_create (&thread, 0, other_thread, 0);
+            pthread_join (thread, 0);
+            inner = perfcount_get (&perfcount, INNER, read_rmcios);
+            TEST_ASSERT_EQUAL_INT(1, perfcount.other_threads);
+            TEST_ASSERT_EQUAL_INT(1, inner->calls);
+            TEST_ASSERT_EQUAL_INT(0, perfcount_get (&perfcount, INNER,
+                                                    write_rmcios) != 0);
+        }
+
+        TEST_CASE("clear", "Results are cleared")
+        {
+            perfcount_clear (&perfcount);
+            TEST_ASSERT_EQUAL_INT(0, perfcount_get (&perfcount, OUTER,
+                                                    write_rmcios) != 0);
+            TEST_ASSERT_EQUAL_INT(0, perfcount.other_threads);
+            perfcount_close (&perfcount);
+        }
+    }
+}
+
+int main(void)
+{
+    TEST_RUN(test_data)
+    return TEST_RESULTS(test_data)
+}
@@ -0,0 +1,119 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "test.h"
+#include "RMCIOS-API.h"
+#include "RMCIOS-functions.c"
+#include "RMCIOS-prepared.c"
+
+#define TEST_FUNC_NAME run_stub
+#define TEST_CALLBACK_NAME run_callback
+#undef TEST_FUNC_RETURN_TYPE
+#define TEST_FUNC_PARAMS PARAM(void *, data) SEP\
+                         PARAM(const struct context_rmcios * ,context) SEP\
+                         PARAM(int, id) SEP \
+                         PARAM(enum function_rmcios, function) SEP \
+                         PARAM(enum type_rmcios, paramtype) SEP \
+                         PARAM(struct combo_rmcios *, returnv) SEP\
+                         PARAM(int, num_params) SEP \
+                         PARAM(union param_rmcios, param)
+#include "test_callback_template.h"
+
+struct context_rmcios context_mock =
+{
+        .run_channel = run_stub,
+        .id = 55,
+        .name = 56,
+        .mem = 57,
+        .quemem = 58,
+        .errors = 59,
+        .warning = 60,
+        .report = 61,
+        .control = 62,
+        .link = 63,
+        .linked = 64,
+        .create = 65,
+        .convert = 66,
+};
+
+TEST_RUNNER
+{
+    TEST_SUITE("prepared_write")
+    {
+        SUITE_SETUP()
+        TEST_CASE("return_type", "Return value is converted to invocation type")
+        {
+            struct prepared_rmcios call;
+            float values[2] = { 1.5f, 2.5f };
+
+            TEST_CALLBACK(run_callback)
+            {
+                TEST_ASSERT_EQUAL_INT(run_callback.id, 1000);
+                TEST_ASSERT_EQUAL_INT(run_callback.paramtype, float_rmcios);
+                TEST_ASSERT_EQUAL_INT(run_callback.num_params, 2);
+                TEST_ASSERT_EQUAL_INT(run_callback.returnv->paramtype, int_rmcios);
+                *(run_callback.returnv->param.iv) = 7;
+                return;
+            }
+            prepare_call (&call, &context_mock, 1000, write_rmcios,
+                          float_rmcios, 2, int_rmcios);
+            TEST_ASSERT_EQUAL_INT(prepared_write_fv (&call, values) == 7.0f, 1);
+        }
+
+        TEST_CASE("double_return", "Double return is converted to integer")
+        {
+            struct prepared_rmcios call;
+            int values[1] = { 3 };
+
+            TEST_CALLBACK(run_callback)
+            {
+                TEST_ASSERT_EQUAL_INT(run_callback.paramtype, int_rmcios);
+                *(run_callback.returnv->param.dv) = 42.5;
+                return;
+            }
+            prepare_call (&call, &context_mock, 1000, read_rmcios,
+                          int_rmcios, 1, double_rmcios);
+            TEST_ASSERT_EQUAL_INT(prepared_write_iv (&call, values), 42);
+        }
+
+        TEST_CASE("values", "Values are converted to prepared type")
+        {
+            struct prepared_rmcios call;
+            int values[2] = { 3, 4 };
+
+            TEST_CALLBACK(run_callback)
+            {
+                TEST_ASSERT_EQUAL_INT(run_callback.paramtype, double_rmcios);
+                TEST_ASSERT_EQUAL_INT(run_callback.num_params, 2);
+                TEST_ASSERT_EQUAL_INT(run_callback.param.dv[1] == 4.0, 1);
+                return;
+            }
+            prepare_call (&call, &context_mock, 1000, write_rmcios,
+                          double_rmcios, 2, 0);
+            TEST_ASSERT_EQUAL_INT(prepared_write_iv (&call, values), 0);
+        }
+
+        TEST_CASE("str", "String is written as single parameter")
+        {
+            struct prepared_rmcios call;
+
+            TEST_CALLBACK(run_callback)
+            {
+                TEST_ASSERT_EQUAL_INT(run_callback.paramtype, buffer_rmcios);
+                TEST_ASSERT_EQUAL_INT(run_callback.num_params, 1);
+                TEST_ASSERT_EQUAL_INT(run_callback.param.bv->length, 5);
+                return;
+            }
+            prepare_call (&call, &context_mock, 1000, write_rmcios,
+                          float_rmcios, 3, 0);
+            prepared_write_str (&call, "hello");
+            prepared_write_buffer (&call, "hello", 5);
+        }
+    }
+}
+
+int main(void)
+{
+    TEST_RUN(test_data)
+    return TEST_RESULTS(test_data)
+}
@@ -0,0 +1,121 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "test.h"
+#include "RMCIOS-API.h"
+#include "RMCIOS-functions.c"
+#include "RMCIOS-profiler.c"
+
+#define TEST_FUNC_NAME run_stub
+#define TEST_CALLBACK_NAME run_callback
+#undef TEST_FUNC_RETURN_TYPE
+#define TEST_FUNC_PARAMS PARAM(void *, data) SEP\
+                         PARAM(const struct context_rmcios * ,context) SEP\
+                         PARAM(int, id) SEP \
+                         PARAM(enum function_rmcios, function) SEP \
+                         PARAM(enum type_rmcios, paramtype) SEP \
+                         PARAM(struct combo_rmcios *, returnv) SEP\
+                         PARAM(int, num_params) SEP \
+                         PARAM(union param_rmcios, param)
+#include "test_callback_template.h"
+
+struct context_rmcios context_mock =
+{
+        .run_channel = run_stub,
+        .id = 55,
+        .name = 56,
+        .mem = 57,
+        .quemem = 58,
+        .errors = 59,
+        .warning = 60,
+        .report = 61,
+        .control = 62,
+        .link = 63,
+        .linked = 64,
+        .create = 65,
+        .convert = 66,
+};
+
+#define CREATE 600
+#define NAME 601
+#define OUTER 602
+#define INNER 603
+#define FIRST_CHANNEL 1000
+
+static struct profiler_rmcios profiler;
+
+// Parent context: names of the channels and nested calls that sample
+static void parent_run (void *data, const struct context_rmcios *context,
+                        int id, enum function_rmcios function,
+                        enum type_rmcios paramtype,
+                        struct combo_rmcios *returnv,
+                        int num_params, union param_rmcios param)
+{
+    if (id == CREATE)
+    {
+        *(returnv->param.iv) = FIRST_CHANNEL;
+    }
+    else if (id == NAME && function == read_rmcios)
+    {
+        const char *name = (param.iv[0] == OUTER) ? "my sensor" : "a;b";
+        struct buffer_rmcios *b = returnv->param.bv;
+        b->length = strlen (name);
+        memcpy (b->data, name, b->length);
+    }
+    else if (id == OUTER)
+    {
+        run_channel (context, INNER, read_rmcios, int_rmcios, 0, 0,
+                     (union param_rmcios) 0);
+    }
+    else if (id == INNER)
+    {
+        profiler_sample (&profiler);
+    }
+}
+
+static struct context_rmcios parent_context = {
+    .run_channel = parent_run,
+    .create = CREATE,
+    .name = NAME,
+};
+
+TEST_RUNNER
+{
+    TEST_SUITE("profiler")
+    {
+        TEST_CASE("sample", "Shadow stack of nested calls is counted")
+        {
+            const struct context_rmcios *context =
+                profiler_init (&profiler, &parent_context);
+            profiler_sample (&profiler);
+            TEST_ASSERT_EQUAL_INT(1, profiler.idle);
+
+            write_i (context, OUTER, 1);
+            write_i (context, OUTER, 1);
+            TEST_ASSERT_EQUAL_INT(0, profiler.dropped);
+            TEST_ASSERT_EQUAL_INT(0, shadow.depth);
+        }
+
+        TEST_CASE("collapsed", "Separators in names are replaced")
+        {
+            char report[64];
+            profiler_collapsed (&profiler, report, sizeof (report));
+            TEST_ASSERT_EQUAL_STR(report, "my_sensor.write;a_b.read 2\n");
+        }
+
+        TEST_CASE("clear", "Samples are cleared")
+        {
+            char report[64];
+            profiler_clear (&profiler);
+            TEST_ASSERT_EQUAL_INT(0, profiler_collapsed (&profiler, report,
+                                                         sizeof (report)));
+            TEST_ASSERT_EQUAL_INT(0, profiler.idle);
+        }
+    }
+}
+
+int main(void)
+{
+    TEST_RUN(test_data)
+    return TEST_RESULTS(test_data)
+}
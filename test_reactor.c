@@ -0,0 +1,138 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "test.h"
+#include "RMCIOS-API.h"
+#include "RMCIOS-functions.c"
+#include "RMCIOS-reactor.c"
+
+#define TEST_FUNC_NAME run_stub
+#define TEST_CALLBACK_NAME run_callback
+#undef TEST_FUNC_RETURN_TYPE
+#define TEST_FUNC_PARAMS PARAM(void *, data) SEP\
+                         PARAM(const struct context_rmcios * ,context) SEP\
+                         PARAM(int, id) SEP \
+                         PARAM(enum function_rmcios, function) SEP \
+                         PARAM(enum type_rmcios, paramtype) SEP \
+                         PARAM(struct combo_rmcios *, returnv) SEP\
+                         PARAM(int, num_params) SEP \
+                         PARAM(union param_rmcios, param)
+#include "test_callback_template.h"
+
+struct context_rmcios context_mock =
+{
+        .run_channel = run_stub,
+        .id = 55,
+        .name = 56,
+        .mem = 57,
+        .quemem = 58,
+        .errors = 59,
+        .warning = 60,
+        .report = 61,
+        .control = 62,
+        .link = 63,
+        .linked = 64,
+        .create = 65,
+        .convert = 66,
+};
+
+#include <fcntl.h>
+#include <sys/socket.h>
+
+#define CHANNEL_A 1001
+#define CHANNEL_B 1002
+#define CHANNEL_C 1003
+
+static struct reactor_rmcios reactor;
+static int pipe_a[2], pipe_b[2], pipe_c[2];
+static int writes[3];
+static int swapped;
+
+// Receiving channels. First of A and B replaces the other with C.
+static void receiver_run (void *data, const struct context_rmcios *context,
+                          int id, enum function_rmcios function,
+                          enum type_rmcios paramtype,
+                          struct combo_rmcios *returnv,
+                          int num_params, union param_rmcios param)
+{
+    if (function != write_rmcios || id < CHANNEL_A || id > CHANNEL_C)
+    {
+        return;
+    }
+    writes[id - CHANNEL_A]++;
+    if (id != CHANNEL_C && !swapped)
+    {
+        swapped = 1;
+        reactor_remove (&reactor, id == CHANNEL_A ? pipe_b[0] : pipe_a[0]);
+        reactor_add_fd (&reactor, pipe_c[0], CHANNEL_C);
+    }
+}
+
+static struct context_rmcios receiver_context = {
+    .run_channel = receiver_run,
+};
+
+TEST_RUNNER
+{
+    TEST_SUITE("reactor")
+    {
+        TEST_CASE("stale", "Event of a replaced source is ignored")
+        {
+            TEST_ASSERT_EQUAL_INT(0, pipe2 (pipe_a, O_NONBLOCK));
+            TEST_ASSERT_EQUAL_INT(0, pipe2 (pipe_b, O_NONBLOCK));
+            TEST_ASSERT_EQUAL_INT(0, pipe2 (pipe_c, O_NONBLOCK));
+            TEST_ASSERT_EQUAL_INT(0, reactor_init (&reactor,
+                                                    &receiver_context));
+            TEST_ASSERT_EQUAL_INT(0, reactor_add_fd (&reactor, pipe_a[0],
+                                                      CHANNEL_A));
+            TEST_ASSERT_EQUAL_INT(0, reactor_add_fd (&reactor, pipe_b[0],
+                                                      CHANNEL_B));
+            TEST_ASSERT_EQUAL_INT(1, write (pipe_a[1], "a", 1));
+            TEST_ASSERT_EQUAL_INT(1, write (pipe_b[1], "b", 1));
+            TEST_ASSERT_EQUAL_INT(1, write (pipe_c[1], "c", 1));
+
+            // Event of the removed source must not reach C:
+            reactor_run (&reactor, 100);
+            TEST_ASSERT_EQUAL_INT(1, swapped);
+            TEST_ASSERT_EQUAL_INT(1, writes[0] + writes[1]);
+            TEST_ASSERT_EQUAL_INT(0, writes[2]);
+
+            // C receives on its own registration:
+            reactor_run (&reactor, 100);
+            TEST_ASSERT_EQUAL_INT(1, writes[0] + writes[1]);
+            TEST_ASSERT_EQUAL_INT(1, writes[2]);
+        }
+
+        TEST_CASE("writev", "Partial progress is reported on non-blocking fd")
+        {
+            static char data[1 << 20];
+            struct buffer_rmcios segments[2] = {
+                {.data = data,.length = sizeof (data) / 2},
+                {.data = data + sizeof (data) / 2,.length = sizeof (data) / 2}
+            };
+            struct gather_rmcios gather = {
+                .segments = segments,.count = 2
+            };
+            int pair[2];
+            int written;
+
+            TEST_ASSERT_EQUAL_INT(0, socketpair (AF_UNIX,
+                                                  SOCK_STREAM | SOCK_NONBLOCK,
+                                                  0, pair));
+            written = reactor_writev (pair[0], &gather);
+            TEST_ASSERT_EQUAL_INT(1, written > 0);
+            TEST_ASSERT_EQUAL_INT(1, written < (int) sizeof (data));
+
+            // Nothing written at all is still an error:
+            TEST_ASSERT_EQUAL_INT(-1, reactor_writev (pair[0], &gather));
+            close (pair[0]);
+            close (pair[1]);
+        }
+    }
+}
+
+int main(void)
+{
+    TEST_RUN(test_data)
+    return TEST_RESULTS(test_data)
+}
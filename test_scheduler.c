@@ -0,0 +1,162 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "test.h"
+#include "RMCIOS-API.h"
+#include "RMCIOS-functions.c"
+#include "RMCIOS-scheduler.c"
+
+#define TEST_FUNC_NAME run_stub
+#define TEST_CALLBACK_NAME run_callback
+#undef TEST_FUNC_RETURN_TYPE
+#define TEST_FUNC_PARAMS PARAM(void *, data) SEP\
+                         PARAM(const struct context_rmcios * ,context) SEP\
+                         PARAM(int, id) SEP \
+                         PARAM(enum function_rmcios, function) SEP \
+                         PARAM(enum type_rmcios, paramtype) SEP \
+                         PARAM(struct combo_rmcios *, returnv) SEP\
+                         PARAM(int, num_params) SEP \
+                         PARAM(union param_rmcios, param)
+#include "test_callback_template.h"
+
+struct context_rmcios context_mock =
+{
+        .run_channel = run_stub,
+        .id = 55,
+        .name = 56,
+        .mem = 57,
+        .quemem = 58,
+        .errors = 59,
+        .warning = 60,
+        .report = 61,
+        .control = 62,
+        .link = 63,
+        .linked = 64,
+        .create = 65,
+        .convert = 66,
+};
+
+#include <stdlib.h>
+
+#define MEM 600
+#define TARGET 601
+#define OTHER 602
+#define ADVANCER 603
+
+static struct scheduler_rmcios scheduler;
+static int target_calls;
+static int other_calls;
+static int advancer_calls;
+
+// Memory and the called channels of the scheduler context
+static void target_run (void *data, const struct context_rmcios *context,
+                        int id, enum function_rmcios function,
+                        enum type_rmcios paramtype,
+                        struct combo_rmcios *returnv,
+                        int num_params, union param_rmcios param)
+{
+    if (id == MEM && num_params == 1)
+    {
+        void *ptr = malloc (*(int *) param.bv[0].data);
+        memcpy (returnv->param.bv->data, &ptr, sizeof (ptr));
+        returnv->param.bv->length = sizeof (ptr);
+    }
+    else if (id == TARGET)
+    {
+        target_calls++;
+    }
+    else if (id == OTHER)
+    {
+        other_calls++;
+    }
+    else if (id == ADVANCER)
+    {
+        advancer_calls++;
+        scheduler_advance (&scheduler, context, 2);
+    }
+}
+
+static struct context_rmcios target_context = {
+    .run_channel = target_run,
+    .mem = MEM,
+};
+
+TEST_RUNNER
+{
+    TEST_SUITE("scheduler")
+    {
+        int handle;
+
+        TEST_CASE("single", "Single call runs after the delay")
+        {
+            TEST_ASSERT_EQUAL_INT(0, scheduler_init (&scheduler,
+                                                     &target_context, 64));
+            TEST_ASSERT_EQUAL_INT(1, scheduler_add (&scheduler, 3, 0, TARGET,
+                                                    write_rmcios) != 0);
+            scheduler_advance (&scheduler, &target_context, 3);
+            TEST_ASSERT_EQUAL_INT(0, target_calls);
+            scheduler_advance (&scheduler, &target_context, 1);
+            TEST_ASSERT_EQUAL_INT(1, target_calls);
+            TEST_ASSERT_EQUAL_INT(0, scheduler.num_entries);
+        }
+
+        TEST_CASE("periodic", "Periodic call repeats until cancelled")
+        {
+            target_calls = 0;
+            handle = scheduler_add (&scheduler, 1, 2, TARGET, write_rmcios);
+            scheduler_advance (&scheduler, &target_context, 6);
+            TEST_ASSERT_EQUAL_INT(3, target_calls);
+            TEST_ASSERT_EQUAL_INT(0, scheduler_cancel (&scheduler, handle));
+            TEST_ASSERT_EQUAL_INT(-1, scheduler_cancel (&scheduler, handle));
+            scheduler_advance (&scheduler, &target_context, 6);
+            TEST_ASSERT_EQUAL_INT(3, target_calls);
+        }
+
+        TEST_CASE("cascade", "Long delay is cascaded through the levels")
+        {
+            target_calls = 0;
+            scheduler_add (&scheduler, 100000, 0, TARGET, write_rmcios);
+            scheduler_advance (&scheduler, &target_context, 100000);
+            TEST_ASSERT_EQUAL_INT(0, target_calls);
+            scheduler_advance (&scheduler, &target_context, 1);
+            TEST_ASSERT_EQUAL_INT(1, target_calls);
+        }
+
+        TEST_CASE("reentrant", "Advance from scheduled call is deferred")
+        {
+            unsigned long long start = scheduler.current;
+            target_calls = 0;
+            // Advancer is run first from the batch:
+            scheduler_add (&scheduler, 0, 0, OTHER, write_rmcios);
+            scheduler_add (&scheduler, 0, 0, ADVANCER, write_rmcios);
+            scheduler_add (&scheduler, 2, 0, TARGET, write_rmcios);
+            scheduler_advance (&scheduler, &target_context, 1);
+            TEST_ASSERT_EQUAL_INT(1, advancer_calls);
+            TEST_ASSERT_EQUAL_INT(1, other_calls);
+            TEST_ASSERT_EQUAL_INT(1, target_calls);
+            TEST_ASSERT_EQUAL_INT(3, (int) (scheduler.current - start));
+            TEST_ASSERT_EQUAL_INT(0, scheduler.num_entries);
+        }
+
+        TEST_CASE("read", "Current tick is read without truncation")
+        {
+            long long tick = 0;
+            struct combo_rmcios returnv = {
+                .paramtype = int64_rmcios,
+                .num_params = 1,
+                .param.lv = &tick
+            };
+            scheduler.current = 5000000000ULL;
+            scheduler_class_func (&scheduler, &target_context, 0, read_rmcios,
+                                  int_rmcios, &returnv, 0,
+                                  (union param_rmcios) 0);
+            TEST_ASSERT_EQUAL_INT(1, tick == 5000000000LL);
+        }
+    }
+}
+
+int main(void)
+{
+    TEST_RUN(test_data)
+    return TEST_RESULTS(test_data)
+}
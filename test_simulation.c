@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "test.h"
+#include "RMCIOS-API.h"
+#include "RMCIOS-functions.c"
+#include "RMCIOS-scheduler.c"
+#include "RMCIOS-simulation.c"
+
+#define TEST_FUNC_NAME run_stub
+#define TEST_CALLBACK_NAME run_callback
+#undef TEST_FUNC_RETURN_TYPE
+#define TEST_FUNC_PARAMS PARAM(void *, data) SEP\
+                         PARAM(const struct context_rmcios * ,context) SEP\
+                         PARAM(int, id) SEP \
+                         PARAM(enum function_rmcios, function) SEP \
+                         PARAM(enum type_rmcios, paramtype) SEP \
+                         PARAM(struct combo_rmcios *, returnv) SEP\
+                         PARAM(int, num_params) SEP \
+                         PARAM(union param_rmcios, param)
+#include "test_callback_template.h"
+
+struct context_rmcios context_mock =
+{
+        .run_channel = run_stub,
+        .id = 55,
+        .name = 56,
+        .mem = 57,
+        .quemem = 58,
+        .errors = 59,
+        .warning = 60,
+        .report = 61,
+        .control = 62,
+        .link = 63,
+        .linked = 64,
+        .create = 65,
+        .convert = 66,
+};
+
+#include <stdlib.h>
+
+#define CREATE 600
+#define MEM 601
+#define CONVERT 602
+#define FIRST 603
+#define SECOND 604
+#define CLOCK_CHANNEL 700
+
+// Start at 1000 s with 1 ms ticks
+#define START_TIME 1000000000000LL
+#define TICK_TIME 1000000LL
+
+static struct scheduler_rmcios scheduler;
+static struct simulation_rmcios simulation;
+static class_rmcios clock_func;
+static void *clock_data;
+static int calls[8];
+static long long call_times[8];
+static int num_calls;
+
+// Parent context channels. Timer channels record their call time.
+static void parent_run (void *data, const struct context_rmcios *context,
+                        int id, enum function_rmcios function,
+                        enum type_rmcios paramtype,
+                        struct combo_rmcios *returnv,
+                        int num_params, union param_rmcios param)
+{
+    if (id == CREATE)
+    {
+        clock_func = *(class_rmcios *) param.bv[0].data;
+        clock_data = *(void **) param.bv[1].data;
+        *(returnv->param.iv) = CLOCK_CHANNEL;
+    }
+    else if (id == MEM && num_params == 1)
+    {
+        void *ptr = malloc (*(int *) param.bv[0].data);
+        memcpy (returnv->param.bv->data, &ptr, sizeof (ptr));
+        returnv->param.bv->length = sizeof (ptr);
+    }
+    else if (id == CONVERT)
+    {
+        // Binary copy of binary return
+        const struct buffer_rmcios *b = param.bv + num_params - 1;
+        memcpy (returnv->param.bv->data, b->data, b->length);
+        returnv->param.bv->length = b->length;
+    }
+    else if (id == CLOCK_CHANNEL)
+    {
+        clock_func (clock_data, context, id, function, paramtype, returnv,
+                    num_params, param);
+    }
+    else if ((id == FIRST || id == SECOND) && num_calls < 8)
+    {
+        calls[num_calls] = id;
+        call_times[num_calls] = read_time (context);
+        num_calls++;
+    }
+}
+
+static struct context_rmcios parent_context = {
+    .version = CONTEXT_VERSION_CLOCK_RMCIOS,
+    .run_channel = parent_run,
+    .create = CREATE,
+    .mem = MEM,
+    .convert = CONVERT,
+};
+
+TEST_RUNNER
+{
+    TEST_SUITE("simulation")
+    {
+        const struct context_rmcios *context;
+
+        TEST_CASE("advance", "Virtual time is time of the last processed tick")
+        {
+            scheduler_init (&scheduler, &parent_context, 16);
+            context = simulation_init (&simulation, &parent_context,
+                                       &scheduler, START_TIME, TICK_TIME);
+            TEST_ASSERT_EQUAL_INT(1, context != 0);
+            TEST_ASSERT_EQUAL_INT(CLOCK_CHANNEL, context->clock);
+            TEST_ASSERT_EQUAL_INT(1, simulation_time (&simulation)
+                                  == START_TIME);
+            // Ticks 0-4 are processed:
+            simulation_run (&simulation, 5 * TICK_TIME);
+            TEST_ASSERT_EQUAL_INT(5, (int) scheduler.current);
+            TEST_ASSERT_EQUAL_INT(4, (int) ((simulation_time (&simulation)
+                                             - START_TIME) / TICK_TIME));
+            // Partial tick is not run
+            simulation_run (&simulation, TICK_TIME / 2);
+            TEST_ASSERT_EQUAL_INT(5, (int) scheduler.current);
+        }
+
+        TEST_CASE("timers", "Timers fire in order at their virtual time")
+        {
+            scheduler_init (&scheduler, &parent_context, 16);
+            context = simulation_init (&simulation, &parent_context,
+                                       &scheduler, START_TIME, TICK_TIME);
+            num_calls = 0;
+            scheduler_add (&scheduler, 30, 0, FIRST, write_rmcios);
+            scheduler_add (&scheduler, 10, 20, SECOND, write_rmcios);
+            simulation_run (&simulation, 60 * TICK_TIME);
+            TEST_ASSERT_EQUAL_INT(4, num_calls);
+            TEST_ASSERT_EQUAL_INT(SECOND, calls[0]);
+            TEST_ASSERT_EQUAL_INT(10, (int) ((call_times[0] - START_TIME)
+                                             / TICK_TIME));
+            TEST_ASSERT_EQUAL_INT(SECOND, calls[1]);
+            TEST_ASSERT_EQUAL_INT(30, (int) ((call_times[1] - START_TIME)
+                                             / TICK_TIME));
+            TEST_ASSERT_EQUAL_INT(FIRST, calls[2]);
+            TEST_ASSERT_EQUAL_INT(30, (int) ((call_times[2] - START_TIME)
+                                             / TICK_TIME));
+            TEST_ASSERT_EQUAL_INT(SECOND, calls[3]);
+            TEST_ASSERT_EQUAL_INT(50, (int) ((call_times[3] - START_TIME)
+                                             / TICK_TIME));
+        }
+
+        TEST_CASE("clock", "Clock is read as binary ns and double seconds")
+        {
+            long long time = 0;
+            double seconds = 0;
+            struct buffer_rmcios btime = {
+                .data = (char *) &time,
+                .size = sizeof (time)
+            };
+            struct combo_rmcios binary_return = {
+                .paramtype = binary_rmcios,
+                .num_params = 1,
+                .param.bv = &btime
+            };
+            struct combo_rmcios double_return = {
+                .paramtype = double_rmcios,
+                .num_params = 1,
+                .param.dv = &seconds
+            };
+            scheduler_init (&scheduler, &parent_context, 16);
+            context = simulation_init (&simulation, &parent_context,
+                                       &scheduler, START_TIME, TICK_TIME);
+            simulation_run (&simulation, 1001 * TICK_TIME);
+            run_channel (context, context->clock, read_rmcios, binary_rmcios,
+                         &binary_return, 0, (union param_rmcios) 0);
+            TEST_ASSERT_EQUAL_INT(1, time == START_TIME + 1000 * TICK_TIME);
+            TEST_ASSERT_EQUAL_INT(1, read_time (context) == time);
+            run_channel (context, context->clock, read_rmcios, double_rmcios,
+                         &double_return, 0, (union param_rmcios) 0);
+            TEST_ASSERT_EQUAL_INT(1, seconds == 1001.0);
+        }
+    }
+}
+
+int main(void)
+{
+    TEST_RUN(test_data)
+    return TEST_RESULTS(test_data)
+}
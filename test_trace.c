@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "test.h"
+#include "RMCIOS-API.h"
+#include "RMCIOS-functions.c"
+#include "RMCIOS-trace.c"
+
+#define TEST_FUNC_NAME run_stub
+#define TEST_CALLBACK_NAME run_callback
+#undef TEST_FUNC_RETURN_TYPE
+#define TEST_FUNC_PARAMS PARAM(void *, data) SEP\
+                         PARAM(const struct context_rmcios * ,context) SEP\
+                         PARAM(int, id) SEP \
+                         PARAM(enum function_rmcios, function) SEP \
+                         PARAM(enum type_rmcios, paramtype) SEP \
+                         PARAM(struct combo_rmcios *, returnv) SEP\
+                         PARAM(int, num_params) SEP \
+                         PARAM(union param_rmcios, param)
+#include "test_callback_template.h"
+
+struct context_rmcios context_mock =
+{
+        .run_channel = run_stub,
+        .id = 55,
+        .name = 56,
+        .mem = 57,
+        .quemem = 58,
+        .errors = 59,
+        .warning = 60,
+        .report = 61,
+        .control = 62,
+        .link = 63,
+        .linked = 64,
+        .create = 65,
+        .convert = 66,
+};
+
+#define CREATE 600
+#define WARNING 601
+#define SOURCE 602
+#define FILTER 603
+#define SINK 604
+#define QUEUE 605
+#define FIRST_CHANNEL 1000
+
+static struct trace_rmcios trace;
+static struct trace_context_rmcios queued;
+
+// Parent context: source -> filter -> sink chain that also warns
+static void parent_run (void *data, const struct context_rmcios *context,
+                        int id, enum function_rmcios function,
+                        enum type_rmcios paramtype,
+                        struct combo_rmcios *returnv,
+                        int num_params, union param_rmcios param)
+{
+    if (id == CREATE)
+    {
+        *(returnv->param.iv) = FIRST_CHANNEL;
+    }
+    else if (id == SOURCE)
+    {
+        write_str (context, context->warning, "source warning", id);
+        write_i (context, FILTER, 1);
+    }
+    else if (id == FILTER)
+    {
+        write_i (context, SINK, 1);
+    }
+    else if (id == QUEUE)
+    {
+        // Deferring channel stores the trace
+        trace_save (&trace, &queued);
+    }
+}
+
+static struct context_rmcios parent_context = {
+    .run_channel = parent_run,
+    .create = CREATE,
+    .warning = WARNING,
+};
+
+TEST_RUNNER
+{
+    TEST_SUITE("trace")
+    {
+        const struct context_rmcios *context;
+        const struct trace_sink_rmcios *sink;
+
+        TEST_CASE("hops", "Writes to linked channels are hops")
+        {
+            context = trace_init (&trace, &parent_context);
+            TEST_ASSERT_EQUAL_INT(0, trace_add_sink (&trace, SINK));
+            TEST_ASSERT_EQUAL_INT(0, trace_add_sink (&trace, WARNING));
+            write_i (context, SOURCE, 1);
+            sink = trace_get (&trace, SINK);
+            TEST_ASSERT_EQUAL_INT(1, sink->count);
+            TEST_ASSERT_EQUAL_INT(2, sink->max_hops);
+            TEST_ASSERT_EQUAL_INT(-1, trace.current.hops);
+        }
+
+        TEST_CASE("warning", "Writes to warning channel are not traced")
+        {
+            TEST_ASSERT_EQUAL_INT(0, trace_get (&trace, WARNING)->count);
+            write_str (&trace.context, WARNING, "warning", 0);
+            TEST_ASSERT_EQUAL_INT(0, trace_get (&trace, WARNING)->count);
+        }
+
+        TEST_CASE("deferred", "Restored trace continues from the origin")
+        {
+            trace_clear (&trace);
+            write_i (&trace.context, QUEUE, 1);
+            TEST_ASSERT_EQUAL_INT(QUEUE, queued.origin);
+            TEST_ASSERT_EQUAL_INT(0, queued.hops);
+
+            // Deferred write run later:
+            trace_restore (&trace, &queued);
+            write_i (&trace.context, SINK, 1);
+            trace_restore (&trace, 0);
+            sink = trace_get (&trace, SINK);
+            TEST_ASSERT_EQUAL_INT(1, sink->count);
+            TEST_ASSERT_EQUAL_INT(1, sink->max_hops);
+            TEST_ASSERT_EQUAL_INT(-1, trace.current.hops);
+        }
+    }
+}
+
+int main(void)
+{
+    TEST_RUN(test_data)
+    return TEST_RESULTS(test_data)
+}
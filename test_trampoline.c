@@ -0,0 +1,233 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "test.h"
+#include "RMCIOS-API.h"
+#include "RMCIOS-functions.c"
+#define TRAMPOLINE_QUEUE_SIZE 4
+#include "RMCIOS-trampoline.c"
+
+#define TEST_FUNC_NAME run_stub
+#define TEST_CALLBACK_NAME run_callback
+#undef TEST_FUNC_RETURN_TYPE
+#define TEST_FUNC_PARAMS PARAM(void *, data) SEP\
+                         PARAM(const struct context_rmcios * ,context) SEP\
+                         PARAM(int, id) SEP \
+                         PARAM(enum function_rmcios, function) SEP \
+                         PARAM(enum type_rmcios, paramtype) SEP \
+                         PARAM(struct combo_rmcios *, returnv) SEP\
+                         PARAM(int, num_params) SEP \
+                         PARAM(union param_rmcios, param)
+#include "test_callback_template.h"
+
+struct context_rmcios context_mock =
+{
+        .run_channel = run_stub,
+        .id = 55,
+        .name = 56,
+        .mem = 57,
+        .quemem = 58,
+        .errors = 59,
+        .warning = 60,
+        .report = 61,
+        .control = 62,
+        .link = 63,
+        .linked = 64,
+        .create = 65,
+        .convert = 66,
+};
+
+#define CHAIN 700
+#define SINK 701
+#define READER 702
+#define QUEUER 703
+#define FLOOD 704
+#define EMPTY 705
+#define ORDER 706
+
+static struct trampoline_rmcios trampoline;
+static int nesting;
+static int max_nesting;
+static int chain_left;
+static int chain_calls;
+static int sink_calls;
+static int reader_calls;
+static int reader_direct;
+static char sink_data[16];
+// Sequence of sink (s) and reader (r) calls
+static char order[16];
+static int order_length;
+static struct array_rmcios empty_arrays[256];
+
+// Channels behind the trampoline
+static void parent_run (void *data, const struct context_rmcios *context,
+                        int id, enum function_rmcios function,
+                        enum type_rmcios paramtype,
+                        struct combo_rmcios *returnv,
+                        int num_params, union param_rmcios param)
+{
+    nesting++;
+    if (nesting > max_nesting)
+    {
+        max_nesting = nesting;
+    }
+
+    if (id == CHAIN)
+    {
+        chain_calls++;
+        if (--chain_left > 0)
+        {
+            write_str (context, CHAIN, "", 0);
+        }
+    }
+    else if (id == SINK)
+    {
+        sink_calls++;
+        if (order_length < (int) sizeof (order) - 1)
+        {
+            order[order_length++] = 's';
+        }
+        if (paramtype == buffer_rmcios && num_params == 1)
+        {
+            memcpy (sink_data, param.bv[0].data, param.bv[0].length);
+            sink_data[param.bv[0].length] = 0;
+        }
+    }
+    else if (id == READER)
+    {
+        reader_calls++;
+        if (order_length < (int) sizeof (order) - 1)
+        {
+            order[order_length++] = 'r';
+        }
+        *returnv->param.iv = 1;
+    }
+    else if (id == QUEUER)
+    {
+        char buffer[] = "first";
+        int value;
+        write_str (context, SINK, buffer, 0);
+        // Parameters of queued call are copied
+        strcpy (buffer, "xxxxx");
+        value = read_i (context, READER);
+        reader_direct = (reader_calls == 1 && value == 1);
+    }
+    else if (id == ORDER)
+    {
+        // Queued write runs after the later direct read
+        write_str (context, SINK, "queued", 0);
+        read_i (context, READER);
+    }
+    else if (id == FLOOD)
+    {
+        int i;
+        // Calls without return value are queued:
+        for (i = 0; i < 6; i++)
+        {
+            write_str (context, SINK, "flood", 0);
+        }
+    }
+    else if (id == EMPTY)
+    {
+        struct combo_rmcios returnv = {
+            .paramtype = channel_rmcios,
+            .num_params = 0,
+            .param.channel = 0,
+            .next = 0
+        };
+        context->run_channel (context->data, context, SINK, write_rmcios,
+                              array_rmcios, &returnv, 1,
+                              (const union param_rmcios) empty_arrays);
+    }
+    nesting--;
+}
+
+static struct context_rmcios parent_context = {
+    .run_channel = parent_run,
+    .id = 55,
+    .name = 56,
+    .mem = 57,
+    .quemem = 58,
+    .link = 63,
+    .create = 65,
+    .convert = 66,
+};
+
+TEST_RUNNER
+{
+    TEST_SUITE("trampoline")
+    {
+        const struct context_rmcios *context;
+
+        TEST_CASE("direct", "Calls below depth limit are run directly")
+        {
+            context = trampoline_init (&trampoline, &parent_context, 2);
+            write_i (context, SINK, 1);
+            TEST_ASSERT_EQUAL_INT(1, sink_calls);
+            TEST_ASSERT_EQUAL_INT(0, trampoline.deferred);
+            TEST_ASSERT_EQUAL_INT(0, trampoline.depth);
+        }
+
+        TEST_CASE("chain", "Call chain nesting is bounded by depth limit")
+        {
+            context = trampoline_init (&trampoline, &parent_context, 2);
+            max_nesting = 0;
+            chain_left = 50;
+            write_i (context, CHAIN, 0);
+            TEST_ASSERT_EQUAL_INT(50, chain_calls);
+            TEST_ASSERT_EQUAL_INT(2, max_nesting);
+            TEST_ASSERT_EQUAL_INT(1, trampoline.deferred > 0);
+            TEST_ASSERT_EQUAL_INT(0, trampoline.queue_count);
+            TEST_ASSERT_EQUAL_INT(0, trampoline.arena_used);
+        }
+
+        TEST_CASE("copy", "Queued call gets copy of parameters")
+        {
+            context = trampoline_init (&trampoline, &parent_context, 1);
+            sink_calls = 0;
+            write_i (context, QUEUER, 0);
+            TEST_ASSERT_EQUAL_INT(1, sink_calls);
+            TEST_ASSERT_EQUAL_STR("first", sink_data);
+            TEST_ASSERT_EQUAL_INT(1, trampoline.deferred);
+            // Call with return value is not queued:
+            TEST_ASSERT_EQUAL_INT(1, reader_direct);
+        }
+
+        TEST_CASE("order", "Queued calls run after the outermost call")
+        {
+            context = trampoline_init (&trampoline, &parent_context, 1);
+            order_length = 0;
+            write_i (context, ORDER, 0);
+            order[order_length] = 0;
+            TEST_ASSERT_EQUAL_STR("rs", order);
+            TEST_ASSERT_EQUAL_STR("queued", sink_data);
+            TEST_ASSERT_EQUAL_INT(1, trampoline.deferred);
+        }
+
+        TEST_CASE("overflow", "Calls are run directly when queue is full")
+        {
+            context = trampoline_init (&trampoline, &parent_context, 1);
+            sink_calls = 0;
+            write_i (context, FLOOD, 0);
+            TEST_ASSERT_EQUAL_INT(6, sink_calls);
+            TEST_ASSERT_EQUAL_INT(TRAMPOLINE_QUEUE_SIZE, trampoline.deferred);
+            TEST_ASSERT_EQUAL_INT(2, trampoline.overflows);
+        }
+
+        TEST_CASE("empty_arrays", "Array count is limited to arena size")
+        {
+            context = trampoline_init (&trampoline, &parent_context, 1);
+            sink_calls = 0;
+            write_i (context, EMPTY, 0);
+            TEST_ASSERT_EQUAL_INT(1, sink_calls);
+            TEST_ASSERT_EQUAL_INT(0, trampoline.deferred);
+            TEST_ASSERT_EQUAL_INT(1, trampoline.overflows);
+        }
+    }
+}
+
+int main(void)
+{
+    TEST_RUN(test_data)
+    return TEST_RESULTS(test_data)
+}
@@ -0,0 +1,167 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "test.h"
+#include "RMCIOS-API.h"
+#include "RMCIOS-functions.c"
+#include "RMCIOS-watchdog.c"
+
+#define TEST_FUNC_NAME run_stub
+#define TEST_CALLBACK_NAME run_callback
+#undef TEST_FUNC_RETURN_TYPE
+#define TEST_FUNC_PARAMS PARAM(void *, data) SEP\
+                         PARAM(const struct context_rmcios * ,context) SEP\
+                         PARAM(int, id) SEP \
+                         PARAM(enum function_rmcios, function) SEP \
+                         PARAM(enum type_rmcios, paramtype) SEP \
+                         PARAM(struct combo_rmcios *, returnv) SEP\
+                         PARAM(int, num_params) SEP \
+                         PARAM(union param_rmcios, param)
+#include "test_callback_template.h"
+
+struct context_rmcios context_mock =
+{
+        .run_channel = run_stub,
+        .id = 55,
+        .name = 56,
+        .mem = 57,
+        .quemem = 58,
+        .errors = 59,
+        .warning = 60,
+        .report = 61,
+        .control = 62,
+        .link = 63,
+        .linked = 64,
+        .create = 65,
+        .convert = 66,
+};
+
+#define WATCHDOG_ID 70
+#define SLOW 1000
+
+static struct watchdog_rmcios watchdog;
+static int warnings;
+
+// Simulated channels. SLOW channel takes 2ms.
+static void channel_call (int id)
+{
+    struct timespec delay = {.tv_sec = 0,.tv_nsec = 2000000 };
+    if (id == context_mock.create)
+    {
+        *(run_callback.returnv->param.iv) = WATCHDOG_ID;
+    }
+    else if (id == SLOW)
+    {
+        nanosleep (&delay, 0);
+    }
+    else if (id == context_mock.warning)
+    {
+        warnings++;
+    }
+}
+
+TEST_RUNNER
+{
+    TEST_SUITE("budget")
+    {
+        SUITE_SETUP()
+        TEST_CASE("setup_text", "Budget is parsed from text")
+        {
+            struct buffer_rmcios budget = {.data = "500", .length = 3,
+                                           .required_size = 3 };
+
+            TEST_CALLBACK(run_callback)
+            {
+                channel_call (run_callback.id);
+                return;
+            }
+            watchdog_init (&watchdog, &context_mock, 0);
+            watchdog_class_func (&watchdog, &context_mock, WATCHDOG_ID,
+                                 setup_rmcios, buffer_rmcios, 0, 1,
+                                 (union param_rmcios) &budget);
+            TEST_ASSERT_EQUAL_INT((int) watchdog.default_budget_ns, 500000);
+        }
+
+        TEST_CASE("violation", "Slow call over budget is reported")
+        {
+            const struct context_rmcios *context;
+
+            TEST_CALLBACK(run_callback)
+            {
+                channel_call (run_callback.id);
+                return;
+            }
+            warnings = 0;
+            context = watchdog_init (&watchdog, &context_mock, 0);
+            watchdog_set_budget (&watchdog, SLOW, read_rmcios, 1000000);
+            run_channel (context, SLOW, read_rmcios, int_rmcios, 0, 0,
+                         (union param_rmcios) 0);
+            TEST_ASSERT_EQUAL_INT(watchdog_get (&watchdog, SLOW,
+                                                read_rmcios)->violations, 1);
+            TEST_ASSERT_EQUAL_INT(warnings, 1);
+        }
+
+        TEST_CASE("exempt", "Budget 0 exempts function from default budget")
+        {
+            const struct context_rmcios *context;
+
+            TEST_CALLBACK(run_callback)
+            {
+                channel_call (run_callback.id);
+                return;
+            }
+            warnings = 0;
+            context = watchdog_init (&watchdog, &context_mock, 1000000);
+            watchdog_set_budget (&watchdog, SLOW, write_rmcios, 0);
+            run_channel (context, SLOW, write_rmcios, int_rmcios, 0, 0,
+                         (union param_rmcios) 0);
+            TEST_ASSERT_EQUAL_INT(watchdog_get (&watchdog, SLOW,
+                                                write_rmcios)->calls, 0);
+            TEST_ASSERT_EQUAL_INT(warnings, 0);
+
+            // Default budget applies to functions without own budget
+            watchdog_set_budget (&watchdog, SLOW, write_rmcios,
+                                 WATCHDOG_DEFAULT_BUDGET);
+            run_channel (context, SLOW, write_rmcios, int_rmcios, 0, 0,
+                         (union param_rmcios) 0);
+            run_channel (context, SLOW, read_rmcios, int_rmcios, 0, 0,
+                         (union param_rmcios) 0);
+            TEST_ASSERT_EQUAL_INT(watchdog_get (&watchdog, SLOW,
+                                                write_rmcios)->violations, 1);
+            TEST_ASSERT_EQUAL_INT(watchdog_get (&watchdog, SLOW,
+                                                read_rmcios)->violations, 1);
+            TEST_ASSERT_EQUAL_INT(warnings, 2);
+        }
+
+        TEST_CASE("probes", "Colliding calls over probe limit are overflows")
+        {
+            const struct context_rmcios *context;
+            int i;
+
+            TEST_CALLBACK(run_callback)
+            {
+                channel_call (run_callback.id);
+                return;
+            }
+            context = watchdog_init (&watchdog, &context_mock, 1000000000);
+            // Channels 32 apart hash to the same slot
+            for (i = 0; i <= WATCHDOG_PROBES; i++)
+            {
+                run_channel (context, 2000 + 32 * i, read_rmcios, int_rmcios,
+                             0, 0, (union param_rmcios) 0);
+            }
+            TEST_ASSERT_EQUAL_INT(watchdog_get (&watchdog, 2000,
+                                                read_rmcios)->calls, 1);
+            TEST_ASSERT_EQUAL_INT(watchdog_get (&watchdog,
+                                                2000 + 32 * WATCHDOG_PROBES,
+                                                read_rmcios) == 0, 1);
+            TEST_ASSERT_EQUAL_INT(watchdog.overflows, 1);
+        }
+    }
+}
+
+int main(void)
+{
+    TEST_RUN(test_data)
+    return TEST_RESULTS(test_data)
+}